@@ -41,6 +41,9 @@ class PlatformVersionPlugin :
                 val deviceInfo = getDeviceInfo()
                 result.success(deviceInfo)
             }
+            "getStableDeviceId" -> {
+                result.success(getOrCreateStableDeviceId())
+            }
             else -> {
                 result.notImplemented()
             }
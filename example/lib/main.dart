@@ -36,11 +36,19 @@ class _MyAppState extends State<MyApp> {
     // Platform messages may fail, so we use a try/catch PlatformException.
     // We also handle the message potentially returning null.
     try {
-      platformVersion =
-          await _platformVersionPlugin.getPlatformVersion() ??
-          'Unknown platform version';
-      stableDeviceId = await _platformVersionPlugin.getStableDeviceId();
-      deviceInfo = await _platformVersionPlugin.getDeviceInfo();
+      // One round trip instead of three; failed calls come back as
+      // exceptions in their slot.
+      final replies = await _platformVersionPlugin.batch(const [
+        PlatformVersionCall('getPlatformVersion'),
+        PlatformVersionCall('getStableDeviceId'),
+        PlatformVersionCall('getDeviceInfo'),
+      ]);
+      for (final reply in replies) {
+        if (reply is PlatformException) throw reply;
+      }
+      platformVersion = replies[0] as String? ?? 'Unknown platform version';
+      stableDeviceId = replies[1] as String?;
+      deviceInfo = replies[2] as Map<String, dynamic>?;
     } on PlatformException {
       platformVersion = 'Failed to get platform version.';
       stableDeviceId = null;
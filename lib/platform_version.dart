@@ -1,18 +1,383 @@
+import 'platform_version_call.dart';
+import 'platform_version_device_info_record.dart';
+import 'platform_version_ffi_stub.dart'
+    if (dart.library.ffi) 'platform_version_ffi.dart';
 import 'platform_version_platform_interface.dart';
 
+export 'platform_version_call.dart';
+export 'platform_version_device_info_record.dart';
+
 class PlatformVersion {
+  // Opened on first use of the synchronous accessors or [hasSyncAccess].
+  // Opening only loads the library; the static device properties are read
+  // by the first getDeviceInfoSync().
+  static final PlatformVersionFfi? _ffi = PlatformVersionFfi.open();
+
   Future<String?> getPlatformVersion() {
     return PlatformVersionPlatform.instance.getPlatformVersion();
   }
 
-  Future<Map<String, dynamic>?> getDeviceInfo() {
-    return PlatformVersionPlatform.instance.getDeviceInfo();
+  /// Returns device information as a key-value map.
+  ///
+  /// Pass [keys] to receive only those entries. On Linux only the probes
+  /// needed for the requested keys run, so asking for e.g. `['freeRam']`
+  /// skips the CPU, distribution and stable-ID lookups entirely.
+  Future<Map<String, dynamic>?> getDeviceInfo({List<String>? keys}) {
+    return PlatformVersionPlatform.instance.getDeviceInfo(keys: keys);
+  }
+
+  /// Whether [getDeviceInfoSync] and [getAvailableRamSync] can answer on
+  /// this platform. True on Linux, where they call the plugin library through
+  /// `dart:ffi`.
+  bool get hasSyncAccess => _ffi != null;
+
+  /// Returns device information synchronously, without a platform channel
+  /// round trip, or `null` where [hasSyncAccess] is false.
+  ///
+  /// Has the static keys of [getDeviceInfo] (IDs, kernel, CPU model,
+  /// distribution, processor count) plus `totalRam`, `freeRam`, `sharedRam`,
+  /// `bufferRam`, `totalSwap`, `freeSwap`, `processes`, `uptime`,
+  /// `availableRam` and `cachedRam`. The static part is read once per
+  /// isolate from the cache [getDeviceInfo] fills, which the plugin warms in
+  /// the background when it registers; each call costs one `sysinfo()` and
+  /// one `/proc/meminfo` read, or a copy of the [configureSampler] sample
+  /// while the sampler runs.
+  Map<String, dynamic>? getDeviceInfoSync() => _ffi?.deviceInfo();
+
+  /// Returns `availableRam`, the memory available without swapping in bytes,
+  /// synchronously, or `null` where [hasSyncAccess] is false or it could not
+  /// be read.
+  ///
+  /// Meant for frame-budget checks on the UI isolate: it costs a single
+  /// `/proc/meminfo` read, or none while [configureSampler] runs, and does
+  /// not allocate.
+  int? getAvailableRamSync() => _ffi?.availableRam();
+
+  /// Returns memory accounting that includes reclaimable page cache.
+  ///
+  /// `availableRam` is the kernel's estimate of memory available without
+  /// swapping and is the value to act on; `freeRam` from [getDeviceInfo]
+  /// excludes page cache and badly understates it. Also reports `cachedRam`,
+  /// `dirtyRam`, `writebackRam`, `slabReclaimable` and `swapCached` in bytes,
+  /// and `swapInPages`/`swapOutPages` since boot. The same keys can be
+  /// requested through [getDeviceInfo]. Cheap enough to call every frame.
+  /// Currently available on Linux.
+  Future<Map<String, dynamic>?> getMemoryInfo() {
+    return PlatformVersionPlatform.instance.getMemoryInfo();
+  }
+
+  /// Returns CPU usage since the previous call, in percent.
+  ///
+  /// The result has a `total` entry for all CPUs and a `cpus` list with one
+  /// entry per core, each with `user`, `system`, `iowait`, `steal` and `idle`
+  /// percentages; core entries also carry their `cpu` number. The first call
+  /// reports usage since boot. Currently available on Linux.
+  Future<Map<String, dynamic>?> getCpuUsage() {
+    return PlatformVersionPlatform.instance.getCpuUsage();
+  }
+
+  /// Returns the app's own memory, fault, scheduling and I/O counters.
+  ///
+  /// Read from `/proc/self` through descriptors kept open, so it is cheap
+  /// enough for an overlay refreshed every frame. The result has `rss`,
+  /// `rssAnon`, `rssFile`, `rssShmem`, `vmSize`, `vmHwm` (peak RSS) and
+  /// `vmSwap` in bytes, the number of `threads`, `minorFaults` and
+  /// `majorFaults`, `voluntaryContextSwitches` and
+  /// `involuntaryContextSwitches`, and `userTimeMs` and `systemTimeMs` of CPU
+  /// time, all since the process started. `readBytes` and `writeBytes`
+  /// (block I/O) and `readChars` and `writeChars` (all reads and writes) are
+  /// left out when the kernel does not expose them. With [pss], `pss` holds
+  /// the proportional set size, which takes the kernel a walk over every
+  /// mapping. From the second call on, `deltas` holds the change of each
+  /// counter since the previous call and the `intervalMs` between them; its
+  /// `rss` and `pss` may be negative. Currently available on Linux.
+  Future<Map<String, dynamic>?> getProcessInfo({bool pss = false}) {
+    return PlatformVersionPlatform.instance.getProcessInfo(pss: pss);
+  }
+
+  /// Returns the CPU time of each of the app's threads since the previous
+  /// call.
+  ///
+  /// Tells apart the Flutter engine's `1.ui`, `1.raster` and `1.io` task
+  /// runners, the platform thread and plugin threads by name, to find the one
+  /// burning CPU during jank. The result has the `intervalMs` since the
+  /// previous call (0 on the first) and a `threads` list in thread ID order,
+  /// each with its `tid`, `name`, one-letter `state` (`R` running, `S`
+  /// sleeping, `D` waiting on I/O, ...), the `lastCpu` it ran on, and its
+  /// total `userTimeMs` and `systemTimeMs`. Each thread's `deltas` hold the
+  /// `userTimeMs` and `systemTimeMs` since the previous call, or since the
+  /// thread started if it is new, and their `cpuPercent` of the interval,
+  /// where 100 is one busy CPU. Currently available on Linux.
+  Future<Map<String, dynamic>?> getThreadCpuUsage() {
+    return PlatformVersionPlatform.instance.getThreadCpuUsage();
+  }
+
+  /// Returns the CPU and memory limits of the container or sandbox the app
+  /// runs in.
+  ///
+  /// Inside a Flatpak, Snap or container the host's processor count and RAM
+  /// overstate what the app may use. The result has the `cgroupVersion`
+  /// (1, 2, or 0 when no cgroup controller is mounted), `cpuQuotaUs`,
+  /// `cpuPeriodUs` and `cpuLimit` (quota in CPUs), `memoryLimit` and
+  /// `memoryUsage` in bytes, and `memoryEvents` counters; limits are `null`
+  /// when unset. `effectiveProcessors` is the processor count capped by the
+  /// CPU quota and affinity mask, rounded up, and is the number to size
+  /// thread pools from. It is also available through [getDeviceInfo].
+  /// Currently available on Linux.
+  Future<Map<String, dynamic>?> getCgroupLimits() {
+    return PlatformVersionPlatform.instance.getCgroupLimits();
+  }
+
+  /// Returns the CPUs the app may run on.
+  ///
+  /// Pinning with `taskset`, systemd's `CPUAffinity=` or a cpuset cgroup
+  /// restricts the app to fewer CPUs than are online. The result has the
+  /// allowed `cpus` as a list, the same set as a kernel-style `cpuList`
+  /// string such as `0-3,8`, their `count`, and `numaNodes`, one entry per
+  /// NUMA node with allowed CPUs, each with its `node` number, `cpus`,
+  /// `cpuList` and `count`. The count alone is also available as
+  /// `allowedProcessors` through [getDeviceInfo]. Currently available on
+  /// Linux.
+  Future<Map<String, dynamic>?> getCpuAffinity() {
+    return PlatformVersionPlatform.instance.getCpuAffinity();
+  }
+
+  /// Returns the instruction-set extensions the CPU supports.
+  ///
+  /// The result has the `architecture` (as reported by `uname`), a `mask`
+  /// with one bit per feature, and the `features` as names in the spelling
+  /// of `/proc/cpuinfo`, such as `sse4_2`, `avx2`, `avx512f` or `bmi2` on
+  /// x86 and `asimd`, `sve` or `aes` on Arm. Bit positions are stable: x86
+  /// features use bits 0-39 and Arm features bits 40-63. Features whose
+  /// registers the kernel does not save, such as AVX-512 with XSAVE
+  /// disabled, are left out. Detected once when the plugin registers.
+  /// Currently available on Linux.
+  Future<Map<String, dynamic>?> getCpuFeatures() {
+    return PlatformVersionPlatform.instance.getCpuFeatures();
+  }
+
+  /// Returns the CPU topology and cache hierarchy.
+  ///
+  /// The result has the number of `packages`, physical `cores` and
+  /// `logicalProcessors`, `threadsPerCore` (2 or more with SMT), whether the
+  /// CPU is `hybrid` with `performanceCores` and `efficiencyCores` and their
+  /// `performanceCpuList` and `efficiencyCpuList`, the `caches` (each with
+  /// `level`, `type`, `sizeBytes`, `lineSize`, `ways`, `sharedCpus` and
+  /// `instances`), and the `numaNodes` with their CPUs. Cores count as
+  /// efficiency cores when their capacity, or failing that their maximum
+  /// frequency, is well below the fastest core's. The topology is read once
+  /// and cached. Currently available on Linux.
+  Future<Map<String, dynamic>?> getCpuTopology() {
+    return PlatformVersionPlatform.instance.getCpuTopology();
+  }
+
+  /// Streams the CPU affinity mask, in the same shape as [getCpuAffinity],
+  /// checking it every [interval].
+  ///
+  /// With [refreshOnChange], the default, only the first mask and later
+  /// changes are sent; otherwise every check sends an event. Currently
+  /// available on Linux.
+  Stream<Map<String, dynamic>> cpuAffinityStream({
+    Duration interval = const Duration(seconds: 1),
+    bool refreshOnChange = true,
+  }) {
+    return PlatformVersionPlatform.instance.cpuAffinityStream(
+      interval: interval,
+      refreshOnChange: refreshOnChange,
+    );
+  }
+
+  /// Streams CPU usage every [interval], in the same shape as [getCpuUsage].
+  ///
+  /// Each event covers the time since the previous one; the first event of a
+  /// subscription covers the time since boot. Currently available on Linux.
+  Stream<Map<String, dynamic>> cpuUsageStream({
+    Duration interval = const Duration(seconds: 1),
+  }) {
+    return PlatformVersionPlatform.instance.cpuUsageStream(interval: interval);
+  }
+
+  /// Streams the app's resource usage every [interval], in the same shape as
+  /// [getProcessInfo].
+  ///
+  /// Each event's `deltas` cover the time since the previous event; the
+  /// first event of a subscription has none. Samples are taken off the
+  /// platform thread, so with [pss] a slow smaps_rollup read delays the
+  /// next event instead of the UI. Currently available on Linux.
+  Stream<Map<String, dynamic>> processInfoStream({
+    Duration interval = const Duration(seconds: 1),
+    bool pss = false,
+  }) {
+    return PlatformVersionPlatform.instance.processInfoStream(
+      interval: interval,
+      pss: pss,
+    );
+  }
+
+  /// Streams memory, CPU and I/O pressure transitions.
+  ///
+  /// Each event has the `resource` (`memory`, `cpu` or `io`), whether it is
+  /// `underPressure`, the `source` of the verdict and, where the kernel
+  /// exposes them, the `some` and `full` stall averages. A resource is under
+  /// pressure once tasks stall on it for [stall] within a [window]; [full]
+  /// counts only stalls of all non-idle tasks. One event per resource
+  /// reports the starting state, later ones only changes.
+  ///
+  /// On Linux with pressure stall information, the native side waits on
+  /// kernel triggers and does no work while nothing happens (`source` is
+  /// `psi`). Without trigger support it samples every [fallbackInterval]
+  /// (`sampler`), and resources it cannot observe are reported once as
+  /// `unavailable`. Currently available on Linux.
+  Stream<Map<String, dynamic>> pressureStream({
+    List<String> resources = const ['memory'],
+    Duration stall = const Duration(milliseconds: 150),
+    Duration window = const Duration(seconds: 1),
+    bool full = false,
+    Duration fallbackInterval = const Duration(seconds: 2),
+  }) {
+    return PlatformVersionPlatform.instance.pressureStream(
+      resources: resources,
+      stall: stall,
+      window: window,
+      full: full,
+      fallbackInterval: fallbackInterval,
+    );
+  }
+
+  /// Streams memory, swap, load-average and uptime samples every [interval].
+  ///
+  /// Each sample costs a single `sysinfo()` call on the native side, so this
+  /// is the cheap way to watch memory compared to polling [getDeviceInfo].
+  /// Sampling starts when the stream is listened to and stops when the
+  /// subscription is cancelled. Only one subscription is served at a time.
+  /// Currently available on Linux.
+  Stream<Map<String, dynamic>> telemetryStream({
+    Duration interval = const Duration(seconds: 1),
+  }) {
+    return PlatformVersionPlatform.instance.telemetryStream(
+      interval: interval,
+    );
+  }
+
+  /// Configures how the native side runs method calls.
+  ///
+  /// On Linux, calls are handled on the platform thread by default. Pass
+  /// `async: true` to handle them on a worker pool instead, so that file
+  /// reads never block the platform thread. [maxThreads] sizes the pool and
+  /// [maxQueuedCalls] bounds how many calls may wait for a worker before new
+  /// ones fail with a `BUSY` error.
+  /// Other platforms ignore this call.
+  Future<void> configureDispatch({
+    bool? async,
+    int? maxThreads,
+    int? maxQueuedCalls,
+  }) {
+    return PlatformVersionPlatform.instance.configureDispatch(
+      async: async,
+      maxThreads: maxThreads,
+      maxQueuedCalls: maxQueuedCalls,
+    );
+  }
+
+  /// Runs several method calls in one platform channel round trip.
+  ///
+  /// Returns one entry per call, in order: the call's result (decoded as the
+  /// matching single-call method would decode it), a [PlatformException] if
+  /// that call failed, or a [MissingPluginException] if the platform does
+  /// not know the method. One failing call does not fail the others.
+  ///
+  /// On Linux the calls also share their probes, so asking for
+  /// `getDeviceInfo` and `getMemoryInfo` together reads `/proc/meminfo`
+  /// once. Platforms without a native batch run the calls one by one.
+  Future<List<Object?>> batch(List<PlatformVersionCall> calls) {
+    return PlatformVersionPlatform.instance.batch(calls);
+  }
+
+  /// Starts, reconfigures or pauses a native background sampler.
+  ///
+  /// While it runs, a thread refreshes the [metrics] groups every [interval]
+  /// and [getDeviceInfo], [getMemoryInfo], [batch] and [telemetryStream]
+  /// answer from its latest sample, so a call costs a copy instead of
+  /// syscalls, however often widgets poll. Values are then up to [interval]
+  /// old. The groups are `sysinfo` (memory, swap, processes, uptime and load),
+  /// `meminfo` (the [getMemoryInfo] keys), `loadavg` (load averages plus
+  /// runnable and total task counts) and `cpuTimes` (aggregate CPU jiffies);
+  /// all are sampled by default. Pass `enabled: false` to pause it. Currently
+  /// available on Linux; other platforms ignore this call.
+  Future<void> configureSampler({
+    bool enabled = true,
+    Duration interval = const Duration(seconds: 1),
+    List<String>? metrics,
+  }) {
+    return PlatformVersionPlatform.instance.configureSampler(
+      enabled: enabled,
+      interval: interval,
+      metrics: metrics,
+    );
+  }
+
+  /// Returns the background sampler's latest sample, or `null` while it is
+  /// not running.
+  ///
+  /// Has the sampled `metrics`, the sample's age in microseconds (`ageUs`),
+  /// the number of `refreshes` so far, and the keys of each sampled group:
+  /// the [telemetryStream] keys for `sysinfo`, the [getMemoryInfo] keys for
+  /// `meminfo`, `load1`/`load5`/`load15`, `runnableTasks` and `totalTasks`
+  /// for `loadavg`, and a `cpuTimes` map of cumulative jiffies. See
+  /// [configureSampler]. Currently available on Linux.
+  Future<Map<String, dynamic>?> getSampledMetrics() {
+    return PlatformVersionPlatform.instance.getSampledMetrics();
+  }
+
+  /// Returns latency statistics for the plugin's own native work.
+  ///
+  /// `methods` maps each method name (unknown ones are grouped under
+  /// `other`) and `probes` maps each getDeviceInfo probe (such as `cpuInfo`,
+  /// `osRelease`, `stableDeviceId` or `meminfo`) to its `count`, `errors`,
+  /// and `meanUs`, `p50Us`, `p90Us`, `p99Us` and `maxUs` in microseconds.
+  /// Only entries that ran are listed. Percentiles come from log-bucketed
+  /// histograms and are within 25% of the true value. `periodUs` is the time
+  /// covered. With [reset], the statistics are cleared after being read, so
+  /// periodic uploads see disjoint periods. Currently available on Linux.
+  Future<Map<String, dynamic>?> getPluginMetrics({bool reset = false}) {
+    return PlatformVersionPlatform.instance.getPluginMetrics(reset: reset);
+  }
+
+  /// Starts or stops recording trace events for the plugin's native work.
+  ///
+  /// While enabled, each method call, getDeviceInfo probe and file read is
+  /// recorded as a begin/end pair on the thread that ran it. Write them out
+  /// with [dumpTrace]. Events recorded so far are kept when tracing stops.
+  /// Currently available on Linux; other platforms ignore this call.
+  Future<void> configureTracing({required bool enabled}) {
+    return PlatformVersionPlatform.instance.configureTracing(enabled: enabled);
+  }
+
+  /// Writes the recorded trace events to [path] as Chrome Trace Event JSON
+  /// and returns how many were written.
+  ///
+  /// Open the file in Perfetto (ui.perfetto.dev) or chrome://tracing.
+  /// Timestamps are CLOCK_MONOTONIC, like Flutter's own timeline on Linux,
+  /// so the plugin's events can be lined up with engine and framework
+  /// traces. Each thread keeps its latest 4096 events; those of a thread
+  /// that has exited are dropped when a new thread starts recording. With
+  /// [clear], the written events are dropped so the next dump only has newer
+  /// ones.
+  /// Currently available on Linux.
+  Future<int?> dumpTrace(String path, {bool clear = true}) {
+    return PlatformVersionPlatform.instance.dumpTrace(path, clear: clear);
+  }
+
+  /// Returns device information as a compact binary record.
+  ///
+  /// Cheaper than [getDeviceInfo] for high-rate pollers: the reply carries
+  /// no key names and is decoded through typed views instead of a map copy.
+  /// Currently available on Linux.
+  Future<DeviceInfoRecord?> getDeviceInfoRecord() {
+    return PlatformVersionPlatform.instance.getDeviceInfoRecord();
   }
 
-  Future<String?> getStableDeviceId() async {
-    final info = await getDeviceInfo();
-    final value = info?['stableDeviceId'];
-    if (value is String) return value;
-    return value?.toString();
+  Future<String?> getStableDeviceId() {
+    return PlatformVersionPlatform.instance.getStableDeviceId();
   }
 }
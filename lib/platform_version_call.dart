@@ -0,0 +1,11 @@
+/// One method call in a [PlatformVersion.batch] request.
+///
+/// [method] is any method the plugin answers on its method channel, such as
+/// `getDeviceInfo` or `getCpuFeatures`, and [arguments] are passed to it as
+/// they would be for a direct call.
+class PlatformVersionCall {
+  const PlatformVersionCall(this.method, [this.arguments]);
+
+  final String method;
+  final Object? arguments;
+}
@@ -0,0 +1,129 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+/// Device information decoded from the binary record returned by
+/// `getDeviceInfoRecord`.
+///
+/// The record has a fixed layout: integers at fixed offsets followed by a
+/// string table, so decoding only creates [ByteData] views and the strings
+/// themselves. See `linux/platform_version_plugin.cc` for the byte layout.
+class DeviceInfoRecord {
+  /// The record version this decoder was written against.
+  static const int supportedVersion = 1;
+
+  static const int _headerSize = 8;
+
+  static const List<String> _intKeys = [
+    'totalRam',
+    'freeRam',
+    'sharedRam',
+    'bufferRam',
+    'totalSwap',
+    'freeSwap',
+    'processes',
+    'uptime',
+    'numberOfProcessors',
+  ];
+
+  static const List<String> _stringKeys = [
+    'stableDeviceId',
+    'systemName',
+    'nodeName',
+    'release',
+    'version',
+    'machine',
+    'hostname',
+    'cpuModel',
+    'distributionName',
+    'distributionVersion',
+  ];
+
+  DeviceInfoRecord._(this._data, this._intCount, this._stringCount);
+
+  /// Decodes [bytes]. Throws a [FormatException] if the record is truncated,
+  /// has a string outside the record or was written by an incompatible
+  /// version.
+  factory DeviceInfoRecord.decode(Uint8List bytes) {
+    if (bytes.length < _headerSize) {
+      throw const FormatException('Device info record is truncated');
+    }
+    final data = ByteData.sublistView(bytes);
+    final version = data.getUint8(0);
+    if (version != supportedVersion) {
+      throw FormatException('Unsupported device info record version $version');
+    }
+    final intCount = data.getUint8(1);
+    final stringCount = data.getUint8(2);
+    final length = data.getUint32(4, Endian.little);
+    if (length > bytes.length ||
+        _headerSize + (intCount + stringCount) * 8 > length) {
+      throw const FormatException('Device info record is truncated');
+    }
+    // Check every string up front so the getters cannot read past the end.
+    final tableOffset = _headerSize + intCount * 8;
+    for (var i = 0; i < stringCount; i++) {
+      final entry = tableOffset + i * 8;
+      final offset = data.getUint32(entry, Endian.little);
+      final stringLength = data.getUint32(entry + 4, Endian.little);
+      if (offset + stringLength > length) {
+        throw FormatException('Device info record string $i is out of bounds');
+      }
+    }
+    return DeviceInfoRecord._(data, intCount, stringCount);
+  }
+
+  final ByteData _data;
+  final int _intCount;
+  final int _stringCount;
+
+  int? _int(int index) {
+    if (index >= _intCount) return null;
+    return _data.getInt64(_headerSize + index * 8, Endian.little);
+  }
+
+  String? _string(int index) {
+    if (index >= _stringCount) return null;
+    final entry = _headerSize + _intCount * 8 + index * 8;
+    final offset = _data.getUint32(entry, Endian.little);
+    final length = _data.getUint32(entry + 4, Endian.little);
+    return utf8.decode(
+      Uint8List.sublistView(_data, offset, offset + length),
+    );
+  }
+
+  int? get totalRam => _int(0);
+  int? get freeRam => _int(1);
+  int? get sharedRam => _int(2);
+  int? get bufferRam => _int(3);
+  int? get totalSwap => _int(4);
+  int? get freeSwap => _int(5);
+  int? get processes => _int(6);
+  int? get uptime => _int(7);
+  int? get numberOfProcessors => _int(8);
+
+  String? get stableDeviceId => _string(0);
+  String? get systemName => _string(1);
+  String? get nodeName => _string(2);
+  String? get release => _string(3);
+  String? get version => _string(4);
+  String? get machine => _string(5);
+  String? get hostname => _string(6);
+  String? get cpuModel => _string(7);
+  String? get distributionName => _string(8);
+  String? get distributionVersion => _string(9);
+
+  /// Returns the record's fields as a map with `getDeviceInfo()` key names.
+  ///
+  /// The record only carries the kernel, memory, swap, processor and
+  /// distribution fields, so keys such as `availableRam`, `cachedRam`,
+  /// `allowedProcessors` and `effectiveProcessors` are absent; call
+  /// `getDeviceInfo()` for those.
+  Map<String, dynamic> toMap() {
+    return {
+      for (var i = 0; i < _stringKeys.length && i < _stringCount; i++)
+        _stringKeys[i]: _string(i),
+      for (var i = 0; i < _intKeys.length && i < _intCount; i++)
+        _intKeys[i]: _int(i),
+    };
+  }
+}
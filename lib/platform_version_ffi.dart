@@ -0,0 +1,117 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io' show Platform;
+
+import 'package:ffi/ffi.dart';
+
+import 'platform_version_ffi_bindings.dart';
+
+/// Synchronous access to the Linux plugin's C ABI through `dart:ffi`.
+///
+/// Reads go straight into native structs owned by this object, with no
+/// platform channel hop and no codec, so they can run on the UI isolate
+/// inside a frame.
+class PlatformVersionFfi {
+  PlatformVersionFfi._(this._bindings) : _dynamic = calloc<pv_dynamic>();
+
+  /// The name of the plugin library the Linux build bundles with the app.
+  static const String _libraryName = 'libplatform_version_plugin.so';
+
+  /// Opens the plugin library, or returns `null` where it is not available:
+  /// on other platforms, before the library is bundled, or when it was built
+  /// for a different ABI version. Only loads the library and checks its ABI
+  /// version; the static properties are read by the first [deviceInfo].
+  static PlatformVersionFfi? open() {
+    if (!Platform.isLinux) return null;
+    try {
+      final bindings = PlatformVersionFfiBindings(
+        DynamicLibrary.open(_libraryName),
+      );
+      if (bindings.pv_abi_version() != PV_ABI_VERSION) return null;
+      return PlatformVersionFfi._(bindings);
+    } on ArgumentError {
+      // The library or one of its symbols could not be found.
+      return null;
+    }
+  }
+
+  final PlatformVersionFfiBindings _bindings;
+
+  // Reused by every sample and kept for the life of the isolate, like the
+  // library itself.
+  final Pointer<pv_dynamic> _dynamic;
+
+  // The static fields never change, so they are decoded once, on first use
+  // rather than in open(): until the plugin's background warm-up finishes,
+  // reading them may wait on /proc/cpuinfo, /etc/os-release and the stable
+  // ID's lock.
+  late final Map<String, dynamic> _snapshot = _readSnapshot(_bindings);
+
+  static Map<String, dynamic> _readSnapshot(
+    PlatformVersionFfiBindings bindings,
+  ) {
+    final snapshot = calloc<pv_snapshot>();
+    try {
+      bindings.pv_get_snapshot(snapshot);
+      final ref = snapshot.ref;
+      return {
+        'stableDeviceId': _string(ref.stable_device_id),
+        'systemName': _string(ref.system_name),
+        'release': _string(ref.release),
+        'version': _string(ref.version),
+        'machine': _string(ref.machine),
+        'cpuModel': _string(ref.cpu_model),
+        'distributionName': _string(ref.distribution_name),
+        'distributionVersion': _string(ref.distribution_version),
+        'numberOfProcessors': ref.number_of_processors,
+      };
+    } finally {
+      calloc.free(snapshot);
+    }
+  }
+
+  static String _string(Array<Char> field) {
+    final bytes = <int>[];
+    for (var i = 0; i < PV_STRING_SIZE; i++) {
+      final byte = field[i] & 0xff;
+      if (byte == 0) break;
+      bytes.add(byte);
+    }
+    return utf8.decode(bytes);
+  }
+
+  /// The static device properties and one sysinfo() and /proc/meminfo
+  /// sample, under the keys getDeviceInfo uses.
+  Map<String, dynamic> deviceInfo() {
+    final fields = _bindings.pv_sample_dynamic(
+      _dynamic,
+      PV_DYNAMIC_SYSINFO | PV_DYNAMIC_MEMINFO,
+    );
+    final sample = _dynamic.ref;
+    return {
+      ..._snapshot,
+      if (fields & PV_DYNAMIC_SYSINFO != 0) ...{
+        'totalRam': sample.total_ram,
+        'freeRam': sample.free_ram,
+        'sharedRam': sample.shared_ram,
+        'bufferRam': sample.buffer_ram,
+        'totalSwap': sample.total_swap,
+        'freeSwap': sample.free_swap,
+        'processes': sample.processes,
+        'uptime': sample.uptime,
+      },
+      if (fields & PV_DYNAMIC_MEMINFO != 0) ...{
+        'availableRam': sample.available_ram,
+        'cachedRam': sample.cached_ram,
+      },
+    };
+  }
+
+  /// `MemAvailable` in bytes from a single /proc/meminfo read, or `null` if
+  /// it could not be read. Does not allocate.
+  int? availableRam() {
+    final fields = _bindings.pv_sample_dynamic(_dynamic, PV_DYNAMIC_MEMINFO);
+    if (fields & PV_DYNAMIC_MEMINFO == 0) return null;
+    return _dynamic.ref.available_ram;
+  }
+}
@@ -0,0 +1,161 @@
+// Bindings for linux/include/platform_version/platform_version_ffi.h.
+//
+// Regenerate with `dart run ffigen --config ffigen.yaml` after changing the
+// header instead of editing this file.
+// ignore_for_file: type=lint
+import 'dart:ffi' as ffi;
+
+/// Bindings for the platform_version C ABI (Linux).
+class PlatformVersionFfiBindings {
+  /// Holds the symbol lookup function.
+  final ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName)
+  _lookup;
+
+  /// The symbols are looked up in [dynamicLibrary].
+  PlatformVersionFfiBindings(ffi.DynamicLibrary dynamicLibrary)
+    : _lookup = dynamicLibrary.lookup;
+
+  /// The symbols are looked up with [lookup].
+  PlatformVersionFfiBindings.fromLookup(
+    ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName)
+    lookup,
+  ) : _lookup = lookup;
+
+  /// Returns PV_ABI_VERSION as compiled into the library, so callers can refuse
+  /// a library whose layouts they do not know.
+  int pv_abi_version() {
+    return _pv_abi_version();
+  }
+
+  late final _pv_abi_versionPtr =
+      _lookup<ffi.NativeFunction<ffi.Uint32 Function()>>('pv_abi_version');
+  late final _pv_abi_version = _pv_abi_versionPtr.asFunction<int Function()>(
+    isLeaf: true,
+  );
+
+  /// Copies the static device properties into [out]. They are shared with the
+  /// plugin's getDeviceInfo: whichever asks first probes them, and both serve
+  /// them from memory afterwards. That first probe reads /proc/cpuinfo and
+  /// /etc/os-release and may wait for another process holding the stable ID's
+  /// lock, so it is not a leaf call; the plugin starts it in the background when
+  /// it registers. Returns 0, or -1 if [out] is null.
+  int pv_get_snapshot(ffi.Pointer<pv_snapshot> out) {
+    return _pv_get_snapshot(out);
+  }
+
+  late final _pv_get_snapshotPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<pv_snapshot>)>>(
+        'pv_get_snapshot',
+      );
+  late final _pv_get_snapshot = _pv_get_snapshotPtr
+      .asFunction<int Function(ffi.Pointer<pv_snapshot>)>();
+
+  /// Samples the PV_DYNAMIC_* groups in [fields] into [out] and returns the
+  /// groups that were sampled successfully, which are also stored in
+  /// out->fields. While configureSampler's background sampler refreshes a
+  /// group, it is copied from the latest sample instead. Takes no locks. The
+  /// /proc/meminfo reader is opened when the plugin registers; only a call made
+  /// before that allocates it and opens the files. Otherwise the call does not
+  /// allocate, and it blocks only in the sysinfo() and pread() it makes for
+  /// groups the sampler does not cover.
+  int pv_sample_dynamic(ffi.Pointer<pv_dynamic> out, int fields) {
+    return _pv_sample_dynamic(out, fields);
+  }
+
+  late final _pv_sample_dynamicPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Uint32 Function(ffi.Pointer<pv_dynamic>, ffi.Uint32)
+        >
+      >('pv_sample_dynamic');
+  late final _pv_sample_dynamic = _pv_sample_dynamicPtr
+      .asFunction<int Function(ffi.Pointer<pv_dynamic>, int)>(isLeaf: true);
+}
+
+/// Device properties that cannot change while the process is running; the
+/// same values getDeviceInfo reports under the matching keys.
+final class pv_snapshot extends ffi.Struct {
+  @ffi.Int64()
+  external int number_of_processors;
+
+  @ffi.Array.multi([128])
+  external ffi.Array<ffi.Char> stable_device_id;
+
+  @ffi.Array.multi([128])
+  external ffi.Array<ffi.Char> system_name;
+
+  @ffi.Array.multi([128])
+  external ffi.Array<ffi.Char> release;
+
+  @ffi.Array.multi([128])
+  external ffi.Array<ffi.Char> version;
+
+  @ffi.Array.multi([128])
+  external ffi.Array<ffi.Char> machine;
+
+  @ffi.Array.multi([128])
+  external ffi.Array<ffi.Char> cpu_model;
+
+  @ffi.Array.multi([128])
+  external ffi.Array<ffi.Char> distribution_name;
+
+  @ffi.Array.multi([128])
+  external ffi.Array<ffi.Char> distribution_version;
+}
+
+/// One sysinfo() call: the RAM, swap, process, uptime and load fields.
+const int PV_DYNAMIC_SYSINFO = 1;
+
+/// One pread() of /proc/meminfo: available_ram and cached_ram.
+const int PV_DYNAMIC_MEMINFO = 2;
+
+/// Values that change while the process runs, in the units getDeviceInfo and
+/// getMemoryInfo use. Groups that were not sampled are left zero.
+final class pv_dynamic extends ffi.Struct {
+  @ffi.Int64()
+  external int total_ram;
+
+  @ffi.Int64()
+  external int free_ram;
+
+  @ffi.Int64()
+  external int shared_ram;
+
+  @ffi.Int64()
+  external int buffer_ram;
+
+  @ffi.Int64()
+  external int total_swap;
+
+  @ffi.Int64()
+  external int free_swap;
+
+  @ffi.Int64()
+  external int uptime;
+
+  @ffi.Int64()
+  external int available_ram;
+
+  @ffi.Int64()
+  external int cached_ram;
+
+  @ffi.Double()
+  external double load1;
+
+  @ffi.Double()
+  external double load5;
+
+  @ffi.Double()
+  external double load15;
+
+  @ffi.Int32()
+  external int processes;
+
+  /// The PV_DYNAMIC_* groups that were sampled.
+  @ffi.Uint32()
+  external int fields;
+}
+
+const int PV_ABI_VERSION = 1;
+
+const int PV_STRING_SIZE = 128;
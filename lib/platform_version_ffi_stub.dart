@@ -0,0 +1,9 @@
+/// Stands in for the `dart:ffi` implementation on platforms without it.
+class PlatformVersionFfi {
+  /// Always `null`: there is no native library to call on this platform.
+  static PlatformVersionFfi? open() => null;
+
+  Map<String, dynamic> deviceInfo() => throw UnsupportedError('dart:ffi');
+
+  int? availableRam() => throw UnsupportedError('dart:ffi');
+}
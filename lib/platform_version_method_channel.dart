@@ -1,6 +1,8 @@
 import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 
+import 'platform_version_call.dart';
+import 'platform_version_device_info_record.dart';
 import 'platform_version_platform_interface.dart';
 
 /// An implementation of [PlatformVersionPlatform] that uses method channels.
@@ -9,6 +11,30 @@ class MethodChannelPlatformVersion extends PlatformVersionPlatform {
   @visibleForTesting
   final methodChannel = const MethodChannel('platform_version');
 
+  /// The event channel that streams memory, swap, load and uptime samples.
+  @visibleForTesting
+  final telemetryChannel = const EventChannel('platform_version/telemetry');
+
+  /// The event channel that streams per-core CPU usage.
+  @visibleForTesting
+  final cpuUsageChannel = const EventChannel('platform_version/cpu_usage');
+
+  /// The event channel that streams the app's own resource usage.
+  @visibleForTesting
+  final processInfoChannel = const EventChannel(
+    'platform_version/process_info',
+  );
+
+  /// The event channel that streams the CPU affinity mask.
+  @visibleForTesting
+  final cpuAffinityChannel = const EventChannel(
+    'platform_version/cpu_affinity',
+  );
+
+  /// The event channel that streams memory, CPU and I/O pressure transitions.
+  @visibleForTesting
+  final pressureChannel = const EventChannel('platform_version/pressure');
+
   @override
   Future<String?> getPlatformVersion() async {
     final version = await methodChannel.invokeMethod<String>(
@@ -18,9 +44,299 @@ class MethodChannelPlatformVersion extends PlatformVersionPlatform {
   }
 
   @override
-  Future<Map<String, dynamic>?> getDeviceInfo() async {
-    final result = await methodChannel.invokeMethod('getDeviceInfo');
+  Future<Map<String, dynamic>?> getDeviceInfo({List<String>? keys}) async {
+    final result = await methodChannel.invokeMethod(
+      'getDeviceInfo',
+      keys == null ? null : {'keys': keys},
+    );
+    if (result == null) return null;
+    final info = Map<String, dynamic>.from(result as Map);
+    // Platforms that do not support key selection return everything.
+    if (keys != null) info.removeWhere((key, _) => !keys.contains(key));
+    return info;
+  }
+
+  @override
+  Future<DeviceInfoRecord?> getDeviceInfoRecord() async {
+    final bytes = await methodChannel.invokeMethod<Uint8List>(
+      'getDeviceInfoRecord',
+    );
+    if (bytes == null) return null;
+    return DeviceInfoRecord.decode(bytes);
+  }
+
+  @override
+  Future<String?> getStableDeviceId() {
+    return methodChannel.invokeMethod<String>('getStableDeviceId');
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getMemoryInfo() async {
+    final result = await methodChannel.invokeMethod('getMemoryInfo');
     if (result == null) return null;
     return Map<String, dynamic>.from(result as Map);
   }
+
+  @override
+  Future<Map<String, dynamic>?> getCpuUsage() async {
+    final result = await methodChannel.invokeMethod('getCpuUsage');
+    if (result == null) return null;
+    return _deepCast(result as Map);
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getProcessInfo({bool pss = false}) async {
+    final result = await methodChannel.invokeMethod('getProcessInfo', {
+      'pss': pss,
+    });
+    if (result == null) return null;
+    return _deepCast(result as Map);
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getThreadCpuUsage() async {
+    final result = await methodChannel.invokeMethod('getThreadCpuUsage');
+    if (result == null) return null;
+    return _deepCast(result as Map);
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getCgroupLimits() async {
+    final result = await methodChannel.invokeMethod('getCgroupLimits');
+    if (result == null) return null;
+    return _deepCast(result as Map);
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getCpuAffinity() async {
+    final result = await methodChannel.invokeMethod('getCpuAffinity');
+    if (result == null) return null;
+    return _deepCast(result as Map);
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getCpuFeatures() async {
+    final result = await methodChannel.invokeMethod('getCpuFeatures');
+    if (result == null) return null;
+    return _deepCast(result as Map);
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getCpuTopology() async {
+    final result = await methodChannel.invokeMethod('getCpuTopology');
+    if (result == null) return null;
+    return _deepCast(result as Map);
+  }
+
+  @override
+  Stream<Map<String, dynamic>> cpuAffinityStream({
+    Duration interval = const Duration(seconds: 1),
+    bool refreshOnChange = true,
+  }) {
+    return cpuAffinityChannel
+        .receiveBroadcastStream({
+          'intervalMs': interval.inMilliseconds,
+          'refreshOnChange': refreshOnChange,
+        })
+        .map((event) => _deepCast(event as Map));
+  }
+
+  @override
+  Stream<Map<String, dynamic>> cpuUsageStream({
+    Duration interval = const Duration(seconds: 1),
+  }) {
+    return cpuUsageChannel
+        .receiveBroadcastStream({'intervalMs': interval.inMilliseconds})
+        .map((event) => _deepCast(event as Map));
+  }
+
+  @override
+  Stream<Map<String, dynamic>> processInfoStream({
+    Duration interval = const Duration(seconds: 1),
+    bool pss = false,
+  }) {
+    return processInfoChannel
+        .receiveBroadcastStream({
+          'intervalMs': interval.inMilliseconds,
+          'pss': pss,
+        })
+        .map((event) => _deepCast(event as Map));
+  }
+
+  @override
+  Stream<Map<String, dynamic>> pressureStream({
+    List<String> resources = const ['memory'],
+    Duration stall = const Duration(milliseconds: 150),
+    Duration window = const Duration(seconds: 1),
+    bool full = false,
+    Duration fallbackInterval = const Duration(seconds: 2),
+  }) {
+    return pressureChannel
+        .receiveBroadcastStream({
+          'resources': resources,
+          'type': full ? 'full' : 'some',
+          'stallUs': stall.inMicroseconds,
+          'windowUs': window.inMicroseconds,
+          'fallbackIntervalMs': fallbackInterval.inMilliseconds,
+        })
+        .map((event) => _deepCast(event as Map));
+  }
+
+  @override
+  Stream<Map<String, dynamic>> telemetryStream({
+    Duration interval = const Duration(seconds: 1),
+  }) {
+    return telemetryChannel
+        .receiveBroadcastStream({'intervalMs': interval.inMilliseconds})
+        .map((event) => Map<String, dynamic>.from(event as Map));
+  }
+
+  @override
+  Future<void> configureDispatch({
+    bool? async,
+    int? maxThreads,
+    int? maxQueuedCalls,
+  }) async {
+    try {
+      await methodChannel.invokeMethod<void>('configureDispatch', {
+        if (async != null) 'async': async,
+        if (maxThreads != null) 'maxThreads': maxThreads,
+        if (maxQueuedCalls != null) 'maxQueuedCalls': maxQueuedCalls,
+      });
+    } on MissingPluginException {
+      // Only the Linux implementation has a configurable dispatcher.
+    }
+  }
+
+  @override
+  Future<List<Object?>> batch(List<PlatformVersionCall> calls) async {
+    final List<Object?>? replies;
+    try {
+      replies = await methodChannel.invokeListMethod<Object?>('batch', {
+        'calls': [
+          for (final call in calls)
+            {'method': call.method, 'arguments': call.arguments},
+        ],
+      });
+    } on MissingPluginException {
+      // Only the Linux implementation batches natively; elsewhere the calls
+      // go over the channel one by one.
+      return [for (final call in calls) await _invokeOne(call)];
+    }
+    if (replies == null || replies.length != calls.length) {
+      throw PlatformException(
+        code: 'INVALID_REPLY',
+        message: 'batch returned ${replies?.length} replies '
+            'for ${calls.length} calls',
+      );
+    }
+    return [
+      for (var i = 0; i < calls.length; i++)
+        _decodeBatchReply(calls[i].method, replies[i] as Map),
+    ];
+  }
+
+  Future<Object?> _invokeOne(PlatformVersionCall call) async {
+    try {
+      final result = await methodChannel.invokeMethod<Object?>(
+        call.method,
+        call.arguments,
+      );
+      return _decodeBatchResult(call.method, result);
+    } on PlatformException catch (e) {
+      return e;
+    } on MissingPluginException catch (e) {
+      return e;
+    }
+  }
+
+  static Object? _decodeBatchReply(String method, Map reply) {
+    if (reply.containsKey('result')) {
+      return _decodeBatchResult(method, reply['result']);
+    }
+    final error = reply['error'];
+    if (error is Map) {
+      return PlatformException(
+        code: error['code'] as String,
+        message: error['message'] as String?,
+        details: error['details'],
+      );
+    }
+    return MissingPluginException(
+      'No implementation found for method $method',
+    );
+  }
+
+  static Object? _decodeBatchResult(String method, Object? result) {
+    if (method == 'getDeviceInfoRecord' && result is Uint8List) {
+      return DeviceInfoRecord.decode(result);
+    }
+    return _deepCastValue(result);
+  }
+
+  @override
+  Future<void> configureSampler({
+    bool enabled = true,
+    Duration interval = const Duration(seconds: 1),
+    List<String>? metrics,
+  }) async {
+    try {
+      await methodChannel.invokeMethod<void>('configureSampler', {
+        'enabled': enabled,
+        'intervalMs': interval.inMilliseconds,
+        if (metrics != null) 'metrics': metrics,
+      });
+    } on MissingPluginException {
+      // Only the Linux implementation has a background sampler.
+    }
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getSampledMetrics() async {
+    final result = await methodChannel.invokeMethod('getSampledMetrics');
+    if (result == null) return null;
+    return _deepCast(result as Map);
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getPluginMetrics({bool reset = false}) async {
+    final result = await methodChannel.invokeMethod('getPluginMetrics', {
+      'reset': reset,
+    });
+    if (result == null) return null;
+    return _deepCast(result as Map);
+  }
+
+  @override
+  Future<void> configureTracing({required bool enabled}) async {
+    try {
+      await methodChannel.invokeMethod<void>('configureTracing', {
+        'enabled': enabled,
+      });
+    } on MissingPluginException {
+      // Only the Linux implementation records trace events.
+    }
+  }
+
+  @override
+  Future<int?> dumpTrace(String path, {bool clear = true}) {
+    return methodChannel.invokeMethod<int>('dumpTrace', {
+      'path': path,
+      'clear': clear,
+    });
+  }
+
+  /// Converts a decoded map, including nested maps and lists, to
+  /// `Map<String, dynamic>`.
+  static Map<String, dynamic> _deepCast(Map map) {
+    return map.map(
+      (key, value) => MapEntry(key as String, _deepCastValue(value)),
+    );
+  }
+
+  static dynamic _deepCastValue(dynamic value) {
+    if (value is Map) return _deepCast(value);
+    if (value is List) return value.map(_deepCastValue).toList();
+    return value;
+  }
 }
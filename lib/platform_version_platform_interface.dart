@@ -1,5 +1,7 @@
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
+import 'platform_version_call.dart';
+import 'platform_version_device_info_record.dart';
 import 'platform_version_method_channel.dart';
 
 abstract class PlatformVersionPlatform extends PlatformInterface {
@@ -27,7 +29,126 @@ abstract class PlatformVersionPlatform extends PlatformInterface {
     throw UnimplementedError('platformVersion() has not been implemented.');
   }
 
-  Future<Map<String, dynamic>?> getDeviceInfo() {
+  Future<Map<String, dynamic>?> getDeviceInfo({List<String>? keys}) {
     throw UnimplementedError('getDeviceInfo() has not been implemented.');
   }
+
+  Future<DeviceInfoRecord?> getDeviceInfoRecord() {
+    throw UnimplementedError(
+      'getDeviceInfoRecord() has not been implemented.',
+    );
+  }
+
+  /// Returns the stable device ID. Platforms without a dedicated native
+  /// method read it from [getDeviceInfo].
+  Future<String?> getStableDeviceId() async {
+    final info = await getDeviceInfo();
+    final value = info?['stableDeviceId'];
+    if (value is String) return value;
+    return value?.toString();
+  }
+
+  Future<Map<String, dynamic>?> getMemoryInfo() {
+    throw UnimplementedError('getMemoryInfo() has not been implemented.');
+  }
+
+  Future<Map<String, dynamic>?> getCpuUsage() {
+    throw UnimplementedError('getCpuUsage() has not been implemented.');
+  }
+
+  Future<Map<String, dynamic>?> getProcessInfo({bool pss = false}) {
+    throw UnimplementedError('getProcessInfo() has not been implemented.');
+  }
+
+  Future<Map<String, dynamic>?> getThreadCpuUsage() {
+    throw UnimplementedError('getThreadCpuUsage() has not been implemented.');
+  }
+
+  Future<Map<String, dynamic>?> getCgroupLimits() {
+    throw UnimplementedError('getCgroupLimits() has not been implemented.');
+  }
+
+  Future<Map<String, dynamic>?> getCpuAffinity() {
+    throw UnimplementedError('getCpuAffinity() has not been implemented.');
+  }
+
+  Future<Map<String, dynamic>?> getCpuFeatures() {
+    throw UnimplementedError('getCpuFeatures() has not been implemented.');
+  }
+
+  Future<Map<String, dynamic>?> getCpuTopology() {
+    throw UnimplementedError('getCpuTopology() has not been implemented.');
+  }
+
+  Stream<Map<String, dynamic>> cpuAffinityStream({
+    Duration interval = const Duration(seconds: 1),
+    bool refreshOnChange = true,
+  }) {
+    throw UnimplementedError('cpuAffinityStream() has not been implemented.');
+  }
+
+  Stream<Map<String, dynamic>> cpuUsageStream({
+    Duration interval = const Duration(seconds: 1),
+  }) {
+    throw UnimplementedError('cpuUsageStream() has not been implemented.');
+  }
+
+  Stream<Map<String, dynamic>> processInfoStream({
+    Duration interval = const Duration(seconds: 1),
+    bool pss = false,
+  }) {
+    throw UnimplementedError('processInfoStream() has not been implemented.');
+  }
+
+  Stream<Map<String, dynamic>> pressureStream({
+    List<String> resources = const ['memory'],
+    Duration stall = const Duration(milliseconds: 150),
+    Duration window = const Duration(seconds: 1),
+    bool full = false,
+    Duration fallbackInterval = const Duration(seconds: 2),
+  }) {
+    throw UnimplementedError('pressureStream() has not been implemented.');
+  }
+
+  Stream<Map<String, dynamic>> telemetryStream({
+    Duration interval = const Duration(seconds: 1),
+  }) {
+    throw UnimplementedError('telemetryStream() has not been implemented.');
+  }
+
+  Future<List<Object?>> batch(List<PlatformVersionCall> calls) {
+    throw UnimplementedError('batch() has not been implemented.');
+  }
+
+  Future<void> configureSampler({
+    bool enabled = true,
+    Duration interval = const Duration(seconds: 1),
+    List<String>? metrics,
+  }) {
+    throw UnimplementedError('configureSampler() has not been implemented.');
+  }
+
+  Future<Map<String, dynamic>?> getSampledMetrics() {
+    throw UnimplementedError('getSampledMetrics() has not been implemented.');
+  }
+
+  Future<Map<String, dynamic>?> getPluginMetrics({bool reset = false}) {
+    throw UnimplementedError('getPluginMetrics() has not been implemented.');
+  }
+
+  Future<void> configureTracing({required bool enabled}) {
+    throw UnimplementedError('configureTracing() has not been implemented.');
+  }
+
+  Future<int?> dumpTrace(String path, {bool clear = true}) {
+    throw UnimplementedError('dumpTrace() has not been implemented.');
+  }
+
+  Future<void> configureDispatch({
+    bool? async,
+    int? maxThreads,
+    int? maxQueuedCalls,
+  }) {
+    throw UnimplementedError('configureDispatch() has not been implemented.');
+  }
 }
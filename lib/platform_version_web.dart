@@ -5,9 +5,11 @@
 
 import 'dart:math';
 
+import 'package:flutter/services.dart';
 import 'package:flutter_web_plugins/flutter_web_plugins.dart';
 import 'package:web/web.dart' as web;
 
+import 'platform_version_call.dart';
 import 'platform_version_platform_interface.dart';
 
 /// A web implementation of the PlatformVersionPlatform of the PlatformVersion plugin.
@@ -28,10 +30,10 @@ class PlatformVersionWeb extends PlatformVersionPlatform {
 
   /// Returns a [Map] containing device information for web platform.
   @override
-  Future<Map<String, dynamic>?> getDeviceInfo() async {
+  Future<Map<String, dynamic>?> getDeviceInfo({List<String>? keys}) async {
     final navigator = web.window.navigator;
     final stableDeviceId = _getOrCreateStableDeviceId();
-    return {
+    final info = <String, dynamic>{
       'stableDeviceId': stableDeviceId,
       'platform': navigator.platform,
       'userAgent': navigator.userAgent,
@@ -47,8 +49,60 @@ class PlatformVersionWeb extends PlatformVersionPlatform {
       'appVersion': navigator.appVersion,
       'appCodeName': navigator.appCodeName,
     };
+    if (keys != null) info.removeWhere((key, _) => !keys.contains(key));
+    return info;
   }
 
+  /// Returns the stable device ID kept in `localStorage`.
+  @override
+  Future<String?> getStableDeviceId() async {
+    return _getOrCreateStableDeviceId();
+  }
+
+  /// Answers each call directly; there is no channel round trip to save.
+  @override
+  Future<List<Object?>> batch(List<PlatformVersionCall> calls) async {
+    return [
+      for (final call in calls)
+        switch (call.method) {
+          'getPlatformVersion' => await getPlatformVersion(),
+          'getStableDeviceId' => await getStableDeviceId(),
+          'getDeviceInfo' => await getDeviceInfo(
+            keys: (call.arguments as Map?)?['keys'] == null
+                ? null
+                : List<String>.from((call.arguments as Map)['keys'] as List),
+          ),
+          _ => MissingPluginException(
+            'No implementation found for method ${call.method}',
+          ),
+        },
+    ];
+  }
+
+  /// Browsers expose no system counters to sample; nothing to configure.
+  @override
+  Future<void> configureSampler({
+    bool enabled = true,
+    Duration interval = const Duration(seconds: 1),
+    List<String>? metrics,
+  }) async {}
+
+  /// Returns null, as when the sampler is disabled.
+  @override
+  Future<Map<String, dynamic>?> getSampledMetrics() async => null;
+
+  /// There is no native work to trace on web; the call is ignored.
+  @override
+  Future<void> configureTracing({required bool enabled}) async {}
+
+  /// Method calls are answered synchronously on web; nothing to configure.
+  @override
+  Future<void> configureDispatch({
+    bool? async,
+    int? maxThreads,
+    int? maxQueuedCalls,
+  }) async {}
+
   String _getOrCreateStableDeviceId() {
     const storageKey = 'platform_version_stable_device_id';
 
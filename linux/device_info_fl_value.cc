@@ -0,0 +1,22 @@
+#include "device_info_fl_value.h"
+
+FlValue* device_info_value_to_fl_value(DeviceInfoValue value) {
+  return value.string != nullptr ? fl_value_new_string(value.string)
+                                 : fl_value_new_int(value.number);
+}
+
+void fl_value_set_device_info(FlValue* map, const DeviceInfo& info) {
+  DeviceInfoValue value;
+  for (const DeviceInfoField& field : kDeviceInfoFields) {
+    if (device_info_get(info, field, &value)) {
+      fl_value_set_string_take(map, field.key,
+                               device_info_value_to_fl_value(value));
+    }
+  }
+}
+
+FlValue* device_info_to_fl_value(const DeviceInfo& info) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_device_info(map, info);
+  return map;
+}
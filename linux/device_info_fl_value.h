@@ -0,0 +1,21 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_FL_VALUE_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_FL_VALUE_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include "device_info_fields.h"
+
+// Converts the core's DeviceInfo to the FlValue maps sent over the method
+// channel.
+
+// Returns [value] as an FlValue string or int.
+FlValue* device_info_value_to_fl_value(DeviceInfoValue value);
+
+// Adds the members of [info] that are set to the FlValue map [map], in
+// reporting order.
+void fl_value_set_device_info(FlValue* map, const DeviceInfo& info);
+
+// Returns [info] as a new FlValue map.
+FlValue* device_info_to_fl_value(const DeviceInfo& info);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_FL_VALUE_H_
@@ -0,0 +1,102 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_FFI_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_FFI_H_
+
+// A plain C ABI for reading device information synchronously through
+// dart:ffi, without a platform channel hop or codec round trip. The
+// functions are exported from the plugin's shared library and may be called
+// from any thread, before or after the plugin is registered.
+//
+// The Dart bindings in lib/platform_version_ffi_bindings.dart mirror this
+// header; regenerate them with `dart run ffigen --config ffigen.yaml` after
+// changing it, and bump PV_ABI_VERSION whenever a layout changes.
+
+#include <stdint.h>
+
+#ifndef FLUTTER_PLUGIN_EXPORT
+#ifdef FLUTTER_PLUGIN_IMPL
+#define FLUTTER_PLUGIN_EXPORT __attribute__((visibility("default")))
+#else
+#define FLUTTER_PLUGIN_EXPORT
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PV_ABI_VERSION 1
+
+// Size of every string field, including the terminating NUL. Longer values
+// are truncated at a UTF-8 character boundary.
+#define PV_STRING_SIZE 128
+
+// Device properties that cannot change while the process is running; the
+// same values getDeviceInfo reports under the matching keys.
+typedef struct pv_snapshot {
+  int64_t number_of_processors;
+  char stable_device_id[PV_STRING_SIZE];
+  char system_name[PV_STRING_SIZE];
+  char release[PV_STRING_SIZE];
+  char version[PV_STRING_SIZE];
+  char machine[PV_STRING_SIZE];
+  char cpu_model[PV_STRING_SIZE];
+  char distribution_name[PV_STRING_SIZE];
+  char distribution_version[PV_STRING_SIZE];
+} pv_snapshot;
+
+// Field groups for pv_sample_dynamic().
+enum {
+  // One sysinfo() call: the RAM, swap, process, uptime and load fields.
+  PV_DYNAMIC_SYSINFO = 1 << 0,
+  // One pread() of /proc/meminfo: available_ram and cached_ram.
+  PV_DYNAMIC_MEMINFO = 1 << 1,
+};
+
+// Values that change while the process runs, in the units getDeviceInfo and
+// getMemoryInfo use. Groups that were not sampled are left zero.
+typedef struct pv_dynamic {
+  int64_t total_ram;
+  int64_t free_ram;
+  int64_t shared_ram;
+  int64_t buffer_ram;
+  int64_t total_swap;
+  int64_t free_swap;
+  int64_t uptime;
+  int64_t available_ram;
+  int64_t cached_ram;
+  double load1;
+  double load5;
+  double load15;
+  int32_t processes;
+  // The PV_DYNAMIC_* groups that were sampled.
+  uint32_t fields;
+} pv_dynamic;
+
+// Returns PV_ABI_VERSION as compiled into the library, so callers can refuse
+// a library whose layouts they do not know.
+FLUTTER_PLUGIN_EXPORT uint32_t pv_abi_version(void);
+
+// Copies the static device properties into [out]. They are shared with the
+// plugin's getDeviceInfo: whichever asks first probes them, and both serve
+// them from memory afterwards. That first probe reads /proc/cpuinfo and
+// /etc/os-release and may wait for another process holding the stable ID's
+// lock, so it is not a leaf call; the plugin starts it in the background when
+// it registers. Returns 0, or -1 if [out] is null.
+FLUTTER_PLUGIN_EXPORT int32_t pv_get_snapshot(pv_snapshot* out);
+
+// Samples the PV_DYNAMIC_* groups in [fields] into [out] and returns the
+// groups that were sampled successfully, which are also stored in
+// out->fields. While configureSampler's background sampler refreshes a
+// group, it is copied from the latest sample instead. Takes no locks. The
+// /proc/meminfo reader is opened when the plugin registers; only a call made
+// before that allocates it and opens the files. Otherwise the call does not
+// allocate, and it blocks only in the sysinfo() and pread() it makes for
+// groups the sampler does not cover.
+FLUTTER_PLUGIN_EXPORT uint32_t pv_sample_dynamic(pv_dynamic* out,
+                                                 uint32_t fields);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_FFI_H_
@@ -0,0 +1,146 @@
+#include "include/platform_version/platform_version_ffi.h"
+
+#include <sys/sysinfo.h>
+
+#include <sched.h>
+
+#include <atomic>
+#include <cstring>
+
+#include "platform_version_ffi_private.h"
+#include "string_util.h"
+#include "sysroot.h"
+
+// The probes pv_get_snapshot() reports; their results are shared with the
+// plugin's getDeviceInfo through the same DeviceSnapshot.
+static const unsigned kSnapshotProbes = kProbeStableDeviceId | kProbeKernel |
+                                        kProbeProcessors | kProbeCpuInfo |
+                                        kProbeOsRelease;
+
+// The background sampler published by configureSampler, if any, and the
+// number of pv_sample_dynamic() calls that may be reading it. Readers never
+// wait: withdrawing clears the pointer and then waits for the count to drain.
+// Both are sequentially consistent so that a reader either sees the pointer
+// cleared or is seen by the withdrawing thread.
+static std::atomic<const MetricsSampler*> ffi_sampler{nullptr};
+static std::atomic<int> ffi_sampler_readers{0};
+
+DeviceSnapshot* platform_version_shared_snapshot() {
+  static DeviceSnapshot* snapshot = new DeviceSnapshot();
+  return snapshot;
+}
+
+const MemInfoReader* platform_version_shared_meminfo_reader() {
+  static const MemInfoReader* reader = [] {
+    MemInfoReader* opened = new MemInfoReader();
+    const char* sysroot = sysroot_from_environment();
+    meminfo_reader_open(opened, sysroot_path(sysroot, "/proc/meminfo").path,
+                        sysroot_path(sysroot, "/proc/vmstat").path);
+    return opened;
+  }();
+  return reader;
+}
+
+void platform_version_ffi_publish_sampler(const MetricsSampler* sampler) {
+  ffi_sampler.store(sampler);
+}
+
+void platform_version_ffi_withdraw_sampler(const MetricsSampler* sampler) {
+  const MetricsSampler* expected = sampler;
+  ffi_sampler.compare_exchange_strong(expected, nullptr);
+  // A reader holds the sampler for one seqlock copy, so this is brief.
+  while (ffi_sampler_readers.load() != 0) sched_yield();
+}
+
+// Copies [value] into the fixed-size field [out], truncating at a UTF-8
+// character boundary so Dart can always decode the result.
+static void copy_string(char (&out)[PV_STRING_SIZE], const std::string& value) {
+  size_t length = utf8_truncated_length(value, PV_STRING_SIZE - 1);
+  memcpy(out, value.data(), length);
+  out[length] = '\0';
+}
+
+// Copies the published sampler's latest sample into [sample]. Returns the
+// groups it holds, or zero if there is no sampler.
+static unsigned read_published_sample(MetricsSample* sample) {
+  ffi_sampler_readers.fetch_add(1);
+  const MetricsSampler* sampler = ffi_sampler.load();
+  unsigned sampled = sampler != nullptr && metrics_sampler_read(sampler, sample)
+                         ? sample->metrics
+                         : 0;
+  ffi_sampler_readers.fetch_sub(1);
+  return sampled;
+}
+
+uint32_t pv_abi_version(void) {
+  return PV_ABI_VERSION;
+}
+
+int32_t pv_get_snapshot(pv_snapshot* out) {
+  if (out == nullptr) return -1;
+  DeviceInfoProbeContext context = {platform_version_shared_snapshot(),
+                                    nullptr, nullptr, nullptr,
+                                    sysroot_from_environment()};
+  DeviceInfoProbeResults results = {};
+  device_info_run_probes(context, kSnapshotProbes, &results);
+
+  const DeviceSnapshot& snapshot = *results.snapshot;
+  *out = {};
+  out->number_of_processors = snapshot.number_of_processors;
+  copy_string(out->stable_device_id, snapshot.stable_device_id);
+  copy_string(out->system_name, snapshot.system_name);
+  copy_string(out->release, snapshot.release);
+  copy_string(out->version, snapshot.version);
+  copy_string(out->machine, snapshot.machine);
+  copy_string(out->cpu_model, snapshot.cpu_model);
+  copy_string(out->distribution_name, snapshot.distribution_name);
+  copy_string(out->distribution_version, snapshot.distribution_version);
+  return 0;
+}
+
+uint32_t pv_sample_dynamic(pv_dynamic* out, uint32_t fields) {
+  if (out == nullptr) return 0;
+  *out = {};
+
+  MetricsSample sample;
+  unsigned sampled = (fields & (PV_DYNAMIC_SYSINFO | PV_DYNAMIC_MEMINFO))
+                         ? read_published_sample(&sample)
+                         : 0;
+
+  struct sysinfo sys_info = {};
+  if ((fields & PV_DYNAMIC_SYSINFO) &&
+      ((sampled & kMetricSysinfo) || sysinfo(&sys_info) == 0)) {
+    if (sampled & kMetricSysinfo) sys_info = sample.sys_info;
+    // sysinfo() reports load averages as fixed-point numbers.
+    const double load_scale = static_cast<double>(1 << SI_LOAD_SHIFT);
+    out->total_ram = sys_info.totalram;
+    out->free_ram = sys_info.freeram;
+    out->shared_ram = sys_info.sharedram;
+    out->buffer_ram = sys_info.bufferram;
+    out->total_swap = sys_info.totalswap;
+    out->free_swap = sys_info.freeswap;
+    out->uptime = sys_info.uptime;
+    out->processes = sys_info.procs;
+    out->load1 = sys_info.loads[0] / load_scale;
+    out->load5 = sys_info.loads[1] / load_scale;
+    out->load15 = sys_info.loads[2] / load_scale;
+    out->fields |= PV_DYNAMIC_SYSINFO;
+  }
+
+  if (fields & PV_DYNAMIC_MEMINFO) {
+    // Only /proc/meminfo is read: the swap counters from /proc/vmstat are
+    // not part of pv_dynamic, and skipping them halves the cost of a sample.
+    MemInfoReader meminfo_only = {
+        platform_version_shared_meminfo_reader()->meminfo_fd, -1};
+    MemInfo meminfo;
+    if ((sampled & kMetricMeminfo) ||
+        meminfo_reader_read(&meminfo_only, &meminfo)) {
+      if (sampled & kMetricMeminfo) meminfo = sample.meminfo;
+      out->available_ram = static_cast<int64_t>(meminfo.mem_available);
+      out->cached_ram = static_cast<int64_t>(meminfo.cached);
+      out->fields |= PV_DYNAMIC_MEMINFO;
+    }
+  }
+
+  return out->fields;
+}
@@ -0,0 +1,29 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_FFI_PRIVATE_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_FFI_PRIVATE_H_
+
+#include "device_info.h"
+#include "meminfo.h"
+#include "metrics_sampler.h"
+
+// Process-wide probe state shared by the plugin and the C ABI in
+// platform_version_ffi.cc, so that both serve the same cached static
+// properties and neither probes them twice. Not exported from the library.
+
+// The static probe cache. Created on first use and never freed.
+DeviceSnapshot* platform_version_shared_snapshot();
+
+// /proc/meminfo and /proc/vmstat under the PLATFORM_VERSION_SYSROOT root,
+// opened on first use, which the plugin makes at registration, and never
+// closed.
+const MemInfoReader* platform_version_shared_meminfo_reader();
+
+// Makes pv_sample_dynamic() copy the groups [sampler] refreshes instead of
+// making syscalls. Replaces any sampler published before.
+void platform_version_ffi_publish_sampler(const MetricsSampler* sampler);
+
+// Stops pv_sample_dynamic() from reading [sampler], if it is the one
+// published, and waits for reads in progress, spinning rather than making
+// readers take a lock. Call before stopping it.
+void platform_version_ffi_withdraw_sampler(const MetricsSampler* sampler);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_FFI_PRIVATE_H_
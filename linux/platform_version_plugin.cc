@@ -5,72 +5,389 @@
 #include <sys/utsname.h>
 #include <sys/sysinfo.h>
 #include <unistd.h>
-#include <fstream>
+#include <algorithm>
+#include <iterator>
 #include <string>
+#include <vector>
 
 #include <glib.h>
 #include <glib/gstdio.h>
 
+#include <cerrno>
 #include <cstring>
 
+#include "cgroup.h"
+#include "cpu_affinity.h"
+#include "cpu_features.h"
+#include "cpu_topology.h"
+#include "cpu_usage.h"
+#include "device_info.h"
+#include "device_info_fl_value.h"
+#include "latency_histogram.h"
+#include "meminfo.h"
+#include "metrics_sampler.h"
+#include "platform_version_ffi_private.h"
 #include "platform_version_plugin_private.h"
+#include "pressure_monitor.h"
+#include "proc_parser.h"
+#include "process_stats.h"
+#include "stable_device_id.h"
+#include "sysroot.h"
+#include "thread_stats.h"
+#include "trace_recorder.h"
 
 #define PLATFORM_VERSION_PLUGIN(obj) \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), platform_version_plugin_get_type(), \
                               PlatformVersionPlugin))
 
+// Methods with their own latency histogram; any other method is counted
+// under "other".
+static const char* const kInstrumentedMethods[] = {
+    "getPlatformVersion", "getDeviceInfo",     "getDeviceInfoRecord",
+    "getMemoryInfo",      "getCgroupLimits",   "getCpuAffinity",
+    "getCpuFeatures",     "getCpuTopology",    "getCpuUsage",
+    "getProcessInfo",     "getThreadCpuUsage", "getStableDeviceId",
+    "getSampledMetrics",  "getPluginMetrics",  "configureSampler",
+    "configureTracing",   "dumpTrace",         "batch",
+    "other",
+};
+
+// Latency histograms for the method handlers and the getDeviceInfo probes.
+// Recorded from any thread without locking.
+struct PluginMetrics {
+  LatencyHistogram methods[G_N_ELEMENTS(kInstrumentedMethods)];
+  LatencyHistogram probes[kProbeCount];
+  // latency_now_ns() when the histograms were last reset.
+  std::atomic<uint64_t> since_ns;
+};
+
+// Default size of the worker pool used for asynchronous dispatch.
+static const gint kDefaultWorkerThreads = 2;
+
+// Default number of method calls that may wait for a free worker before new
+// calls are rejected.
+static const guint kDefaultMaxQueuedCalls = 32;
+
+// Default and minimum sampling intervals for the event streams.
+static const guint kDefaultStreamIntervalMs = 1000;
+static const gint64 kMinStreamIntervalMs = 10;
+
+// A Dart event stream fed by a main-loop timer while a listener is attached.
+typedef struct {
+  PlatformVersionPlugin* self;
+  FlEventChannel* channel;
+  guint source_id;
+  // Takes one sample, or returns nullptr to skip this tick.
+  FlValue* (*sample)(PlatformVersionPlugin* self);
+  // Called with the listen arguments before the first sample of each
+  // subscription; may be nullptr.
+  void (*reset)(PlatformVersionPlugin* self, FlValue* args);
+  // When set, [reset] and [sample] run one at a time on this single-thread
+  // pool and only the send is posted back to the main loop, for samples
+  // that may take long. Ticks are skipped while a sample is [pending].
+  GThreadPool* sample_pool;
+  guint pending;
+  // Bumped each time the stream stops, so that samples taken for an earlier
+  // subscription are dropped rather than sent.
+  guint generation;
+} PeriodicStream;
+
 struct _PlatformVersionPlugin {
   GObject parent_instance;
+
+  // Filled in by get_device_info() as static probes run; shared with every
+  // other plugin instance and the C ABI (see platform_version_ffi_private.h).
+  DeviceSnapshot* snapshot;
+
+  // Directory /proc, /sys and /etc are read from, from
+  // PLATFORM_VERSION_SYSROOT; "" for the live system.
+  const char* sysroot;
+
+  // When set, method calls are handled on [worker_pool] and answered on
+  // [main_context] instead of blocking the platform thread.
+  gboolean async_dispatch;
+  gint worker_threads;
+  guint max_queued_calls;
+  GThreadPool* worker_pool;
+  GMainContext* main_context;
+
+  // Instruction-set extensions, detected once at registration; a mask of
+  // 1 << CpuFeature bits.
+  guint64 cpu_features;
+
+  // /proc/meminfo and /proc/vmstat, kept open for pread(); shared like
+  // [snapshot].
+  const MemInfoReader* meminfo_reader;
+
+  // Previous /proc/stat sample for getCpuUsage.
+  CpuUsageSampler* cpu_usage_sampler;
+  GMutex cpu_usage_mutex;
+
+  // /proc/self/stat, statm, status, io and smaps_rollup, kept open for
+  // pread().
+  ProcessStatsReader process_stats_reader;
+
+  // Previous sample for the deltas of getProcessInfo.
+  ProcessStats* process_info_previous;
+  GMutex process_info_mutex;
+
+  // /proc/self/task and the stat file of each thread, and the previous
+  // per-thread sample for getThreadCpuUsage. Opened on first use.
+  ThreadStatsSampler* thread_stats_sampler;
+  GMutex thread_stats_mutex;
+
+  // Streams sysinfo() samples to Dart.
+  PeriodicStream telemetry_stream;
+
+  // Streams per-core CPU usage to Dart, with its own baseline; only touched
+  // on the main thread.
+  PeriodicStream cpu_usage_stream;
+  CpuUsageSampler* cpu_usage_stream_sampler;
+
+  // Streams process resource usage to Dart, with its own baseline and PSS
+  // option; only touched on the stream's sample thread, since reading
+  // smaps_rollup walks every mapping of the process.
+  PeriodicStream process_info_stream;
+  ProcessStats* process_info_stream_previous;
+  gboolean process_info_stream_pss;
+
+  // Streams the CPU affinity mask to Dart. With [affinity_stream_on_change]
+  // set, only changes to [affinity_stream_cpus] are sent.
+  PeriodicStream affinity_stream;
+  std::vector<int>* affinity_stream_cpus;
+  gboolean affinity_stream_on_change;
+
+  // Streams PSI pressure transitions to Dart.
+  PressureMonitor* pressure_monitor;
+
+  // Refreshes dynamic metrics in the background once configureSampler has
+  // enabled it; the probes then copy its latest sample instead of making
+  // syscalls. Created under [sampler_mutex], read with g_atomic_pointer_get()
+  // and only stopped in dispose.
+  MetricsSampler* metrics_sampler;
+  GMutex sampler_mutex;
+
+  // Handler and probe latencies for getPluginMetrics.
+  PluginMetrics* metrics;
 };
 
 G_DEFINE_TYPE(PlatformVersionPlugin, platform_version_plugin, g_object_get_type())
 
-static std::string get_or_create_stable_device_id() {
-  const char* config_dir = g_get_user_config_dir();
-  std::string base_dir = config_dir != nullptr ? std::string(config_dir) : std::string(".");
-  std::string dir_path = base_dir + "/platform_version";
-  std::string file_path = dir_path + "/stable_device_id";
+// A method call handed to the worker pool. Holds references to everything
+// it touches so the call can outlive the handler that queued it.
+typedef struct {
+  PlatformVersionPlugin* self;
+  FlMethodCall* method_call;
+  FlMethodResponse* response;
+} MethodCallJob;
+
+
+static FlMethodResponse* platform_version_plugin_respond(
+    PlatformVersionPlugin* self,
+    const gchar* method,
+    FlValue* args,
+    DeviceInfoProbeResults* results);
+
+// Builds the response to a method call. Runs on a worker thread when
+// asynchronous dispatch is enabled, so it must not touch GTK.
+static FlMethodResponse* platform_version_plugin_build_response(
+    PlatformVersionPlugin* self,
+    FlMethodCall* method_call);
+
+static void method_call_job_free(MethodCallJob* job) {
+  g_clear_object(&job->response);
+  g_object_unref(job->method_call);
+  g_object_unref(job->self);
+  g_free(job);
+}
+
+// Sends a response computed by a worker. Always runs on the main context.
+static gboolean method_call_job_respond_cb(gpointer user_data) {
+  MethodCallJob* job = static_cast<MethodCallJob*>(user_data);
+  fl_method_call_respond(job->method_call, job->response, nullptr);
+  method_call_job_free(job);
+  return G_SOURCE_REMOVE;
+}
+
+static void method_call_job_run(gpointer data, gpointer user_data) {
+  MethodCallJob* job = static_cast<MethodCallJob*>(data);
+  job->response =
+      platform_version_plugin_build_response(job->self, job->method_call);
+  g_main_context_invoke(job->self->main_context, method_call_job_respond_cb,
+                        job);
+}
+
+// Queues [method_call] on the worker pool. Returns FALSE if the pool could not
+// be created, in which case the caller handles the call synchronously.
+static gboolean platform_version_plugin_dispatch_async(
+    PlatformVersionPlugin* self,
+    FlMethodCall* method_call) {
+  if (self->worker_pool == nullptr) {
+    g_autoptr(GError) error = nullptr;
+    self->worker_pool = g_thread_pool_new(method_call_job_run, self,
+                                          self->worker_threads, FALSE, &error);
+    if (self->worker_pool == nullptr) {
+      g_warning("Failed to create worker pool: %s", error->message);
+      return FALSE;
+    }
+  }
+
+  if (g_thread_pool_unprocessed(self->worker_pool) >= self->max_queued_calls) {
+    g_autoptr(FlMethodResponse) response = FL_METHOD_RESPONSE(
+        fl_method_error_response_new("BUSY", "Too many pending method calls",
+                                     nullptr));
+    fl_method_call_respond(method_call, response, nullptr);
+    return TRUE;
+  }
+
+  MethodCallJob* job = g_new0(MethodCallJob, 1);
+  job->self = PLATFORM_VERSION_PLUGIN(g_object_ref(self));
+  job->method_call = FL_METHOD_CALL(g_object_ref(method_call));
+  g_thread_pool_push(self->worker_pool, job, nullptr);
+  return TRUE;
+}
+
+FlMethodResponse* configure_dispatch(PlatformVersionPlugin* self,
+                                     FlValue* args) {
+  if (args != nullptr && fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENTS", "Expected a map", nullptr));
+  }
+
+  FlValue* async_value =
+      args != nullptr ? fl_value_lookup_string(args, "async") : nullptr;
+  if (async_value != nullptr &&
+      fl_value_get_type(async_value) == FL_VALUE_TYPE_BOOL) {
+    self->async_dispatch = fl_value_get_bool(async_value);
+  }
 
-  {
-    std::ifstream in(file_path);
-    std::string existing;
-    if (in.good() && std::getline(in, existing)) {
-      if (!existing.empty()) return existing;
+  FlValue* threads_value =
+      args != nullptr ? fl_value_lookup_string(args, "maxThreads") : nullptr;
+  if (threads_value != nullptr &&
+      fl_value_get_type(threads_value) == FL_VALUE_TYPE_INT &&
+      fl_value_get_int(threads_value) > 0) {
+    self->worker_threads = fl_value_get_int(threads_value);
+    if (self->worker_pool != nullptr) {
+      g_thread_pool_set_max_threads(self->worker_pool, self->worker_threads,
+                                    nullptr);
     }
   }
 
-  g_mkdir_with_parents(dir_path.c_str(), 0700);
+  FlValue* queue_value =
+      args != nullptr ? fl_value_lookup_string(args, "maxQueuedCalls")
+                      : nullptr;
+  if (queue_value != nullptr &&
+      fl_value_get_type(queue_value) == FL_VALUE_TYPE_INT &&
+      fl_value_get_int(queue_value) > 0) {
+    self->max_queued_calls = fl_value_get_int(queue_value);
+  }
 
-  gchar* uuid_c = g_uuid_string_random();
-  std::string new_id = uuid_c != nullptr ? std::string(uuid_c) : std::string();
-  g_free(uuid_c);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
 
-  if (!new_id.empty()) {
-    std::ofstream out(file_path, std::ios::trunc);
-    if (out.good()) {
-      out << new_id;
+// The metric groups configureSampler accepts, by name.
+static const struct {
+  const char* name;
+  unsigned metric;
+} kSamplerMetrics[] = {
+    {"sysinfo", kMetricSysinfo},
+    {"meminfo", kMetricMeminfo},
+    {"loadavg", kMetricLoadavg},
+    {"cpuTimes", kMetricCpuTimes},
+};
+
+FlMethodResponse* configure_sampler(PlatformVersionPlugin* self,
+                                    FlValue* args) {
+  if (args != nullptr && fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENTS", "Expected a map", nullptr));
+  }
+
+  unsigned metrics = kAllMetrics;
+  FlValue* metrics_value =
+      args != nullptr ? fl_value_lookup_string(args, "metrics") : nullptr;
+  if (metrics_value != nullptr &&
+      fl_value_get_type(metrics_value) == FL_VALUE_TYPE_LIST) {
+    metrics = 0;
+    for (size_t i = 0; i < fl_value_get_length(metrics_value); i++) {
+      FlValue* name = fl_value_get_list_value(metrics_value, i);
+      unsigned metric = 0;
+      if (fl_value_get_type(name) == FL_VALUE_TYPE_STRING) {
+        for (const auto& entry : kSamplerMetrics) {
+          if (strcmp(entry.name, fl_value_get_string(name)) == 0) {
+            metric = entry.metric;
+          }
+        }
+      }
+      if (metric == 0) {
+        return FL_METHOD_RESPONSE(fl_method_error_response_new(
+            "INVALID_ARGUMENTS", "Unknown metric", name));
+      }
+      metrics |= metric;
     }
   }
 
-  return new_id;
+  FlValue* enabled_value =
+      args != nullptr ? fl_value_lookup_string(args, "enabled") : nullptr;
+  if (enabled_value != nullptr &&
+      fl_value_get_type(enabled_value) == FL_VALUE_TYPE_BOOL &&
+      !fl_value_get_bool(enabled_value)) {
+    metrics = 0;
+  }
+
+  guint interval_ms = kDefaultStreamIntervalMs;
+  FlValue* interval_value =
+      args != nullptr ? fl_value_lookup_string(args, "intervalMs") : nullptr;
+  if (interval_value != nullptr &&
+      fl_value_get_type(interval_value) == FL_VALUE_TYPE_INT) {
+    interval_ms = MAX(fl_value_get_int(interval_value), kMinStreamIntervalMs);
+  }
+
+  // Disabling keeps the thread, idle, so readers never see it freed.
+  g_mutex_lock(&self->sampler_mutex);
+  if (self->metrics_sampler != nullptr) {
+    metrics_sampler_configure(self->metrics_sampler, metrics, interval_ms);
+  } else if (metrics != 0) {
+    MetricsSampler* sampler = metrics_sampler_start(
+        sysroot_path(self->sysroot, "/proc").path, metrics, interval_ms);
+    g_atomic_pointer_set(&self->metrics_sampler, sampler);
+    platform_version_ffi_publish_sampler(sampler);
+  }
+  g_mutex_unlock(&self->sampler_mutex);
+
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// Copies the background sampler's latest sample into [sample]. Returns the
+// groups it holds, or zero if the sampler is off.
+static unsigned read_sampled_metrics(PlatformVersionPlugin* self,
+                                     MetricsSample* sample) {
+  MetricsSampler* sampler = static_cast<MetricsSampler*>(
+      g_atomic_pointer_get(&self->metrics_sampler));
+  if (sampler == nullptr || !metrics_sampler_read(sampler, sample)) return 0;
+  return sample->metrics;
 }
 
 // Called when a method call is received from Flutter.
 static void platform_version_plugin_handle_method_call(
     PlatformVersionPlugin* self,
     FlMethodCall* method_call) {
-  g_autoptr(FlMethodResponse) response = nullptr;
-
   const gchar* method = fl_method_call_get_name(method_call);
 
-  if (strcmp(method, "getPlatformVersion") == 0) {
-    response = get_platform_version();
-  } else if (strcmp(method, "getDeviceInfo") == 0) {
-    response = get_device_info();
-  } else {
-    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  if (strcmp(method, "configureDispatch") == 0) {
+    g_autoptr(FlMethodResponse) response =
+        configure_dispatch(self, fl_method_call_get_args(method_call));
+    fl_method_call_respond(method_call, response, nullptr);
+    return;
+  }
+
+  if (self->async_dispatch &&
+      platform_version_plugin_dispatch_async(self, method_call)) {
+    return;
   }
 
+  g_autoptr(FlMethodResponse) response =
+      platform_version_plugin_build_response(self, method_call);
   fl_method_call_respond(method_call, response, nullptr);
 }
 
@@ -82,95 +399,1287 @@ FlMethodResponse* get_platform_version() {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
-FlMethodResponse* get_device_info() {
-  g_autoptr(FlValue) device_info = fl_value_new_map();
-  
-  // Get system information
-  struct utsname uname_data = {};
-  uname(&uname_data);
-  
-  struct sysinfo sys_info;
-  sysinfo(&sys_info);
-  
-  // Get hostname
-  char hostname[256];
-  gethostname(hostname, sizeof(hostname));
-  
-  // Add basic system info
-  fl_value_set_string_take(device_info, "stableDeviceId", fl_value_new_string(get_or_create_stable_device_id().c_str()));
-  fl_value_set_string_take(device_info, "systemName", fl_value_new_string(uname_data.sysname));
-  fl_value_set_string_take(device_info, "nodeName", fl_value_new_string(uname_data.nodename));
-  fl_value_set_string_take(device_info, "release", fl_value_new_string(uname_data.release));
-  fl_value_set_string_take(device_info, "version", fl_value_new_string(uname_data.version));
-  fl_value_set_string_take(device_info, "machine", fl_value_new_string(uname_data.machine));
-  fl_value_set_string_take(device_info, "hostname", fl_value_new_string(hostname));
-  
-  // Add memory information
-  fl_value_set_string_take(device_info, "totalRam", fl_value_new_int(sys_info.totalram));
-  fl_value_set_string_take(device_info, "freeRam", fl_value_new_int(sys_info.freeram));
-  fl_value_set_string_take(device_info, "sharedRam", fl_value_new_int(sys_info.sharedram));
-  fl_value_set_string_take(device_info, "bufferRam", fl_value_new_int(sys_info.bufferram));
-  fl_value_set_string_take(device_info, "totalSwap", fl_value_new_int(sys_info.totalswap));
-  fl_value_set_string_take(device_info, "freeSwap", fl_value_new_int(sys_info.freeswap));
-  fl_value_set_string_take(device_info, "processes", fl_value_new_int(sys_info.procs));
-  fl_value_set_string_take(device_info, "uptime", fl_value_new_int(sys_info.uptime));
-  
-  // Get number of processors
-  long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
-  fl_value_set_string_take(device_info, "numberOfProcessors", fl_value_new_int(num_processors));
-  
-  // Try to get CPU model from /proc/cpuinfo
-  std::ifstream cpuinfo("/proc/cpuinfo");
-  std::string line;
-  std::string cpu_model = "Unknown";
-  
-  while (std::getline(cpuinfo, line)) {
-    if (line.find("model name") != std::string::npos) {
-      size_t pos = line.find(":");
-      if (pos != std::string::npos) {
-        cpu_model = line.substr(pos + 2);
-        break;
-      }
+FlMethodResponse* get_stable_device_id() {
+  std::string id = stable_device_id_get();
+  g_autoptr(FlValue) result =
+      id.empty() ? fl_value_new_null() : fl_value_new_string(id.c_str());
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Runs [probes] with the plugin's snapshot, metrics and readers.
+static void run_device_info_probes(PlatformVersionPlugin* self,
+                                   guint probes,
+                                   DeviceInfoProbeResults* results) {
+  MetricsSampler* sampler = static_cast<MetricsSampler*>(
+      g_atomic_pointer_get(&self->metrics_sampler));
+  DeviceInfoProbeContext context = {self->snapshot, self->metrics->probes,
+                                    self->meminfo_reader, sampler,
+                                    self->sysroot};
+  device_info_run_probes(context, probes, results);
+}
+
+// Adds the keys produced by [probes] to [map].
+static void add_device_info_fields(FlValue* map,
+                                   const DeviceInfoProbeResults& results,
+                                   guint probes) {
+  DeviceInfo info;
+  device_info_collect(results, probes, &info);
+  fl_value_set_device_info(map, info);
+}
+
+static FlMethodResponse* device_info_response(
+    PlatformVersionPlugin* self,
+    FlValue* args,
+    DeviceInfoProbeResults* results) {
+  FlValue* keys =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+          ? fl_value_lookup_string(args, "keys")
+          : nullptr;
+  if (keys != nullptr && fl_value_get_type(keys) == FL_VALUE_TYPE_NULL) {
+    keys = nullptr;
+  }
+  if (keys != nullptr && fl_value_get_type(keys) != FL_VALUE_TYPE_LIST) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENTS", "Expected \"keys\" to be a list of strings",
+        nullptr));
+  }
+
+  // Work out which probes the requested keys need. Unknown keys are ignored.
+  guint probes = 0;
+  if (keys == nullptr) {
+    for (const DeviceInfoKey& key : kDeviceInfoKeys) probes |= key.probe;
+  } else {
+    for (size_t i = 0; i < fl_value_get_length(keys); i++) {
+      FlValue* name = fl_value_get_list_value(keys, i);
+      if (fl_value_get_type(name) != FL_VALUE_TYPE_STRING) continue;
+      const DeviceInfoKey* key = device_info_find_key(fl_value_get_string(name));
+      if (key != nullptr) probes |= key->probe;
     }
   }
-  fl_value_set_string_take(device_info, "cpuModel", fl_value_new_string(cpu_model.c_str()));
-  
-  // Try to get distribution info from /etc/os-release
-  std::ifstream os_release("/etc/os-release");
-  std::string distro_name = "Unknown";
-  std::string distro_version = "Unknown";
-  
-  while (std::getline(os_release, line)) {
-    if (line.find("NAME=") == 0) {
-      distro_name = line.substr(5);
-      // Remove quotes if present
-      if (distro_name.front() == '"' && distro_name.back() == '"') {
-        distro_name = distro_name.substr(1, distro_name.length() - 2);
-      }
-    } else if (line.find("VERSION=") == 0) {
-      distro_version = line.substr(8);
-      // Remove quotes if present
-      if (distro_version.front() == '"' && distro_version.back() == '"') {
-        distro_version = distro_version.substr(1, distro_version.length() - 2);
-      }
+
+  run_device_info_probes(self, probes, results);
+
+  DeviceInfo info;
+  if (keys == nullptr) {
+    device_info_collect(*results, probes, &info);
+  } else {
+    for (size_t i = 0; i < fl_value_get_length(keys); i++) {
+      FlValue* name = fl_value_get_list_value(keys, i);
+      if (fl_value_get_type(name) != FL_VALUE_TYPE_STRING) continue;
+      const DeviceInfoKey* key = device_info_find_key(fl_value_get_string(name));
+      if (key != nullptr) key->set(*results, &info);
     }
   }
-  
-  fl_value_set_string_take(device_info, "distributionName", fl_value_new_string(distro_name.c_str()));
-  fl_value_set_string_take(device_info, "distributionVersion", fl_value_new_string(distro_version.c_str()));
-  
+
+  g_autoptr(FlValue) device_info = device_info_to_fl_value(info);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(device_info));
 }
 
+FlMethodResponse* get_device_info(PlatformVersionPlugin* self, FlValue* args) {
+  DeviceInfoProbeResults results = {};
+  return device_info_response(self, args, &results);
+}
+
+// Layout of the getDeviceInfoRecord reply, version 1. All numbers are
+// little-endian.
+//
+//   0  u8   record version
+//   1  u8   number of int64 fields (I)
+//   2  u8   number of string fields (S)
+//   3  u8   reserved, zero
+//   4  u32  total record length in bytes
+//   8  i64  int fields[I]: totalRam, freeRam, sharedRam, bufferRam,
+//           totalSwap, freeSwap, processes, uptime, numberOfProcessors
+//   .. u32  string table[S] of (offset, length) pairs for stableDeviceId,
+//           systemName, nodeName, release, version, machine, hostname,
+//           cpuModel, distributionName, distributionVersion; offsets are
+//           from the start of the record
+//   .. u8   UTF-8 string bytes
+//
+// Fields are only ever appended, so decoders skip the ones they do not know
+// using the counts in the header.
+static const guint8 kDeviceInfoRecordVersion = 1;
+static const size_t kDeviceInfoRecordHeaderSize = 8;
+
+// The probes behind the record's fields. Spelled out rather than taken from
+// kDeviceInfoKeys so that keys added to getDeviceInfo do not slow the record
+// down with probes it does not encode.
+static const guint kDeviceInfoRecordProbes =
+    kProbeStableDeviceId | kProbeKernel | kProbeNodeName | kProbeSysinfo |
+    kProbeProcessors | kProbeCpuInfo | kProbeOsRelease;
+
+static void record_put_u32(std::vector<guint8>* record, size_t offset,
+                           guint32 value) {
+  for (int i = 0; i < 4; i++) {
+    (*record)[offset + i] = static_cast<guint8>(value >> (8 * i));
+  }
+}
+
+static void record_put_i64(std::vector<guint8>* record, size_t offset,
+                           gint64 value) {
+  guint64 bits = static_cast<guint64>(value);
+  for (int i = 0; i < 8; i++) {
+    (*record)[offset + i] = static_cast<guint8>(bits >> (8 * i));
+  }
+}
+
+static FlMethodResponse* device_info_record_response(
+    PlatformVersionPlugin* self,
+    DeviceInfoProbeResults* results) {
+  run_device_info_probes(self, kDeviceInfoRecordProbes, results);
+
+  const DeviceSnapshot* snapshot = results->snapshot;
+  const gint64 ints[] = {
+      static_cast<gint64>(results->sys_info.totalram),
+      static_cast<gint64>(results->sys_info.freeram),
+      static_cast<gint64>(results->sys_info.sharedram),
+      static_cast<gint64>(results->sys_info.bufferram),
+      static_cast<gint64>(results->sys_info.totalswap),
+      static_cast<gint64>(results->sys_info.freeswap),
+      static_cast<gint64>(results->sys_info.procs),
+      static_cast<gint64>(results->sys_info.uptime),
+      static_cast<gint64>(snapshot->number_of_processors),
+  };
+  const char* const strings[] = {
+      snapshot->stable_device_id.c_str(),
+      snapshot->system_name.c_str(),
+      results->uname_data.nodename,
+      snapshot->release.c_str(),
+      snapshot->version.c_str(),
+      snapshot->machine.c_str(),
+      results->uname_data.nodename,
+      snapshot->cpu_model.c_str(),
+      snapshot->distribution_name.c_str(),
+      snapshot->distribution_version.c_str(),
+  };
+
+  const size_t int_count = G_N_ELEMENTS(ints);
+  const size_t string_count = G_N_ELEMENTS(strings);
+  const size_t ints_offset = kDeviceInfoRecordHeaderSize;
+  const size_t table_offset = ints_offset + int_count * 8;
+  const size_t strings_offset = table_offset + string_count * 8;
+
+  std::vector<guint8> record(strings_offset);
+  record.reserve(strings_offset + 512);
+  record[0] = kDeviceInfoRecordVersion;
+  record[1] = static_cast<guint8>(int_count);
+  record[2] = static_cast<guint8>(string_count);
+  record[3] = 0;
+
+  for (size_t i = 0; i < int_count; i++) {
+    record_put_i64(&record, ints_offset + i * 8, ints[i]);
+  }
+
+  for (size_t i = 0; i < string_count; i++) {
+    size_t length = strlen(strings[i]);
+    size_t offset = record.size();
+    record.insert(record.end(), strings[i], strings[i] + length);
+    record_put_u32(&record, table_offset + i * 8, offset);
+    record_put_u32(&record, table_offset + i * 8 + 4, length);
+  }
+  record_put_u32(&record, 4, record.size());
+
+  g_autoptr(FlValue) result =
+      fl_value_new_uint8_list(record.data(), record.size());
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+FlMethodResponse* get_device_info_record(PlatformVersionPlugin* self) {
+  DeviceInfoProbeResults results = {};
+  return device_info_record_response(self, &results);
+}
+
+static FlMethodResponse* memory_info_response(
+    PlatformVersionPlugin* self,
+    DeviceInfoProbeResults* results) {
+  run_device_info_probes(self, kProbeMeminfo, results);
+  // MemTotal is always present, so zero means the read failed.
+  if (results->meminfo.mem_total == 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "UNAVAILABLE", "Failed to read /proc/meminfo", nullptr));
+  }
+
+  g_autoptr(FlValue) memory_info = fl_value_new_map();
+  add_device_info_fields(memory_info, *results, kProbeMeminfo);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(memory_info));
+}
+
+FlMethodResponse* get_memory_info(PlatformVersionPlugin* self) {
+  DeviceInfoProbeResults results = {};
+  return memory_info_response(self, &results);
+}
+
+static FlMethodResponse* cgroup_limits_response(
+    PlatformVersionPlugin* self,
+    DeviceInfoProbeResults* results) {
+  run_device_info_probes(self, kProbeCgroup, results);
+  const CgroupPaths& paths = results->snapshot->cgroup;
+  const CgroupLimits& limits = results->cgroup_limits;
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(
+      result, "cgroupVersion",
+      fl_value_new_int(MAX(paths.cpu.version, paths.memory.version)));
+  if (limits.cpu_quota_us > 0) {
+    fl_value_set_string_take(result, "cpuQuotaUs",
+                             fl_value_new_int(limits.cpu_quota_us));
+    fl_value_set_string_take(result, "cpuPeriodUs",
+                             fl_value_new_int(limits.cpu_period_us));
+    fl_value_set_string_take(
+        result, "cpuLimit",
+        fl_value_new_float(static_cast<double>(limits.cpu_quota_us) /
+                           limits.cpu_period_us));
+  } else {
+    fl_value_set_string_take(result, "cpuQuotaUs", fl_value_new_null());
+    fl_value_set_string_take(result, "cpuPeriodUs", fl_value_new_null());
+    fl_value_set_string_take(result, "cpuLimit", fl_value_new_null());
+  }
+  fl_value_set_string_take(result, "memoryLimit",
+                           limits.memory_limit > 0
+                               ? fl_value_new_int(limits.memory_limit)
+                               : fl_value_new_null());
+  if (paths.memory.version != 0) {
+    fl_value_set_string_take(result, "memoryUsage",
+                             fl_value_new_int(limits.memory_usage));
+
+    FlValue* events = fl_value_new_map();
+    if (paths.memory.version == 2) {
+      fl_value_set_string_take(events, "low",
+                               fl_value_new_int(limits.memory_events_low));
+      fl_value_set_string_take(events, "high",
+                               fl_value_new_int(limits.memory_events_high));
+      fl_value_set_string_take(events, "max",
+                               fl_value_new_int(limits.memory_events_max));
+      fl_value_set_string_take(events, "oom",
+                               fl_value_new_int(limits.memory_events_oom));
+    }
+    fl_value_set_string_take(events, "oomKill",
+                             fl_value_new_int(limits.memory_events_oom_kill));
+    fl_value_set_string_take(result, "memoryEvents", events);
+  } else {
+    fl_value_set_string_take(result, "memoryUsage", fl_value_new_null());
+    fl_value_set_string_take(result, "memoryEvents", fl_value_new_null());
+  }
+  fl_value_set_string_take(result, "effectiveProcessors",
+                           fl_value_new_int(results->effective_processors));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+FlMethodResponse* get_cgroup_limits(PlatformVersionPlugin* self) {
+  DeviceInfoProbeResults results = {};
+  return cgroup_limits_response(self, &results);
+}
+
+static FlValue* cpu_list_to_value(const std::vector<int>& cpus) {
+  FlValue* value = fl_value_new_list();
+  for (int cpu : cpus) {
+    fl_value_append_take(value, fl_value_new_int(cpu));
+  }
+  return value;
+}
+
+// Adds [cpus] to [map] as a "cpus" list, a kernel-style "cpuList" string
+// and a "count".
+static void add_cpu_set_fields(FlValue* map, const std::vector<int>& cpus) {
+  fl_value_set_string_take(map, "cpus", cpu_list_to_value(cpus));
+  fl_value_set_string_take(map, "cpuList",
+                           fl_value_new_string(cpulist_format(cpus).c_str()));
+  fl_value_set_string_take(map, "count", fl_value_new_int(cpus.size()));
+}
+
+// Builds the getCpuAffinity result for the allowed [cpus], splitting them by
+// NUMA node.
+static FlValue* cpu_affinity_to_value(PlatformVersionPlugin* self,
+                                      const std::vector<int>& cpus) {
+  DeviceInfoProbeResults results = {};
+  run_device_info_probes(self, kProbeNumaNodes, &results);
+
+  FlValue* value = fl_value_new_map();
+  add_cpu_set_fields(value, cpus);
+
+  FlValue* nodes = fl_value_new_list();
+  std::vector<int> allowed;
+  for (const NumaNode& node : results.snapshot->numa_nodes) {
+    allowed.clear();
+    std::set_intersection(node.cpus.begin(), node.cpus.end(), cpus.begin(),
+                          cpus.end(), std::back_inserter(allowed));
+    if (allowed.empty()) continue;
+    FlValue* entry = fl_value_new_map();
+    fl_value_set_string_take(entry, "node", fl_value_new_int(node.node));
+    add_cpu_set_fields(entry, allowed);
+    fl_value_append_take(nodes, entry);
+  }
+  fl_value_set_string_take(value, "numaNodes", nodes);
+  return value;
+}
+
+FlMethodResponse* get_cpu_affinity(PlatformVersionPlugin* self) {
+  std::vector<int> cpus;
+  if (!cpu_affinity_read(&cpus)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "UNAVAILABLE", "sched_getaffinity() failed", nullptr));
+  }
+  g_autoptr(FlValue) result = cpu_affinity_to_value(self, cpus);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+FlMethodResponse* get_cpu_features(PlatformVersionPlugin* self) {
+  DeviceInfoProbeResults results = {};
+  run_device_info_probes(self, kProbeKernel, &results);
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(
+      result, "architecture",
+      fl_value_new_string(results.snapshot->machine.c_str()));
+  fl_value_set_string_take(result, "mask",
+                           fl_value_new_int(self->cpu_features));
+  FlValue* names = fl_value_new_list();
+  for (int bit = 0; bit < 64; bit++) {
+    if ((self->cpu_features >> bit) & 1) {
+      fl_value_append_take(names, fl_value_new_string(cpu_feature_name(bit)));
+    }
+  }
+  fl_value_set_string_take(result, "features", names);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+FlMethodResponse* get_cpu_topology(PlatformVersionPlugin* self) {
+  DeviceInfoProbeResults results = {};
+  run_device_info_probes(self, kProbeCpuTopology, &results);
+  const CpuTopology& topology = results.snapshot->cpu_topology;
+  if (topology.cpus.empty()) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "UNAVAILABLE", "Failed to read /sys/devices/system/cpu", nullptr));
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "packages",
+                           fl_value_new_int(topology.packages));
+  fl_value_set_string_take(result, "cores", fl_value_new_int(topology.cores));
+  fl_value_set_string_take(result, "logicalProcessors",
+                           fl_value_new_int(topology.cpus.size()));
+  fl_value_set_string_take(result, "threadsPerCore",
+                           fl_value_new_int(topology.threads_per_core));
+  fl_value_set_string_take(result, "hybrid",
+                           fl_value_new_bool(topology.hybrid));
+  fl_value_set_string_take(result, "performanceCores",
+                           fl_value_new_int(topology.performance_cores));
+  fl_value_set_string_take(result, "efficiencyCores",
+                           fl_value_new_int(topology.efficiency_cores));
+
+  std::vector<int> performance_cpus, efficiency_cpus;
+  for (const CpuTopologyCpu& cpu : topology.cpus) {
+    (cpu.performance ? performance_cpus : efficiency_cpus).push_back(cpu.cpu);
+  }
+  fl_value_set_string_take(
+      result, "performanceCpuList",
+      fl_value_new_string(cpulist_format(performance_cpus).c_str()));
+  fl_value_set_string_take(
+      result, "efficiencyCpuList",
+      fl_value_new_string(cpulist_format(efficiency_cpus).c_str()));
+
+  FlValue* caches = fl_value_new_list();
+  for (const CpuCache& cache : topology.caches) {
+    FlValue* entry = fl_value_new_map();
+    fl_value_set_string_take(entry, "level", fl_value_new_int(cache.level));
+    fl_value_set_string_take(entry, "type",
+                             fl_value_new_string(cache.type.c_str()));
+    fl_value_set_string_take(entry, "sizeBytes",
+                             fl_value_new_int(cache.size_bytes));
+    fl_value_set_string_take(entry, "lineSize",
+                             fl_value_new_int(cache.line_size));
+    fl_value_set_string_take(entry, "ways", fl_value_new_int(cache.ways));
+    fl_value_set_string_take(entry, "sharedCpus",
+                             fl_value_new_int(cache.shared_cpus));
+    fl_value_set_string_take(entry, "instances",
+                             fl_value_new_int(cache.instances));
+    fl_value_append_take(caches, entry);
+  }
+  fl_value_set_string_take(result, "caches", caches);
+
+  FlValue* nodes = fl_value_new_list();
+  for (const NumaNode& node : topology.numa_nodes) {
+    FlValue* entry = fl_value_new_map();
+    fl_value_set_string_take(entry, "node", fl_value_new_int(node.node));
+    add_cpu_set_fields(entry, node.cpus);
+    fl_value_append_take(nodes, entry);
+  }
+  fl_value_set_string_take(result, "numaNodes", nodes);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* platform_version_plugin_build_response(
+    PlatformVersionPlugin* self,
+    FlMethodCall* method_call) {
+  DeviceInfoProbeResults results = {};
+  return platform_version_plugin_respond(
+      self, fl_method_call_get_name(method_call),
+      fl_method_call_get_args(method_call), &results);
+}
+
+// Most calls one batch may hold.
+static const size_t kMaxBatchCalls = 64;
+
+// Wraps the response to one call of a batch: {"result": value},
+// {"error": {"code", "message", "details"}} or {"notImplemented": true}.
+static FlValue* batch_reply_value(FlMethodResponse* response) {
+  FlValue* reply = fl_value_new_map();
+  if (FL_IS_METHOD_SUCCESS_RESPONSE(response)) {
+    FlValue* result = fl_method_success_response_get_result(
+        FL_METHOD_SUCCESS_RESPONSE(response));
+    fl_value_set_string(reply, "result", result);
+  } else if (FL_IS_METHOD_ERROR_RESPONSE(response)) {
+    FlMethodErrorResponse* error = FL_METHOD_ERROR_RESPONSE(response);
+    const gchar* message = fl_method_error_response_get_message(error);
+    FlValue* details = fl_method_error_response_get_details(error);
+    FlValue* value = fl_value_new_map();
+    fl_value_set_string_take(
+        value, "code",
+        fl_value_new_string(fl_method_error_response_get_code(error)));
+    fl_value_set_string_take(value, "message",
+                             message != nullptr ? fl_value_new_string(message)
+                                                : fl_value_new_null());
+    fl_value_set_string_take(value, "details", details != nullptr
+                                                   ? fl_value_ref(details)
+                                                   : fl_value_new_null());
+    fl_value_set_string_take(reply, "error", value);
+  } else {
+    fl_value_set_string_take(reply, "notImplemented", fl_value_new_bool(TRUE));
+  }
+  return reply;
+}
+
+FlMethodResponse* batch(PlatformVersionPlugin* self, FlValue* args) {
+  FlValue* calls =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+          ? fl_value_lookup_string(args, "calls")
+          : nullptr;
+  if (calls == nullptr || fl_value_get_type(calls) != FL_VALUE_TYPE_LIST) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENTS", "Expected \"calls\" to be a list", nullptr));
+  }
+  if (fl_value_get_length(calls) > kMaxBatchCalls) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENTS", "Too many calls in one batch", nullptr));
+  }
+
+  // One set of probe results for the whole batch, so calls that need the
+  // same probes share a single read.
+  DeviceInfoProbeResults results = {};
+  g_autoptr(FlValue) replies = fl_value_new_list();
+  for (size_t i = 0; i < fl_value_get_length(calls); i++) {
+    FlValue* call = fl_value_get_list_value(calls, i);
+    FlValue* method =
+        fl_value_get_type(call) == FL_VALUE_TYPE_MAP
+            ? fl_value_lookup_string(call, "method")
+            : nullptr;
+    g_autoptr(FlMethodResponse) response = nullptr;
+    if (method == nullptr || fl_value_get_type(method) != FL_VALUE_TYPE_STRING) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGUMENTS", "Expected a map with a \"method\" string",
+          nullptr));
+    } else if (strcmp(fl_value_get_string(method), "batch") == 0) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGUMENTS", "Batches cannot be nested", nullptr));
+    } else {
+      response = platform_version_plugin_respond(
+          self, fl_value_get_string(method),
+          fl_value_lookup_string(call, "arguments"), &results);
+    }
+    fl_value_append_take(replies, batch_reply_value(response));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(replies));
+}
+
+// Routes [method] to its handler. See platform_version_plugin_respond().
+static FlMethodResponse* platform_version_plugin_route(
+    PlatformVersionPlugin* self,
+    const gchar* method,
+    FlValue* args,
+    DeviceInfoProbeResults* results) {
+  if (strcmp(method, "getPlatformVersion") == 0) {
+    return get_platform_version();
+  } else if (strcmp(method, "getDeviceInfo") == 0) {
+    return device_info_response(self, args, results);
+  } else if (strcmp(method, "getDeviceInfoRecord") == 0) {
+    return device_info_record_response(self, results);
+  } else if (strcmp(method, "getMemoryInfo") == 0) {
+    return memory_info_response(self, results);
+  } else if (strcmp(method, "getCgroupLimits") == 0) {
+    return cgroup_limits_response(self, results);
+  } else if (strcmp(method, "getCpuAffinity") == 0) {
+    return get_cpu_affinity(self);
+  } else if (strcmp(method, "getCpuFeatures") == 0) {
+    return get_cpu_features(self);
+  } else if (strcmp(method, "getCpuTopology") == 0) {
+    return get_cpu_topology(self);
+  } else if (strcmp(method, "getCpuUsage") == 0) {
+    return get_cpu_usage(self);
+  } else if (strcmp(method, "getProcessInfo") == 0) {
+    return get_process_info(self, args);
+  } else if (strcmp(method, "getThreadCpuUsage") == 0) {
+    return get_thread_cpu_usage(self);
+  } else if (strcmp(method, "getStableDeviceId") == 0) {
+    return get_stable_device_id();
+  } else if (strcmp(method, "getSampledMetrics") == 0) {
+    return get_sampled_metrics(self);
+  } else if (strcmp(method, "configureSampler") == 0) {
+    return configure_sampler(self, args);
+  } else if (strcmp(method, "getPluginMetrics") == 0) {
+    return get_plugin_metrics(self, args);
+  } else if (strcmp(method, "configureTracing") == 0) {
+    return configure_tracing(args);
+  } else if (strcmp(method, "dumpTrace") == 0) {
+    return dump_trace(args);
+  } else if (strcmp(method, "batch") == 0) {
+    return batch(self, args);
+  }
+  return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+}
+
+// Adds the sysinfo() memory, swap, process, uptime and load-average fields
+// to [map].
+static void add_telemetry_fields(FlValue* map, const struct sysinfo& sys_info) {
+  DeviceInfoProbeResults results = {};
+  results.sys_info = sys_info;
+  add_device_info_fields(map, results, kProbeSysinfo);
+
+  // sysinfo() reports load averages as fixed-point numbers.
+  const double load_scale = static_cast<double>(1 << SI_LOAD_SHIFT);
+  fl_value_set_string_take(map, "load1", fl_value_new_float(sys_info.loads[0] / load_scale));
+  fl_value_set_string_take(map, "load5", fl_value_new_float(sys_info.loads[1] / load_scale));
+  fl_value_set_string_take(map, "load15", fl_value_new_float(sys_info.loads[2] / load_scale));
+}
+
+// Builds the response to [method] called with [args], sharing dynamic probe
+// results through [results], and records its latency.
+static FlMethodResponse* platform_version_plugin_respond(
+    PlatformVersionPlugin* self,
+    const gchar* method,
+    FlValue* args,
+    DeviceInfoProbeResults* results) {
+  size_t index = G_N_ELEMENTS(kInstrumentedMethods) - 1;
+  for (size_t i = 0; i + 1 < G_N_ELEMENTS(kInstrumentedMethods); i++) {
+    if (strcmp(kInstrumentedMethods[i], method) == 0) {
+      index = i;
+      break;
+    }
+  }
+
+  TraceScope trace("method", kInstrumentedMethods[index]);
+  uint64_t start_ns = latency_now_ns();
+  FlMethodResponse* response =
+      platform_version_plugin_route(self, method, args, results);
+  latency_histogram_record(&self->metrics->methods[index],
+                           latency_now_ns() - start_ns,
+                           FL_IS_METHOD_ERROR_RESPONSE(response));
+  return response;
+}
+
+FlValue* sample_telemetry() {
+  struct sysinfo sys_info = {};
+  if (sysinfo(&sys_info) != 0) return nullptr;
+
+  FlValue* sample = fl_value_new_map();
+  add_telemetry_fields(sample, sys_info);
+  return sample;
+}
+
+FlMethodResponse* get_sampled_metrics(PlatformVersionPlugin* self) {
+  MetricsSample sample;
+  unsigned sampled = read_sampled_metrics(self, &sample);
+  if (sampled == 0) {
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  FlValue* names = fl_value_new_list();
+  for (const auto& entry : kSamplerMetrics) {
+    if (sampled & entry.metric) {
+      fl_value_append_take(names, fl_value_new_string(entry.name));
+    }
+  }
+  fl_value_set_string_take(result, "metrics", names);
+  fl_value_set_string_take(result, "refreshes",
+                           fl_value_new_int(sample.refreshes));
+  // g_get_monotonic_time() reads CLOCK_MONOTONIC too, in microseconds.
+  fl_value_set_string_take(
+      result, "ageUs",
+      fl_value_new_int(g_get_monotonic_time() -
+                       static_cast<gint64>(sample.timestamp_ns / 1000)));
+
+  if (sampled & kMetricSysinfo) add_telemetry_fields(result, sample.sys_info);
+
+  if (sampled & kMetricMeminfo) {
+    DeviceInfoProbeResults results = {};
+    results.meminfo = sample.meminfo;
+    add_device_info_fields(result, results, kProbeMeminfo);
+  }
+
+  if (sampled & kMetricLoadavg) {
+    const LoadAvg& loadavg = sample.loadavg;
+    fl_value_set_string_take(result, "load1", fl_value_new_float(loadavg.load1));
+    fl_value_set_string_take(result, "load5", fl_value_new_float(loadavg.load5));
+    fl_value_set_string_take(result, "load15", fl_value_new_float(loadavg.load15));
+    fl_value_set_string_take(result, "runnableTasks",
+                             fl_value_new_int(loadavg.running));
+    fl_value_set_string_take(result, "totalTasks",
+                             fl_value_new_int(loadavg.total));
+  }
+
+  if (sampled & kMetricCpuTimes) {
+    const CpuTimes& times = sample.cpu_times;
+    FlValue* jiffies = fl_value_new_map();
+    fl_value_set_string_take(jiffies, "user", fl_value_new_int(times.user));
+    fl_value_set_string_take(jiffies, "nice", fl_value_new_int(times.nice));
+    fl_value_set_string_take(jiffies, "system", fl_value_new_int(times.system));
+    fl_value_set_string_take(jiffies, "idle", fl_value_new_int(times.idle));
+    fl_value_set_string_take(jiffies, "iowait", fl_value_new_int(times.iowait));
+    fl_value_set_string_take(jiffies, "irq", fl_value_new_int(times.irq));
+    fl_value_set_string_take(jiffies, "softirq", fl_value_new_int(times.softirq));
+    fl_value_set_string_take(jiffies, "steal", fl_value_new_int(times.steal));
+    fl_value_set_string_take(result, "cpuTimes", jiffies);
+  }
+
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlValue* cpu_usage_to_value(const CpuUsage& usage) {
+  FlValue* value = fl_value_new_map();
+  if (usage.cpu >= 0) {
+    fl_value_set_string_take(value, "cpu", fl_value_new_int(usage.cpu));
+  }
+  fl_value_set_string_take(value, "user", fl_value_new_float(usage.user));
+  fl_value_set_string_take(value, "system", fl_value_new_float(usage.system));
+  fl_value_set_string_take(value, "iowait", fl_value_new_float(usage.iowait));
+  fl_value_set_string_take(value, "steal", fl_value_new_float(usage.steal));
+  fl_value_set_string_take(value, "idle", fl_value_new_float(usage.idle));
+  return value;
+}
+
+// Samples [sampler] from /proc/stat under [sysroot] and returns
+// {"total": {...}, "cpus": [{...}, ...]}, or nullptr if it cannot be read.
+static FlValue* sample_cpu_usage(CpuUsageSampler* sampler,
+                                 const char* sysroot) {
+  std::vector<CpuUsage> usage;
+  if (!cpu_usage_sampler_sample(sampler,
+                                sysroot_path(sysroot, "/proc/stat").path,
+                                &usage)) {
+    return nullptr;
+  }
+
+  FlValue* result = fl_value_new_map();
+  FlValue* cpus = fl_value_new_list();
+  for (const CpuUsage& cpu_usage : usage) {
+    if (cpu_usage.cpu < 0) {
+      fl_value_set_string_take(result, "total", cpu_usage_to_value(cpu_usage));
+    } else {
+      fl_value_append_take(cpus, cpu_usage_to_value(cpu_usage));
+    }
+  }
+  fl_value_set_string_take(result, "cpus", cpus);
+  return result;
+}
+
+FlMethodResponse* get_cpu_usage(PlatformVersionPlugin* self) {
+  g_mutex_lock(&self->cpu_usage_mutex);
+  if (self->cpu_usage_sampler == nullptr) {
+    self->cpu_usage_sampler = new CpuUsageSampler();
+  }
+  g_autoptr(FlValue) result = sample_cpu_usage(self->cpu_usage_sampler, self->sysroot);
+  g_mutex_unlock(&self->cpu_usage_mutex);
+
+  if (result == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "UNAVAILABLE", "Failed to read /proc/stat", nullptr));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Returns whether [args] is a map whose "pss" entry is true.
+static gboolean process_info_wants_pss(FlValue* args) {
+  FlValue* pss = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                     ? fl_value_lookup_string(args, "pss")
+                     : nullptr;
+  return pss != nullptr && fl_value_get_type(pss) == FL_VALUE_TYPE_BOOL &&
+         fl_value_get_bool(pss);
+}
+
+// Takes one sample with [reader] and returns its fields, plus a "deltas" map
+// against [*previous] when there is one, then makes the sample the new
+// [*previous]. Returns nullptr if /proc/self cannot be read.
+static FlValue* sample_process_info(const ProcessStatsReader* reader,
+                                    gboolean pss,
+                                    ProcessStats** previous) {
+  ProcessStats stats;
+  if (!process_stats_reader_read(reader, pss, &stats)) return nullptr;
+
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "rss", fl_value_new_int(stats.rss));
+  if (stats.has_pss) {
+    fl_value_set_string_take(result, "pss", fl_value_new_int(stats.pss));
+  }
+  fl_value_set_string_take(result, "rssAnon", fl_value_new_int(stats.rss_anon));
+  fl_value_set_string_take(result, "rssFile", fl_value_new_int(stats.rss_file));
+  fl_value_set_string_take(result, "rssShmem",
+                           fl_value_new_int(stats.rss_shmem));
+  fl_value_set_string_take(result, "vmSize", fl_value_new_int(stats.vm_size));
+  fl_value_set_string_take(result, "vmHwm", fl_value_new_int(stats.vm_hwm));
+  fl_value_set_string_take(result, "vmSwap", fl_value_new_int(stats.vm_swap));
+  fl_value_set_string_take(result, "threads", fl_value_new_int(stats.threads));
+  fl_value_set_string_take(result, "minorFaults",
+                           fl_value_new_int(stats.minor_faults));
+  fl_value_set_string_take(result, "majorFaults",
+                           fl_value_new_int(stats.major_faults));
+  fl_value_set_string_take(result, "voluntaryContextSwitches",
+                           fl_value_new_int(stats.voluntary_context_switches));
+  fl_value_set_string_take(
+      result, "involuntaryContextSwitches",
+      fl_value_new_int(stats.involuntary_context_switches));
+  fl_value_set_string_take(result, "userTimeMs",
+                           fl_value_new_int(stats.user_time_ms));
+  fl_value_set_string_take(result, "systemTimeMs",
+                           fl_value_new_int(stats.system_time_ms));
+  if (stats.has_io) {
+    fl_value_set_string_take(result, "readBytes",
+                             fl_value_new_int(stats.read_bytes));
+    fl_value_set_string_take(result, "writeBytes",
+                             fl_value_new_int(stats.write_bytes));
+    fl_value_set_string_take(result, "readChars",
+                             fl_value_new_int(stats.read_chars));
+    fl_value_set_string_take(result, "writeChars",
+                             fl_value_new_int(stats.write_chars));
+  }
+
+  if (*previous != nullptr) {
+    ProcessStatsDelta delta = process_stats_between(**previous, stats);
+    FlValue* deltas = fl_value_new_map();
+    fl_value_set_string_take(deltas, "intervalMs",
+                             fl_value_new_float(delta.interval_ms));
+    fl_value_set_string_take(deltas, "rss", fl_value_new_int(delta.rss));
+    if (stats.has_pss && (*previous)->has_pss) {
+      fl_value_set_string_take(deltas, "pss", fl_value_new_int(delta.pss));
+    }
+    fl_value_set_string_take(deltas, "minorFaults",
+                             fl_value_new_int(delta.minor_faults));
+    fl_value_set_string_take(deltas, "majorFaults",
+                             fl_value_new_int(delta.major_faults));
+    fl_value_set_string_take(
+        deltas, "voluntaryContextSwitches",
+        fl_value_new_int(delta.voluntary_context_switches));
+    fl_value_set_string_take(
+        deltas, "involuntaryContextSwitches",
+        fl_value_new_int(delta.involuntary_context_switches));
+    fl_value_set_string_take(deltas, "userTimeMs",
+                             fl_value_new_int(delta.user_time_ms));
+    fl_value_set_string_take(deltas, "systemTimeMs",
+                             fl_value_new_int(delta.system_time_ms));
+    if (stats.has_io && (*previous)->has_io) {
+      fl_value_set_string_take(deltas, "readBytes",
+                               fl_value_new_int(delta.read_bytes));
+      fl_value_set_string_take(deltas, "writeBytes",
+                               fl_value_new_int(delta.write_bytes));
+    }
+    fl_value_set_string_take(result, "deltas", deltas);
+  } else {
+    *previous = new ProcessStats();
+  }
+  **previous = stats;
+  return result;
+}
+
+FlMethodResponse* get_process_info(PlatformVersionPlugin* self,
+                                   FlValue* args) {
+  g_mutex_lock(&self->process_info_mutex);
+  g_autoptr(FlValue) result =
+      sample_process_info(&self->process_stats_reader,
+                          process_info_wants_pss(args),
+                          &self->process_info_previous);
+  g_mutex_unlock(&self->process_info_mutex);
+
+  if (result == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "UNAVAILABLE", "Failed to read /proc/self", nullptr));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlValue* thread_cpu_usage_to_value(const ThreadCpuUsage& usage) {
+  const ThreadStats& stats = usage.stats;
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "tid", fl_value_new_int(stats.tid));
+  fl_value_set_string_take(value, "name", fl_value_new_string(stats.name));
+  const gchar state[] = {stats.state, '\0'};
+  fl_value_set_string_take(value, "state", fl_value_new_string(state));
+  fl_value_set_string_take(value, "lastCpu", fl_value_new_int(stats.last_cpu));
+  fl_value_set_string_take(value, "userTimeMs",
+                           fl_value_new_int(stats.user_time_ms));
+  fl_value_set_string_take(value, "systemTimeMs",
+                           fl_value_new_int(stats.system_time_ms));
+
+  FlValue* deltas = fl_value_new_map();
+  fl_value_set_string_take(deltas, "userTimeMs",
+                           fl_value_new_int(usage.user_time_ms));
+  fl_value_set_string_take(deltas, "systemTimeMs",
+                           fl_value_new_int(usage.system_time_ms));
+  fl_value_set_string_take(deltas, "cpuPercent",
+                           fl_value_new_float(usage.cpu_percent));
+  fl_value_set_string_take(value, "deltas", deltas);
+  return value;
+}
+
+FlMethodResponse* get_thread_cpu_usage(PlatformVersionPlugin* self) {
+  g_mutex_lock(&self->thread_stats_mutex);
+  if (self->thread_stats_sampler == nullptr) {
+    self->thread_stats_sampler = new ThreadStatsSampler();
+    thread_stats_sampler_open(
+        self->thread_stats_sampler,
+        sysroot_path(self->sysroot, "/proc/self/task").path);
+  }
+  std::vector<ThreadCpuUsage> usage;
+  double interval_ms = 0;
+  bool sampled = thread_stats_sampler_sample(self->thread_stats_sampler,
+                                             &usage, &interval_ms);
+  if (!sampled) {
+    // Try to open the directory again on the next call.
+    thread_stats_sampler_close(self->thread_stats_sampler);
+    delete self->thread_stats_sampler;
+    self->thread_stats_sampler = nullptr;
+  }
+  g_mutex_unlock(&self->thread_stats_mutex);
+
+  if (!sampled) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "UNAVAILABLE", "Failed to read /proc/self/task", nullptr));
+  }
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "intervalMs",
+                           fl_value_new_float(interval_ms));
+  FlValue* threads = fl_value_new_list();
+  for (const ThreadCpuUsage& thread_usage : usage) {
+    fl_value_append_take(threads, thread_cpu_usage_to_value(thread_usage));
+  }
+  fl_value_set_string_take(result, "threads", threads);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// A sample taken on a stream's [sample_pool].
+typedef struct {
+  PeriodicStream* stream;
+  // Keeps the plugin, and so the stream, alive until the job is freed on
+  // the main loop.
+  PlatformVersionPlugin* self;
+  guint generation;
+  // Whether to call the stream's reset with [args] before sampling.
+  gboolean reset;
+  FlValue* args;
+  FlValue* sample;
+} PeriodicStreamJob;
+
+static void periodic_stream_job_free(PeriodicStreamJob* job) {
+  g_clear_pointer(&job->args, fl_value_unref);
+  g_clear_pointer(&job->sample, fl_value_unref);
+  g_object_unref(job->self);
+  g_free(job);
+}
+
+// Sends a sample taken on the pool. Always runs on the main context.
+static gboolean periodic_stream_job_send_cb(gpointer user_data) {
+  PeriodicStreamJob* job = static_cast<PeriodicStreamJob*>(user_data);
+  PeriodicStream* stream = job->stream;
+  stream->pending--;
+  if (job->sample != nullptr && job->generation == stream->generation) {
+    fl_event_channel_send(stream->channel, job->sample, nullptr, nullptr);
+  }
+  periodic_stream_job_free(job);
+  return G_SOURCE_REMOVE;
+}
+
+static void periodic_stream_job_run(gpointer data, gpointer user_data) {
+  PeriodicStreamJob* job = static_cast<PeriodicStreamJob*>(data);
+  PeriodicStream* stream = job->stream;
+  if (job->reset) {
+    stream->reset(job->self, job->args);
+  }
+  job->sample = stream->sample(job->self);
+  g_main_context_invoke(job->self->main_context, periodic_stream_job_send_cb,
+                        job);
+}
+
+// Queues a sample on [stream]'s pool, after a reset with [args] if [reset]
+// is set.
+static void periodic_stream_queue_sample(PeriodicStream* stream,
+                                         gboolean reset,
+                                         FlValue* args) {
+  PeriodicStreamJob* job = g_new0(PeriodicStreamJob, 1);
+  job->stream = stream;
+  job->self = PLATFORM_VERSION_PLUGIN(g_object_ref(stream->self));
+  job->generation = stream->generation;
+  job->reset = reset && stream->reset != nullptr;
+  job->args = args != nullptr ? fl_value_ref(args) : nullptr;
+  stream->pending++;
+  g_thread_pool_push(stream->sample_pool, job, nullptr);
+}
+
+static gboolean periodic_stream_tick_cb(gpointer user_data) {
+  PeriodicStream* stream = static_cast<PeriodicStream*>(user_data);
+  if (stream->sample_pool != nullptr) {
+    // A slow sample delays the next one instead of queueing up behind it.
+    if (stream->pending == 0) {
+      periodic_stream_queue_sample(stream, FALSE, nullptr);
+    }
+    return G_SOURCE_CONTINUE;
+  }
+
+  g_autoptr(FlValue) sample = stream->sample(stream->self);
+  if (sample != nullptr) {
+    fl_event_channel_send(stream->channel, sample, nullptr, nullptr);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+static void periodic_stream_stop(PeriodicStream* stream) {
+  g_clear_handle_id(&stream->source_id, g_source_remove);
+  stream->generation++;
+}
+
+// Starts sampling when Dart listens on the stream's channel. [args] may hold
+// the sampling interval as "intervalMs".
+static FlMethodErrorResponse* periodic_stream_listen_cb(FlEventChannel* channel,
+                                                        FlValue* args,
+                                                        gpointer user_data) {
+  PeriodicStream* stream = static_cast<PeriodicStream*>(user_data);
+
+  guint interval_ms = kDefaultStreamIntervalMs;
+  FlValue* interval_value =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+          ? fl_value_lookup_string(args, "intervalMs")
+          : nullptr;
+  if (interval_value != nullptr &&
+      fl_value_get_type(interval_value) == FL_VALUE_TYPE_INT) {
+    interval_ms = MAX(fl_value_get_int(interval_value),
+                      kMinStreamIntervalMs);
+  }
+
+  periodic_stream_stop(stream);
+  // Send the first sample right away rather than one interval late. On the
+  // pool the reset is queued behind any sample still running, which keeps
+  // it off the baseline that sample is using.
+  if (stream->sample_pool != nullptr) {
+    periodic_stream_queue_sample(stream, TRUE, args);
+  } else {
+    if (stream->reset != nullptr) {
+      stream->reset(stream->self, args);
+    }
+    periodic_stream_tick_cb(stream);
+  }
+  stream->source_id = g_timeout_add(interval_ms, periodic_stream_tick_cb, stream);
+  return nullptr;
+}
+
+static FlMethodErrorResponse* periodic_stream_cancel_cb(FlEventChannel* channel,
+                                                        FlValue* args,
+                                                        gpointer user_data) {
+  periodic_stream_stop(static_cast<PeriodicStream*>(user_data));
+  return nullptr;
+}
+
+static void periodic_stream_start_handling(
+    PeriodicStream* stream,
+    PlatformVersionPlugin* self,
+    FlBinaryMessenger* messenger,
+    FlMethodCodec* codec,
+    const gchar* name,
+    FlValue* (*sample)(PlatformVersionPlugin* self),
+    void (*reset)(PlatformVersionPlugin* self, FlValue* args)) {
+  stream->self = self;
+  stream->sample = sample;
+  stream->reset = reset;
+  stream->channel = fl_event_channel_new(messenger, name, codec);
+  fl_event_channel_set_stream_handlers(stream->channel,
+                                       periodic_stream_listen_cb,
+                                       periodic_stream_cancel_cb, stream,
+                                       nullptr);
+}
+
+// Moves [stream]'s resets and samples onto a thread of their own.
+static void periodic_stream_sample_off_main_thread(PeriodicStream* stream) {
+  stream->sample_pool =
+      g_thread_pool_new(periodic_stream_job_run, nullptr, 1, FALSE, nullptr);
+}
+
+static void periodic_stream_dispose(PeriodicStream* stream) {
+  periodic_stream_stop(stream);
+  // Every queued job holds a reference to the plugin, so the pool is idle
+  // by the time we get here.
+  if (stream->sample_pool != nullptr) {
+    g_thread_pool_free(stream->sample_pool, FALSE, TRUE);
+    stream->sample_pool = nullptr;
+  }
+  g_clear_object(&stream->channel);
+}
+
+// Adds [histogram]'s summary to [map] under [name] if it has any calls.
+static void add_latency_stats(FlValue* map,
+                              const char* name,
+                              const LatencyHistogram* histogram) {
+  LatencyStats stats;
+  latency_histogram_stats(histogram, &stats);
+  if (stats.count == 0) return;
+
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "count", fl_value_new_int(stats.count));
+  fl_value_set_string_take(value, "errors", fl_value_new_int(stats.errors));
+  const struct {
+    const char* key;
+    uint64_t ns;
+  } durations[] = {
+      {"meanUs", stats.mean_ns}, {"p50Us", stats.p50_ns},
+      {"p90Us", stats.p90_ns},   {"p99Us", stats.p99_ns},
+      {"maxUs", stats.max_ns},
+  };
+  for (const auto& duration : durations) {
+    fl_value_set_string_take(value, duration.key,
+                             fl_value_new_float(duration.ns / 1000.0));
+  }
+  fl_value_set_string_take(map, name, value);
+}
+
+FlMethodResponse* get_plugin_metrics(PlatformVersionPlugin* self,
+                                     FlValue* args) {
+  PluginMetrics* metrics = self->metrics;
+  uint64_t now_ns = latency_now_ns();
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(
+      result, "periodUs",
+      fl_value_new_int((now_ns - metrics->since_ns.load()) / 1000));
+  FlValue* methods = fl_value_new_map();
+  for (size_t i = 0; i < G_N_ELEMENTS(kInstrumentedMethods); i++) {
+    add_latency_stats(methods, kInstrumentedMethods[i], &metrics->methods[i]);
+  }
+  fl_value_set_string_take(result, "methods", methods);
+  FlValue* probes = fl_value_new_map();
+  for (size_t i = 0; i < kProbeCount; i++) {
+    add_latency_stats(probes, kProbeNames[i], &metrics->probes[i]);
+  }
+  fl_value_set_string_take(result, "probes", probes);
+
+  // Resetting after the read hands each caller a disjoint period.
+  FlValue* reset =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+          ? fl_value_lookup_string(args, "reset")
+          : nullptr;
+  if (reset != nullptr && fl_value_get_type(reset) == FL_VALUE_TYPE_BOOL &&
+      fl_value_get_bool(reset)) {
+    for (LatencyHistogram& histogram : metrics->methods) {
+      latency_histogram_reset(&histogram);
+    }
+    for (LatencyHistogram& histogram : metrics->probes) {
+      latency_histogram_reset(&histogram);
+    }
+    metrics->since_ns.store(now_ns);
+  }
+
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+FlMethodResponse* configure_tracing(FlValue* args) {
+  FlValue* enabled =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+          ? fl_value_lookup_string(args, "enabled")
+          : nullptr;
+  if (enabled == nullptr || fl_value_get_type(enabled) != FL_VALUE_TYPE_BOOL) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENTS", "Expected a map with a bool \"enabled\"",
+        nullptr));
+  }
+  trace_recorder_set_enabled(fl_value_get_bool(enabled));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+FlMethodResponse* dump_trace(FlValue* args) {
+  FlValue* path =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+          ? fl_value_lookup_string(args, "path")
+          : nullptr;
+  if (path == nullptr || fl_value_get_type(path) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENTS", "Expected a map with a string \"path\"",
+        nullptr));
+  }
+  FlValue* clear = fl_value_lookup_string(args, "clear");
+  long written = trace_recorder_dump(
+      fl_value_get_string(path),
+      clear == nullptr || fl_value_get_type(clear) != FL_VALUE_TYPE_BOOL ||
+          fl_value_get_bool(clear));
+  if (written < 0) {
+    g_autofree gchar* message = g_strdup_printf(
+        "Failed to write %s: %s", fl_value_get_string(path), g_strerror(errno));
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("IO_ERROR", message, nullptr));
+  }
+  g_autoptr(FlValue) result = fl_value_new_int(written);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlValue* telemetry_stream_sample(PlatformVersionPlugin* self) {
+  MetricsSample sample;
+  if (read_sampled_metrics(self, &sample) & kMetricSysinfo) {
+    FlValue* value = fl_value_new_map();
+    add_telemetry_fields(value, sample.sys_info);
+    return value;
+  }
+  return sample_telemetry();
+}
+
+static FlValue* cpu_usage_stream_sample(PlatformVersionPlugin* self) {
+  return sample_cpu_usage(self->cpu_usage_stream_sampler, self->sysroot);
+}
+
+// Each subscription starts from a fresh baseline, so its first event reports
+// usage since boot and later ones usage per interval.
+static void cpu_usage_stream_reset(PlatformVersionPlugin* self,
+                                   FlValue* args) {
+  delete self->cpu_usage_stream_sampler;
+  self->cpu_usage_stream_sampler = new CpuUsageSampler();
+}
+
+static FlValue* process_info_stream_sample(PlatformVersionPlugin* self) {
+  return sample_process_info(&self->process_stats_reader,
+                             self->process_info_stream_pss,
+                             &self->process_info_stream_previous);
+}
+
+// Each subscription starts from a fresh baseline, so its first event has no
+// deltas. [args] may hold "pss" to read smaps_rollup on every tick.
+static void process_info_stream_reset(PlatformVersionPlugin* self,
+                                      FlValue* args) {
+  self->process_info_stream_pss = process_info_wants_pss(args);
+  delete self->process_info_stream_previous;
+  self->process_info_stream_previous = nullptr;
+}
+
+static FlValue* affinity_stream_sample(PlatformVersionPlugin* self) {
+  std::vector<int> cpus;
+  if (!cpu_affinity_read(&cpus)) return nullptr;
+  if (self->affinity_stream_on_change && *self->affinity_stream_cpus == cpus) {
+    return nullptr;
+  }
+  *self->affinity_stream_cpus = cpus;
+  return cpu_affinity_to_value(self, cpus);
+}
+
+// [args] may hold "refreshOnChange"; when true, the default, the stream only
+// sends the first sample and changes to the mask.
+static void affinity_stream_reset(PlatformVersionPlugin* self, FlValue* args) {
+  FlValue* on_change =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+          ? fl_value_lookup_string(args, "refreshOnChange")
+          : nullptr;
+  self->affinity_stream_on_change =
+      on_change == nullptr || fl_value_get_type(on_change) != FL_VALUE_TYPE_BOOL ||
+      fl_value_get_bool(on_change);
+  if (self->affinity_stream_cpus == nullptr) {
+    self->affinity_stream_cpus = new std::vector<int>();
+  }
+  // An empty mask never matches a real one, so the first sample is sent.
+  self->affinity_stream_cpus->clear();
+}
+
 static void platform_version_plugin_dispose(GObject* object) {
+  PlatformVersionPlugin* self = PLATFORM_VERSION_PLUGIN(object);
+
+  // Every queued job holds a reference to the plugin, so the pool is idle by
+  // the time we get here; wait anyway for workers still returning.
+  if (self->worker_pool != nullptr) {
+    g_thread_pool_free(self->worker_pool, FALSE, TRUE);
+    self->worker_pool = nullptr;
+  }
+  g_clear_pointer(&self->main_context, g_main_context_unref);
+
+  periodic_stream_dispose(&self->telemetry_stream);
+  periodic_stream_dispose(&self->cpu_usage_stream);
+  periodic_stream_dispose(&self->process_info_stream);
+  periodic_stream_dispose(&self->affinity_stream);
+  g_clear_pointer(&self->pressure_monitor, pressure_monitor_free);
+  // No worker is left to read the sampler once the pool is gone, and the C
+  // ABI stops reading it once it is withdrawn.
+  if (self->metrics_sampler != nullptr) {
+    platform_version_ffi_withdraw_sampler(self->metrics_sampler);
+    g_clear_pointer(&self->metrics_sampler, metrics_sampler_stop);
+  }
+
+  delete self->cpu_usage_sampler;
+  self->cpu_usage_sampler = nullptr;
+  delete self->cpu_usage_stream_sampler;
+  self->cpu_usage_stream_sampler = nullptr;
+  delete self->process_info_previous;
+  self->process_info_previous = nullptr;
+  if (self->thread_stats_sampler != nullptr) {
+    thread_stats_sampler_close(self->thread_stats_sampler);
+    delete self->thread_stats_sampler;
+    self->thread_stats_sampler = nullptr;
+  }
+  delete self->process_info_stream_previous;
+  self->process_info_stream_previous = nullptr;
+  delete self->affinity_stream_cpus;
+  self->affinity_stream_cpus = nullptr;
+
   G_OBJECT_CLASS(platform_version_plugin_parent_class)->dispose(object);
 }
 
+static void platform_version_plugin_finalize(GObject* object) {
+  PlatformVersionPlugin* self = PLATFORM_VERSION_PLUGIN(object);
+
+  process_stats_reader_close(&self->process_stats_reader);
+  g_mutex_clear(&self->cpu_usage_mutex);
+  g_mutex_clear(&self->process_info_mutex);
+  g_mutex_clear(&self->thread_stats_mutex);
+  g_mutex_clear(&self->sampler_mutex);
+  delete self->metrics;
+
+  G_OBJECT_CLASS(platform_version_plugin_parent_class)->finalize(object);
+}
+
 static void platform_version_plugin_class_init(PlatformVersionPluginClass* klass) {
   G_OBJECT_CLASS(klass)->dispose = platform_version_plugin_dispose;
+  G_OBJECT_CLASS(klass)->finalize = platform_version_plugin_finalize;
 }
 
-static void platform_version_plugin_init(PlatformVersionPlugin* self) {}
+static void platform_version_plugin_init(PlatformVersionPlugin* self) {
+  g_mutex_init(&self->cpu_usage_mutex);
+  g_mutex_init(&self->process_info_mutex);
+  g_mutex_init(&self->thread_stats_mutex);
+  g_mutex_init(&self->sampler_mutex);
+  self->metrics = new PluginMetrics();
+  self->metrics->since_ns = latency_now_ns();
+  self->snapshot = platform_version_shared_snapshot();
+  // Opt-in through configureDispatch.
+  self->async_dispatch = FALSE;
+  self->worker_threads = kDefaultWorkerThreads;
+  self->max_queued_calls = kDefaultMaxQueuedCalls;
+  self->main_context = g_main_context_ref_thread_default();
+  self->cpu_features = cpu_features_detect();
+  self->sysroot = sysroot_from_environment();
+  self->meminfo_reader = platform_version_shared_meminfo_reader();
+  process_stats_reader_open(&self->process_stats_reader,
+                            sysroot_path(self->sysroot, "/proc/self").path);
+}
+
+// Probes the static properties pv_get_snapshot() reports, so that neither
+// the first getDeviceInfo nor the first synchronous read from Dart waits for
+// /proc/cpuinfo, /etc/os-release or the stable ID's lock.
+static gpointer warm_snapshot_thread(gpointer user_data) {
+  g_autoptr(GObject) plugin = G_OBJECT(user_data);
+  DeviceInfoProbeResults results = {};
+  run_device_info_probes(PLATFORM_VERSION_PLUGIN(plugin),
+                         kProbeStableDeviceId | kProbeKernel |
+                             kProbeProcessors | kProbeCpuInfo |
+                             kProbeOsRelease,
+                         &results);
+  return nullptr;
+}
 
 static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
                            gpointer user_data) {
@@ -191,5 +1700,31 @@ void platform_version_plugin_register_with_registrar(FlPluginRegistrar* registra
                                             g_object_ref(plugin),
                                             g_object_unref);
 
+  FlBinaryMessenger* messenger = fl_plugin_registrar_get_messenger(registrar);
+  periodic_stream_start_handling(&plugin->telemetry_stream, plugin, messenger,
+                                 FL_METHOD_CODEC(codec),
+                                 "platform_version/telemetry",
+                                 telemetry_stream_sample, nullptr);
+  periodic_stream_start_handling(&plugin->cpu_usage_stream, plugin, messenger,
+                                 FL_METHOD_CODEC(codec),
+                                 "platform_version/cpu_usage",
+                                 cpu_usage_stream_sample,
+                                 cpu_usage_stream_reset);
+  periodic_stream_start_handling(&plugin->process_info_stream, plugin,
+                                 messenger, FL_METHOD_CODEC(codec),
+                                 "platform_version/process_info",
+                                 process_info_stream_sample,
+                                 process_info_stream_reset);
+  periodic_stream_sample_off_main_thread(&plugin->process_info_stream);
+  periodic_stream_start_handling(&plugin->affinity_stream, plugin, messenger,
+                                 FL_METHOD_CODEC(codec),
+                                 "platform_version/cpu_affinity",
+                                 affinity_stream_sample, affinity_stream_reset);
+  plugin->pressure_monitor = pressure_monitor_new(
+      messenger, FL_METHOD_CODEC(codec), plugin->meminfo_reader,
+      plugin->sysroot);
+  g_thread_unref(g_thread_new("platform_version-warm", warm_snapshot_thread,
+                              g_object_ref(plugin)));
+
   g_object_unref(plugin);
 }
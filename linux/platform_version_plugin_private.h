@@ -9,5 +9,100 @@
 // Handles the getPlatformVersion method call.
 FlMethodResponse *get_platform_version();
 
-// Handles the getDeviceInfo method call.
-FlMethodResponse *get_device_info();
+// Handles the getDeviceInfo method call. [args] may be a map whose "keys"
+// entry lists the keys to report; only the probes behind those keys run.
+// Static properties are cached on [self] after they are first probed.
+FlMethodResponse *get_device_info(PlatformVersionPlugin *self, FlValue *args);
+
+// Handles the getDeviceInfoRecord method call: the full getDeviceInfo result
+// packed into a versioned binary record (see the layout in
+// platform_version_plugin.cc and lib/platform_version_device_info_record.dart).
+FlMethodResponse *get_device_info_record(PlatformVersionPlugin *self);
+
+// Handles the getStableDeviceId method call.
+FlMethodResponse *get_stable_device_id();
+
+// Takes one sample for the platform_version/telemetry event channel: the
+// sysinfo() memory, swap, process, uptime and load-average fields. Returns
+// nullptr if sysinfo() fails.
+FlValue *sample_telemetry();
+
+// Handles the getMemoryInfo method call: MemAvailable, Cached, Dirty,
+// Writeback, SReclaimable and SwapCached from /proc/meminfo, in bytes, plus
+// the pswpin/pswpout page counters from /proc/vmstat.
+FlMethodResponse *get_memory_info(PlatformVersionPlugin *self);
+
+// Handles the getCgroupLimits method call: the CPU quota, memory limit,
+// usage and memory.events counters of the process's cgroup, and the number of
+// processors it can actually use.
+FlMethodResponse *get_cgroup_limits(PlatformVersionPlugin *self);
+
+// Handles the getCpuAffinity method call: the CPUs this process may run on
+// as a list and a kernel-style CPU list string, their count, and the same
+// split by NUMA node.
+FlMethodResponse *get_cpu_affinity(PlatformVersionPlugin *self);
+
+// Handles the getCpuFeatures method call: the machine architecture, the
+// instruction-set extension mask detected at registration and the names of
+// its set bits.
+FlMethodResponse *get_cpu_features(PlatformVersionPlugin *self);
+
+// Handles the getCpuTopology method call: packages, cores, SMT, hybrid core
+// classification, caches and NUMA nodes from sysfs. Read once and cached.
+FlMethodResponse *get_cpu_topology(PlatformVersionPlugin *self);
+
+// Handles the getCpuUsage method call: per-core and aggregate user, system,
+// iowait, steal and idle percentages since the previous call, from a single
+// read of /proc/stat. The first call reports usage since boot.
+FlMethodResponse *get_cpu_usage(PlatformVersionPlugin *self);
+
+// Handles the getProcessInfo method call: RSS, PSS when [args] is a map
+// whose "pss" entry is true, peak RSS, swap, threads, page faults, context
+// switches, CPU time and I/O of this process from /proc/self, with a
+// "deltas" map of the changes since the previous call. The first call has
+// no deltas.
+FlMethodResponse *get_process_info(PlatformVersionPlugin *self, FlValue *args);
+
+// Handles the getThreadCpuUsage method call: the name, state, last CPU and
+// CPU time of each thread of this process from /proc/self/task, with a
+// "deltas" map of the CPU time since the previous call (or since the thread
+// started) and its share of the interval. Thread files stay open between
+// calls.
+FlMethodResponse *get_thread_cpu_usage(PlatformVersionPlugin *self);
+
+// Handles the batch method call: runs each {"method", "arguments"} map in
+// the "calls" list in order, sharing probe results between them, and returns
+// one {"result"}, {"error"} or {"notImplemented"} map per call.
+FlMethodResponse *batch(PlatformVersionPlugin *self, FlValue *args);
+
+// Handles the configureSampler method call. Accepts a map with optional
+// "enabled", "intervalMs" and "metrics" (names of the groups to refresh)
+// entries. Starts the background sampler on first use; disabling leaves its
+// thread idle until the plugin is disposed.
+FlMethodResponse *configure_sampler(PlatformVersionPlugin *self,
+                                    FlValue *args);
+
+// Handles the getSampledMetrics method call: the background sampler's latest
+// sample, its age and refresh count, or null while the sampler is off.
+FlMethodResponse *get_sampled_metrics(PlatformVersionPlugin *self);
+
+// Handles the getPluginMetrics method call: the count, error count, mean,
+// p50, p90, p99 and maximum latency of each method handler and each
+// getDeviceInfo probe that ran since the last reset. [args] may be a map
+// whose "reset" entry, when true, clears the histograms after reading them.
+FlMethodResponse *get_plugin_metrics(PlatformVersionPlugin *self,
+                                     FlValue *args);
+
+// Handles the configureTracing method call: starts or stops recording
+// method, probe and file-read events according to the map's "enabled" bool.
+FlMethodResponse *configure_tracing(FlValue *args);
+
+// Handles the dumpTrace method call: writes the recorded events to the map's
+// "path" as Chrome Trace Event JSON and returns how many were written. They
+// are dropped from memory unless "clear" is false.
+FlMethodResponse *dump_trace(FlValue *args);
+
+// Handles the configureDispatch method call. Accepts a map with optional
+// "async", "maxThreads" and "maxQueuedCalls" entries.
+FlMethodResponse *configure_dispatch(PlatformVersionPlugin *self,
+                                     FlValue *args);
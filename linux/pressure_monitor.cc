@@ -0,0 +1,378 @@
+#include "pressure_monitor.h"
+
+#include <glib-unix.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "psi.h"
+#include "sysroot.h"
+
+enum PressureResource {
+  kPressureMemory,
+  kPressureCpu,
+  kPressureIo,
+  kPressureResourceCount,
+};
+
+static const gchar* const kPressureResourceNames[kPressureResourceCount] = {
+    "memory", "cpu", "io"};
+// Resolved under the sysroot by pressure_monitor_new().
+static const gchar* const kPressureResourcePaths[kPressureResourceCount] = {
+    "/proc/pressure/memory", "/proc/pressure/cpu", "/proc/pressure/io"};
+
+// Default trigger: 150 ms of stall within any 1 s window.
+static const gint64 kDefaultStallUs = 150000;
+static const gint64 kDefaultWindowUs = 1000000;
+// Window limits enforced by the kernel for PSI triggers.
+static const gint64 kMinWindowUs = 500000;
+static const gint64 kMaxWindowUs = 10000000;
+// Since Linux 6.5 processes without CAP_SYS_RESOURCE may create triggers, but
+// only with windows that are a multiple of this.
+static const guint kUnprivilegedWindowStepUs = 2000000;
+
+// Sampling interval used when PSI triggers are unavailable.
+static const gint64 kDefaultFallbackIntervalMs = 2000;
+static const gint64 kMinFallbackIntervalMs = 100;
+
+// Without PSI, memory counts as under pressure below this share of
+// available RAM, in percent.
+static const guint64 kFallbackMemAvailablePercent = 10;
+
+// How one resource is being watched.
+typedef enum {
+  kPressureSourceNone,
+  kPressureSourcePsi,
+  kPressureSourceSampler,
+} PressureSource;
+
+typedef struct {
+  PressureMonitor* monitor;
+  PressureResource resource;
+  // The resource's /proc/pressure file under the plugin's sysroot.
+  SysrootPath path;
+  PressureSource source;
+  // PSI trigger descriptor, or -1.
+  int fd;
+  // Window of the PSI trigger, which may be wider than requested.
+  guint window_us;
+  // Descriptor watch or fallback timer.
+  guint source_id;
+  // Single-shot timer that ends a PSI pressure episode once the trigger has
+  // stayed quiet for two windows.
+  guint relief_id;
+  gboolean under_pressure;
+} PressureWatch;
+
+struct _PressureMonitor {
+  FlEventChannel* channel;
+  const MemInfoReader* meminfo;
+  PressureWatch watches[kPressureResourceCount];
+
+  // Settings of the current subscription.
+  gboolean full;
+  guint stall_us;
+  guint window_us;
+  guint fallback_interval_ms;
+};
+
+static FlValue* psi_line_to_value(const PsiLine& line) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "avg10", fl_value_new_float(line.avg10));
+  fl_value_set_string_take(value, "avg60", fl_value_new_float(line.avg60));
+  fl_value_set_string_take(value, "avg300", fl_value_new_float(line.avg300));
+  fl_value_set_string_take(value, "totalUs",
+                           fl_value_new_int(line.total_us));
+  return value;
+}
+
+static const gchar* pressure_source_name(PressureSource source) {
+  switch (source) {
+    case kPressureSourcePsi:
+      return "psi";
+    case kPressureSourceSampler:
+      return "sampler";
+    case kPressureSourceNone:
+      break;
+  }
+  return "unavailable";
+}
+
+// Sends the state of [watch], with [stats] if they could be read.
+static void pressure_watch_send(PressureWatch* watch, const PsiStats* stats) {
+  g_autoptr(FlValue) event = fl_value_new_map();
+  fl_value_set_string_take(
+      event, "resource",
+      fl_value_new_string(kPressureResourceNames[watch->resource]));
+  fl_value_set_string_take(event, "underPressure",
+                           fl_value_new_bool(watch->under_pressure));
+  fl_value_set_string_take(event, "source",
+                           fl_value_new_string(pressure_source_name(watch->source)));
+  if (stats != nullptr) {
+    fl_value_set_string_take(event, "some", psi_line_to_value(stats->some));
+    if (stats->has_full) {
+      fl_value_set_string_take(event, "full", psi_line_to_value(stats->full));
+    }
+  }
+  fl_event_channel_send(watch->monitor->channel, event, nullptr, nullptr);
+}
+
+// Reads the current stats of [watch] into [stats] and decides whether the
+// resource is under pressure by the subscription's threshold. Sets
+// [has_stats] to whether [stats] were read.
+static gboolean pressure_watch_evaluate(PressureWatch* watch,
+                                        PsiStats* stats,
+                                        gboolean* has_stats) {
+  PressureMonitor* monitor = watch->monitor;
+  *has_stats = watch->fd >= 0
+                   ? psi_read_fd(watch->fd, stats)
+                   : psi_read_path(watch->path.path, stats);
+  if (*has_stats) {
+    const PsiLine& line =
+        monitor->full && stats->has_full ? stats->full : stats->some;
+    double threshold = 100.0 * monitor->stall_us / monitor->window_us;
+    return line.avg10 >= threshold;
+  }
+
+  MemInfo info;
+  if (watch->resource == kPressureMemory &&
+      meminfo_reader_read(monitor->meminfo, &info) && info.mem_total > 0) {
+    return info.mem_available * 100 <
+           info.mem_total * kFallbackMemAvailablePercent;
+  }
+  return FALSE;
+}
+
+static gboolean pressure_relief_cb(gpointer user_data) {
+  PressureWatch* watch = static_cast<PressureWatch*>(user_data);
+  watch->relief_id = 0;
+  watch->under_pressure = FALSE;
+
+  PsiStats stats;
+  gboolean has_stats = psi_read_fd(watch->fd, &stats);
+  pressure_watch_send(watch, has_stats ? &stats : nullptr);
+  return G_SOURCE_REMOVE;
+}
+
+// The kernel fires a trigger at most once per window while the stall lasts,
+// so a quiet period of two windows ends the episode.
+static void pressure_watch_arm_relief(PressureWatch* watch) {
+  g_clear_handle_id(&watch->relief_id, g_source_remove);
+  guint relief_ms = 2 * watch->window_us / 1000;
+  watch->relief_id = g_timeout_add(relief_ms, pressure_relief_cb, watch);
+}
+
+static gboolean pressure_sampler_cb(gpointer user_data) {
+  PressureWatch* watch = static_cast<PressureWatch*>(user_data);
+  PsiStats stats;
+  gboolean has_stats = FALSE;
+  gboolean pressured = pressure_watch_evaluate(watch, &stats, &has_stats);
+  if (pressured != watch->under_pressure) {
+    watch->under_pressure = pressured;
+    pressure_watch_send(watch, has_stats ? &stats : nullptr);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+static void pressure_watch_start_sampler(PressureWatch* watch) {
+  watch->source = kPressureSourceSampler;
+  watch->source_id = g_timeout_add(watch->monitor->fallback_interval_ms,
+                                   pressure_sampler_cb, watch);
+}
+
+static gboolean pressure_trigger_cb(gint fd,
+                                    GIOCondition condition,
+                                    gpointer user_data) {
+  PressureWatch* watch = static_cast<PressureWatch*>(user_data);
+
+  if ((condition & (G_IO_ERR | G_IO_HUP)) != 0) {
+    // The trigger is gone; keep reporting through the sampler instead.
+    watch->source_id = 0;
+    g_clear_handle_id(&watch->relief_id, g_source_remove);
+    close(watch->fd);
+    watch->fd = -1;
+    pressure_watch_start_sampler(watch);
+    return G_SOURCE_REMOVE;
+  }
+
+  if (!watch->under_pressure) {
+    watch->under_pressure = TRUE;
+    PsiStats stats;
+    gboolean has_stats = psi_read_fd(watch->fd, &stats);
+    pressure_watch_send(watch, has_stats ? &stats : nullptr);
+  }
+  pressure_watch_arm_relief(watch);
+  return G_SOURCE_CONTINUE;
+}
+
+static void pressure_watch_start(PressureWatch* watch) {
+  PressureMonitor* monitor = watch->monitor;
+  const gchar* path = watch->path.path;
+  const gchar* type = monitor->full ? "full" : "some";
+
+  watch->window_us = monitor->window_us;
+  watch->fd = psi_open_trigger(path, type, monitor->stall_us, watch->window_us);
+  if (watch->fd < 0 && errno == EINVAL &&
+      watch->window_us % kUnprivilegedWindowStepUs != 0) {
+    // Retry with the window rounded up to what unprivileged processes may
+    // use, keeping the stall share the same.
+    guint window_us = (watch->window_us / kUnprivilegedWindowStepUs + 1) *
+                      kUnprivilegedWindowStepUs;
+    guint stall_us = static_cast<guint>(
+        static_cast<guint64>(monitor->stall_us) * window_us /
+        monitor->window_us);
+    watch->fd = psi_open_trigger(path, type, stall_us, window_us);
+    if (watch->fd >= 0) {
+      watch->window_us = window_us;
+    }
+  }
+  if (watch->fd >= 0) {
+    watch->source = kPressureSourcePsi;
+    watch->source_id = g_unix_fd_add_full(
+        G_PRIORITY_DEFAULT, watch->fd,
+        static_cast<GIOCondition>(G_IO_PRI | G_IO_ERR | G_IO_HUP),
+        pressure_trigger_cb, watch, nullptr);
+  } else if (access(path, R_OK) == 0 || watch->resource == kPressureMemory) {
+    pressure_watch_start_sampler(watch);
+  } else {
+    watch->source = kPressureSourceNone;
+  }
+
+  // Report the starting state so listeners know what is being watched.
+  PsiStats stats;
+  gboolean has_stats = FALSE;
+  if (watch->source != kPressureSourceNone) {
+    watch->under_pressure = pressure_watch_evaluate(watch, &stats, &has_stats);
+    if (watch->under_pressure && watch->source == kPressureSourcePsi) {
+      pressure_watch_arm_relief(watch);
+    }
+  }
+  pressure_watch_send(watch, has_stats ? &stats : nullptr);
+}
+
+static void pressure_watch_stop(PressureWatch* watch) {
+  g_clear_handle_id(&watch->source_id, g_source_remove);
+  g_clear_handle_id(&watch->relief_id, g_source_remove);
+  if (watch->fd >= 0) {
+    close(watch->fd);
+    watch->fd = -1;
+  }
+  watch->source = kPressureSourceNone;
+  watch->under_pressure = FALSE;
+}
+
+static void pressure_monitor_stop(PressureMonitor* monitor) {
+  for (PressureWatch& watch : monitor->watches) {
+    pressure_watch_stop(&watch);
+  }
+}
+
+static gint64 pressure_lookup_int(FlValue* args,
+                                  const gchar* key,
+                                  gint64 fallback) {
+  FlValue* value = fl_value_lookup_string(args, key);
+  return value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT
+             ? fl_value_get_int(value)
+             : fallback;
+}
+
+// Starts watching when Dart listens. [args] may hold "resources" (a list of
+// "memory", "cpu" and "io"; memory only by default), "type" ("some" or
+// "full"), "stallUs", "windowUs" and "fallbackIntervalMs".
+static FlMethodErrorResponse* pressure_listen_cb(FlEventChannel* channel,
+                                                 FlValue* args,
+                                                 gpointer user_data) {
+  PressureMonitor* monitor = static_cast<PressureMonitor*>(user_data);
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    args = nullptr;
+  }
+
+  gint64 stall_us = kDefaultStallUs;
+  gint64 window_us = kDefaultWindowUs;
+  gint64 fallback_interval_ms = kDefaultFallbackIntervalMs;
+  gboolean full = FALSE;
+  gboolean wanted[kPressureResourceCount] = {TRUE, FALSE, FALSE};
+  if (args != nullptr) {
+    stall_us = pressure_lookup_int(args, "stallUs", stall_us);
+    window_us = pressure_lookup_int(args, "windowUs", window_us);
+    fallback_interval_ms = MAX(
+        pressure_lookup_int(args, "fallbackIntervalMs", fallback_interval_ms),
+        kMinFallbackIntervalMs);
+
+    FlValue* type = fl_value_lookup_string(args, "type");
+    if (type != nullptr && fl_value_get_type(type) == FL_VALUE_TYPE_STRING) {
+      full = strcmp(fl_value_get_string(type), "full") == 0;
+    }
+
+    FlValue* resources = fl_value_lookup_string(args, "resources");
+    if (resources != nullptr &&
+        fl_value_get_type(resources) == FL_VALUE_TYPE_LIST) {
+      wanted[kPressureMemory] = FALSE;
+      for (size_t i = 0; i < fl_value_get_length(resources); ++i) {
+        FlValue* name = fl_value_get_list_value(resources, i);
+        if (fl_value_get_type(name) != FL_VALUE_TYPE_STRING) continue;
+        for (int r = 0; r < kPressureResourceCount; ++r) {
+          if (strcmp(fl_value_get_string(name), kPressureResourceNames[r]) ==
+              0) {
+            wanted[r] = TRUE;
+          }
+        }
+      }
+    }
+  }
+
+  if (window_us < kMinWindowUs || window_us > kMaxWindowUs || stall_us <= 0 ||
+      stall_us > window_us) {
+    return fl_method_error_response_new(
+        "INVALID_ARGUMENTS",
+        "windowUs must be between 500000 and 10000000 and stallUs between 1 "
+        "and windowUs",
+        nullptr);
+  }
+
+  pressure_monitor_stop(monitor);
+  monitor->full = full;
+  monitor->stall_us = stall_us;
+  monitor->window_us = window_us;
+  monitor->fallback_interval_ms = fallback_interval_ms;
+  for (int r = 0; r < kPressureResourceCount; ++r) {
+    if (wanted[r]) {
+      pressure_watch_start(&monitor->watches[r]);
+    }
+  }
+  return nullptr;
+}
+
+static FlMethodErrorResponse* pressure_cancel_cb(FlEventChannel* channel,
+                                                 FlValue* args,
+                                                 gpointer user_data) {
+  pressure_monitor_stop(static_cast<PressureMonitor*>(user_data));
+  return nullptr;
+}
+
+PressureMonitor* pressure_monitor_new(FlBinaryMessenger* messenger,
+                                      FlMethodCodec* codec,
+                                      const MemInfoReader* meminfo,
+                                      const char* sysroot) {
+  PressureMonitor* monitor = g_new0(PressureMonitor, 1);
+  monitor->meminfo = meminfo;
+  for (int r = 0; r < kPressureResourceCount; ++r) {
+    PressureWatch* watch = &monitor->watches[r];
+    watch->monitor = monitor;
+    watch->resource = static_cast<PressureResource>(r);
+    watch->path = sysroot_path(sysroot, kPressureResourcePaths[r]);
+    watch->fd = -1;
+  }
+  monitor->channel =
+      fl_event_channel_new(messenger, "platform_version/pressure", codec);
+  fl_event_channel_set_stream_handlers(monitor->channel, pressure_listen_cb,
+                                       pressure_cancel_cb, monitor, nullptr);
+  return monitor;
+}
+
+void pressure_monitor_free(PressureMonitor* monitor) {
+  pressure_monitor_stop(monitor);
+  g_clear_object(&monitor->channel);
+  g_free(monitor);
+}
@@ -0,0 +1,29 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_PRESSURE_MONITOR_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_PRESSURE_MONITOR_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include "meminfo.h"
+
+// Pushes memory, CPU and I/O pressure transitions to Dart on the
+// "platform_version/pressure" event channel.
+//
+// Where the kernel allows it, each resource gets a PSI trigger and the
+// main loop waits on its descriptor, so nothing runs until the kernel
+// reports a stall. Otherwise a low-rate timer compares the 10 second PSI
+// average, or for memory the share of available RAM, against the same
+// threshold.
+typedef struct _PressureMonitor PressureMonitor;
+
+// Registers the event channel. [meminfo] is used by the memory fallback and
+// must outlive the monitor. The /proc/pressure files are read under
+// [sysroot], as with sysroot_path().
+PressureMonitor* pressure_monitor_new(FlBinaryMessenger* messenger,
+                                      FlMethodCodec* codec,
+                                      const MemInfoReader* meminfo,
+                                      const char* sysroot);
+
+// Stops monitoring and releases the channel.
+void pressure_monitor_free(PressureMonitor* monitor);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_PRESSURE_MONITOR_H_
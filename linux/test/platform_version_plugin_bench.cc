@@ -0,0 +1,485 @@
+#include <benchmark/benchmark.h>
+#include <flutter_linux/flutter_linux.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "include/platform_version/platform_version_ffi.h"
+#include "include/platform_version/platform_version_plugin.h"
+#include "cpu_usage.h"
+#include "device_info.h"
+#include "device_info_fl_value.h"
+#include "latency_histogram.h"
+#include "meminfo.h"
+#include "metrics_sampler.h"
+#include "platform_version_plugin_private.h"
+#include "proc_parser.h"
+#include "process_stats.h"
+#include "stable_device_id.h"
+#include "sysroot.h"
+#include "thread_stats.h"
+#include "trace_recorder.h"
+
+// Benchmarks for the plugin's native entry points.
+//
+// Besides the usual time per iteration, every benchmark reports:
+//   allocs/iter  heap allocations (malloc, calloc, realloc, including GLib's
+//                and operator new) per iteration
+//   p50_ns       median latency of a single iteration
+//   p99_ns       99th percentile latency of a single iteration
+//
+// Once the example app has been built, run for instance:
+// $ build/linux/x64/release/plugins/platform_version/platform_version_bench
+
+// Every allocation in the process goes through these, so GLib and FlValue
+// allocations are counted as well as C++ ones.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void __libc_free(void* p);
+}
+
+static std::atomic<size_t> allocation_count{0};
+
+extern "C" void* malloc(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(p, size);
+}
+
+extern "C" void free(void* p) { __libc_free(p); }
+
+namespace platform_version {
+namespace bench {
+
+// Upper bound on the per-iteration latencies kept for the percentiles.
+static const size_t kMaxLatencySamples = 1 << 20;
+
+static gint64 now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<gint64>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Runs [body] once per benchmark iteration and reports allocations per
+// iteration and p50/p99 latency as counters.
+template <typename Body>
+static void run_measured(benchmark::State& state, Body body) {
+  std::vector<gint64> latencies;
+  latencies.reserve(kMaxLatencySamples);
+
+  size_t allocations_before = allocation_count.load();
+  for (auto _ : state) {
+    gint64 start = now_ns();
+    body();
+    gint64 elapsed = now_ns() - start;
+    if (latencies.size() < latencies.capacity()) latencies.push_back(elapsed);
+  }
+  size_t allocations = allocation_count.load() - allocations_before;
+
+  state.counters["allocs/iter"] = benchmark::Counter(
+      static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["p50_ns"] = latencies[latencies.size() / 2];
+    state.counters["p99_ns"] = latencies[latencies.size() * 99 / 100];
+  }
+}
+
+static std::string fixture_path(const char* name) {
+  return std::string(PLATFORM_VERSION_FIXTURE_DIR) + "/" + name;
+}
+
+static PlatformVersionPlugin* new_plugin() {
+  return reinterpret_cast<PlatformVersionPlugin*>(
+      g_object_new(platform_version_plugin_get_type(), nullptr));
+}
+
+static void BM_GetPlatformVersion(benchmark::State& state) {
+  run_measured(state, [] {
+    g_autoptr(FlMethodResponse) response = get_platform_version();
+    benchmark::DoNotOptimize(response);
+  });
+}
+BENCHMARK(BM_GetPlatformVersion);
+
+// A first getDeviceInfo: every iteration probes into a fresh snapshot, since
+// plugins share one for the whole process. The stable ID is still memoized
+// after the first read; BM_StableDeviceIdFromDisk covers that file.
+static void BM_GetDeviceInfoCold(benchmark::State& state) {
+  MemInfoReader meminfo_reader;
+  meminfo_reader_open(&meminfo_reader, "/proc/meminfo", "/proc/vmstat");
+  unsigned probes = 0;
+  for (const DeviceInfoKey& key : kDeviceInfoKeys) probes |= key.probe;
+  run_measured(state, [&] {
+    DeviceSnapshot snapshot;
+    DeviceInfoProbeContext context = {&snapshot, nullptr, &meminfo_reader,
+                                      nullptr, nullptr};
+    DeviceInfoProbeResults results = {};
+    device_info_run_probes(context, probes, &results);
+    DeviceInfo info;
+    device_info_collect(results, probes, &info);
+    g_autoptr(FlValue) device_info = device_info_to_fl_value(info);
+    benchmark::DoNotOptimize(device_info);
+  });
+  meminfo_reader_close(&meminfo_reader);
+}
+BENCHMARK(BM_GetDeviceInfoCold);
+
+// The steady state: static fields come from the snapshot.
+static void BM_GetDeviceInfoWarm(benchmark::State& state) {
+  PlatformVersionPlugin* plugin = new_plugin();
+  g_object_unref(get_device_info(plugin, nullptr));
+  run_measured(state, [plugin] {
+    g_autoptr(FlMethodResponse) response = get_device_info(plugin, nullptr);
+    benchmark::DoNotOptimize(response);
+  });
+  g_object_unref(plugin);
+}
+BENCHMARK(BM_GetDeviceInfoWarm);
+
+// The same call with the background sampler running: sysinfo() and
+// /proc/meminfo become a copy of its latest sample.
+static void BM_GetDeviceInfoWarmSampled(benchmark::State& state) {
+  PlatformVersionPlugin* plugin = new_plugin();
+  g_object_unref(get_device_info(plugin, nullptr));
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, "intervalMs", fl_value_new_int(100));
+  g_object_unref(configure_sampler(plugin, args));
+  run_measured(state, [plugin] {
+    g_autoptr(FlMethodResponse) response = get_device_info(plugin, nullptr);
+    benchmark::DoNotOptimize(response);
+  });
+  g_object_unref(plugin);
+}
+BENCHMARK(BM_GetDeviceInfoWarmSampled);
+
+static void BM_GetDeviceInfoSingleKey(benchmark::State& state) {
+  PlatformVersionPlugin* plugin = new_plugin();
+  g_autoptr(FlValue) keys = fl_value_new_list();
+  fl_value_append_take(keys, fl_value_new_string("freeRam"));
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string(args, "keys", keys);
+  run_measured(state, [plugin, args] {
+    g_autoptr(FlMethodResponse) response = get_device_info(plugin, args);
+    benchmark::DoNotOptimize(response);
+  });
+  g_object_unref(plugin);
+}
+BENCHMARK(BM_GetDeviceInfoSingleKey);
+
+static void BM_GetDeviceInfoRecord(benchmark::State& state) {
+  PlatformVersionPlugin* plugin = new_plugin();
+  g_object_unref(get_device_info(plugin, nullptr));
+  run_measured(state, [plugin] {
+    g_autoptr(FlMethodResponse) response = get_device_info_record(plugin);
+    benchmark::DoNotOptimize(response);
+  });
+  g_object_unref(plugin);
+}
+BENCHMARK(BM_GetDeviceInfoRecord);
+
+// The dart:ffi path: a struct copy for the static fields and one sysinfo()
+// plus one /proc/meminfo read for the dynamic ones, with no FlValue or codec.
+static void BM_FfiGetSnapshot(benchmark::State& state) {
+  pv_snapshot snapshot;
+  pv_get_snapshot(&snapshot);
+  run_measured(state, [&] {
+    pv_get_snapshot(&snapshot);
+    benchmark::DoNotOptimize(snapshot);
+  });
+}
+BENCHMARK(BM_FfiGetSnapshot);
+
+static void BM_FfiSampleDynamic(benchmark::State& state) {
+  pv_dynamic dynamic;
+  run_measured(state, [&] {
+    pv_sample_dynamic(&dynamic, PV_DYNAMIC_SYSINFO | PV_DYNAMIC_MEMINFO);
+    benchmark::DoNotOptimize(dynamic);
+  });
+}
+BENCHMARK(BM_FfiSampleDynamic);
+
+// The startup sequence of the example app as separate calls and as one
+// batch; the batch shares the sysinfo() and /proc/meminfo reads.
+static void BM_StartupSequential(benchmark::State& state) {
+  PlatformVersionPlugin* plugin = new_plugin();
+  g_object_unref(get_device_info(plugin, nullptr));
+  run_measured(state, [plugin] {
+    g_autoptr(FlMethodResponse) version = get_platform_version();
+    g_autoptr(FlMethodResponse) id = get_stable_device_id();
+    g_autoptr(FlMethodResponse) info = get_device_info(plugin, nullptr);
+    g_autoptr(FlMethodResponse) memory = get_memory_info(plugin);
+    benchmark::DoNotOptimize(version);
+    benchmark::DoNotOptimize(id);
+    benchmark::DoNotOptimize(info);
+    benchmark::DoNotOptimize(memory);
+  });
+  g_object_unref(plugin);
+}
+BENCHMARK(BM_StartupSequential);
+
+static void BM_StartupBatch(benchmark::State& state) {
+  PlatformVersionPlugin* plugin = new_plugin();
+  g_object_unref(get_device_info(plugin, nullptr));
+  g_autoptr(FlValue) calls = fl_value_new_list();
+  for (const char* method : {"getPlatformVersion", "getStableDeviceId",
+                             "getDeviceInfo", "getMemoryInfo"}) {
+    FlValue* call = fl_value_new_map();
+    fl_value_set_string_take(call, "method", fl_value_new_string(method));
+    fl_value_append_take(calls, call);
+  }
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string(args, "calls", calls);
+  run_measured(state, [plugin, args] {
+    g_autoptr(FlMethodResponse) response = batch(plugin, args);
+    benchmark::DoNotOptimize(response);
+  });
+  g_object_unref(plugin);
+}
+BENCHMARK(BM_StartupBatch);
+
+static void BM_StableDeviceIdMemoized(benchmark::State& state) {
+  stable_device_id_get();
+  run_measured(state, [] {
+    std::string id = stable_device_id_get();
+    benchmark::DoNotOptimize(id);
+  });
+}
+BENCHMARK(BM_StableDeviceIdMemoized);
+
+// The uncached path: reads the ID file on every iteration.
+static void BM_StableDeviceIdFromDisk(benchmark::State& state) {
+  char dir_template[] = "/tmp/platform_version_bench_XXXXXX";
+  if (mkdtemp(dir_template) == nullptr) {
+    state.SkipWithError("mkdtemp failed");
+    return;
+  }
+  std::string dir_path = dir_template;
+  stable_device_id_load_or_create(dir_path);
+  run_measured(state, [&dir_path] {
+    std::string id = stable_device_id_load_or_create(dir_path);
+    benchmark::DoNotOptimize(id);
+  });
+  // Removes the ID, its lock file and the directory.
+  std::error_code error;
+  std::filesystem::remove_all(dir_path, error);
+}
+BENCHMARK(BM_StableDeviceIdFromDisk);
+
+static void BM_CpuinfoModelName(benchmark::State& state, std::string path) {
+  std::string model;
+  model.reserve(256);
+  run_measured(state, [&] {
+    cpuinfo_read_model_name(path.c_str(), &model);
+    benchmark::DoNotOptimize(model);
+  });
+}
+BENCHMARK_CAPTURE(BM_CpuinfoModelName, live, std::string("/proc/cpuinfo"));
+BENCHMARK_CAPTURE(BM_CpuinfoModelName, fixture_x86_64_4core,
+                  fixture_path("cpuinfo_x86_64_4core"));
+BENCHMARK_CAPTURE(BM_CpuinfoModelName, fixture_arm_2core_sbc,
+                  fixture_path("sysroot/arm_2core_sbc/proc/cpuinfo"));
+
+static void BM_OsRelease(benchmark::State& state, std::string path) {
+  std::string name;
+  std::string version;
+  name.reserve(256);
+  version.reserve(256);
+  run_measured(state, [&] {
+    os_release_read(path.c_str(), &name, &version);
+    benchmark::DoNotOptimize(name);
+    benchmark::DoNotOptimize(version);
+  });
+}
+BENCHMARK_CAPTURE(BM_OsRelease, live, std::string("/etc/os-release"));
+BENCHMARK_CAPTURE(BM_OsRelease, fixture_debian,
+                  fixture_path("os-release_debian"));
+BENCHMARK_CAPTURE(BM_OsRelease, fixture_unusual_quoting,
+                  fixture_path("sysroot/os_release_quoting/etc/os-release"));
+
+// Every cpu line of /proc/stat, as getCpuUsage reads it.
+static void BM_ProcStatRead(benchmark::State& state, std::string path) {
+  std::vector<CpuTimes> times;
+  run_measured(state, [&] {
+    proc_stat_read(path.c_str(), &times);
+    benchmark::DoNotOptimize(times);
+  });
+}
+BENCHMARK_CAPTURE(BM_ProcStatRead, live, std::string("/proc/stat"));
+BENCHMARK_CAPTURE(BM_ProcStatRead, fixture_epyc_256_thread,
+                  fixture_path("sysroot/epyc_256_thread/proc/stat"));
+
+// The file-backed static probes from scratch, as on the first getDeviceInfo
+// call, against a recorded host.
+static void BM_StaticProbesCold(benchmark::State& state, std::string host) {
+  std::string sysroot = fixture_path(("sysroot/" + host).c_str());
+  LatencyHistogram histograms[kProbeCount] = {};
+  const unsigned probes = kProbeCpuInfo | kProbeOsRelease | kProbeCgroupPaths |
+                          kProbeNumaNodes | kProbeCpuTopology;
+  run_measured(state, [&] {
+    DeviceSnapshot snapshot;
+    DeviceInfoProbeContext context = {&snapshot, histograms, nullptr, nullptr,
+                                      sysroot.c_str()};
+    DeviceInfoProbeResults results = {};
+    device_info_run_probes(context, probes, &results);
+    benchmark::DoNotOptimize(results);
+  });
+}
+BENCHMARK_CAPTURE(BM_StaticProbesCold, arm_2core_sbc,
+                  std::string("arm_2core_sbc"));
+BENCHMARK_CAPTURE(BM_StaticProbesCold, container_cgroup_v2,
+                  std::string("container_cgroup_v2"));
+BENCHMARK_CAPTURE(BM_StaticProbesCold, epyc_256_thread,
+                  std::string("epyc_256_thread"));
+
+// One meminfo sample through descriptors that stay open between samples.
+static void BM_MemInfoRead(benchmark::State& state) {
+  MemInfoReader reader;
+  meminfo_reader_open(&reader, "/proc/meminfo", "/proc/vmstat");
+  MemInfo info;
+  run_measured(state, [&] {
+    meminfo_reader_read(&reader, &info);
+    benchmark::DoNotOptimize(info);
+  });
+  meminfo_reader_close(&reader);
+}
+BENCHMARK(BM_MemInfoRead);
+
+// One /proc/self sample, without and with the smaps_rollup walk for PSS.
+static void BM_ProcessStatsRead(benchmark::State& state) {
+  ProcessStatsReader reader;
+  process_stats_reader_open(&reader, "/proc/self");
+  ProcessStats stats;
+  run_measured(state, [&] {
+    process_stats_reader_read(&reader, state.range(0) != 0, &stats);
+    benchmark::DoNotOptimize(stats);
+  });
+  process_stats_reader_close(&reader);
+}
+BENCHMARK(BM_ProcessStatsRead)->Arg(0)->Arg(1);
+
+// One per-thread CPU sample of this process, whose threads' stat files
+// stay open between samples.
+static void BM_ThreadStatsSample(benchmark::State& state) {
+  ThreadStatsSampler sampler;
+  thread_stats_sampler_open(&sampler, "/proc/self/task");
+  std::vector<ThreadCpuUsage> usage;
+  double interval_ms;
+  run_measured(state, [&] {
+    thread_stats_sampler_sample(&sampler, &usage, &interval_ms);
+    benchmark::DoNotOptimize(usage.data());
+  });
+  thread_stats_sampler_close(&sampler);
+}
+BENCHMARK(BM_ThreadStatsSample);
+
+// A seqlock read of the sampler's snapshot while it refreshes every 10 ms,
+// from one reader and from several at once.
+static void BM_MetricsSamplerRead(benchmark::State& state) {
+  static MetricsSampler* sampler = nullptr;
+  if (state.thread_index() == 0) {
+    sampler = metrics_sampler_start("/proc", kAllMetrics, 10);
+  }
+  MetricsSample sample;
+  for (auto _ : state) {
+    metrics_sampler_read(sampler, &sample);
+    benchmark::DoNotOptimize(sample);
+  }
+  if (state.thread_index() == 0) metrics_sampler_stop(sampler);
+}
+BENCHMARK(BM_MetricsSamplerRead)->Threads(1)->Threads(4);
+
+// What the instrumentation adds to every method call and probe: two clock
+// reads and one histogram update.
+static void BM_LatencyHistogramRecord(benchmark::State& state) {
+  static LatencyHistogram histogram;
+  for (auto _ : state) {
+    uint64_t start_ns = latency_now_ns();
+    latency_histogram_record(&histogram, latency_now_ns() - start_ns, false);
+  }
+}
+BENCHMARK(BM_LatencyHistogramRecord)->Threads(1)->Threads(4);
+
+// A begin/end pair of trace events, with tracing off and on. Off is what
+// every method call, probe and file read pays when nobody is tracing.
+static void BM_TraceScope(benchmark::State& state) {
+  if (state.thread_index() == 0) trace_recorder_set_enabled(state.range(0));
+  for (auto _ : state) {
+    TraceScope scope("bench", "scope");
+    benchmark::DoNotOptimize(scope.active);
+  }
+  if (state.thread_index() == 0) trace_recorder_set_enabled(false);
+}
+BENCHMARK(BM_TraceScope)->Arg(0)->Arg(1)->Threads(1)->Threads(4);
+
+// The cost of putting a getDeviceInfo reply on the wire.
+static void BM_EncodeDeviceInfo(benchmark::State& state) {
+  PlatformVersionPlugin* plugin = new_plugin();
+  g_autoptr(FlMethodResponse) response = get_device_info(plugin, nullptr);
+  FlValue* device_info = fl_method_success_response_get_result(
+      FL_METHOD_SUCCESS_RESPONSE(response));
+  g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+  run_measured(state, [&] {
+    g_autoptr(GBytes) message = fl_message_codec_encode_message(
+        FL_MESSAGE_CODEC(codec), device_info, nullptr);
+    benchmark::DoNotOptimize(message);
+  });
+  g_object_unref(plugin);
+}
+BENCHMARK(BM_EncodeDeviceInfo);
+
+static void BM_EncodeDeviceInfoRecord(benchmark::State& state) {
+  PlatformVersionPlugin* plugin = new_plugin();
+  g_autoptr(FlMethodResponse) response = get_device_info_record(plugin);
+  FlValue* record = fl_method_success_response_get_result(
+      FL_METHOD_SUCCESS_RESPONSE(response));
+  g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+  run_measured(state, [&] {
+    g_autoptr(GBytes) message = fl_message_codec_encode_message(
+        FL_MESSAGE_CODEC(codec), record, nullptr);
+    benchmark::DoNotOptimize(message);
+  });
+  g_object_unref(plugin);
+}
+BENCHMARK(BM_EncodeDeviceInfoRecord);
+
+}  // namespace bench
+}  // namespace platform_version
+
+// BENCHMARK_MAIN(), with XDG_CONFIG_HOME pointed at a temporary directory so
+// the benchmarks that read the stable device ID create it there rather than in
+// the developer's ~/.config.
+int main(int argc, char** argv) {
+  char config_home[] = "/tmp/platform_version_bench_config_XXXXXX";
+  if (mkdtemp(config_home) == nullptr) return 1;
+  setenv("XDG_CONFIG_HOME", config_home, 1);
+
+  benchmark::Initialize(&argc, argv);
+  int status = 0;
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    status = 1;
+  } else {
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+  }
+
+  std::error_code error;
+  std::filesystem::remove_all(config_home, error);
+  return status;
+}
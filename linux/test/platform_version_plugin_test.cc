@@ -2,6 +2,16 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <stdlib.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "include/platform_version/platform_version_ffi.h"
 #include "include/platform_version/platform_version_plugin.h"
 #include "platform_version_plugin_private.h"
 
@@ -16,6 +26,32 @@
 namespace platform_version {
 namespace test {
 
+// Points XDG_CONFIG_HOME at a temporary directory for the whole run, so the
+// tests that read the stable device ID create it there rather than in the
+// developer's ~/.config. The ID is memoized per process, so this has to be in
+// place before the first test.
+class ConfigHomeEnvironment : public testing::Environment {
+ public:
+  void SetUp() override {
+    char dir[] = "/tmp/platform_version_config_XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    config_home_ = dir;
+    setenv("XDG_CONFIG_HOME", dir, 1);
+  }
+
+  void TearDown() override {
+    unsetenv("XDG_CONFIG_HOME");
+    std::error_code error;
+    std::filesystem::remove_all(config_home_, error);
+  }
+
+ private:
+  std::string config_home_;
+};
+
+static testing::Environment* const config_home_environment =
+    testing::AddGlobalTestEnvironment(new ConfigHomeEnvironment());
+
 TEST(PlatformVersionPlugin, GetPlatformVersion) {
   g_autoptr(FlMethodResponse) response = get_platform_version();
   ASSERT_NE(response, nullptr);
@@ -27,5 +63,383 @@ TEST(PlatformVersionPlugin, GetPlatformVersion) {
   EXPECT_THAT(fl_value_get_string(result), testing::StartsWith("Linux "));
 }
 
+TEST(PlatformVersionPlugin, GetDeviceInfoReusesStaticSnapshot) {
+  g_autoptr(GObject) plugin =
+      G_OBJECT(g_object_new(platform_version_plugin_get_type(), nullptr));
+  PlatformVersionPlugin* self = reinterpret_cast<PlatformVersionPlugin*>(plugin);
+
+  g_autoptr(FlMethodResponse) first = get_device_info(self, nullptr);
+  g_autoptr(FlMethodResponse) second = get_device_info(self, nullptr);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(first));
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(second));
+  FlValue* a = fl_method_success_response_get_result(
+      FL_METHOD_SUCCESS_RESPONSE(first));
+  FlValue* b = fl_method_success_response_get_result(
+      FL_METHOD_SUCCESS_RESPONSE(second));
+
+  // Static fields come from the cached snapshot and must not change.
+  EXPECT_STREQ(fl_value_get_string(fl_value_lookup_string(a, "cpuModel")),
+               fl_value_get_string(fl_value_lookup_string(b, "cpuModel")));
+  EXPECT_STREQ(
+      fl_value_get_string(fl_value_lookup_string(a, "stableDeviceId")),
+      fl_value_get_string(fl_value_lookup_string(b, "stableDeviceId")));
+  // Dynamic fields are still present on every call.
+  EXPECT_NE(fl_value_lookup_string(b, "freeRam"), nullptr);
+  EXPECT_NE(fl_value_lookup_string(b, "uptime"), nullptr);
+}
+
+TEST(PlatformVersionPlugin, GetDeviceInfoReturnsOnlyRequestedKeys) {
+  g_autoptr(GObject) plugin =
+      G_OBJECT(g_object_new(platform_version_plugin_get_type(), nullptr));
+  PlatformVersionPlugin* self = reinterpret_cast<PlatformVersionPlugin*>(plugin);
+
+  g_autoptr(FlValue) keys = fl_value_new_list();
+  fl_value_append_take(keys, fl_value_new_string("freeRam"));
+  fl_value_append_take(keys, fl_value_new_string("numberOfProcessors"));
+  fl_value_append_take(keys, fl_value_new_string("noSuchKey"));
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string(args, "keys", keys);
+
+  g_autoptr(FlMethodResponse) response = get_device_info(self, args);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(response));
+  FlValue* result = fl_method_success_response_get_result(
+      FL_METHOD_SUCCESS_RESPONSE(response));
+  EXPECT_EQ(fl_value_get_length(result), 2u);
+  EXPECT_NE(fl_value_lookup_string(result, "freeRam"), nullptr);
+  EXPECT_NE(fl_value_lookup_string(result, "numberOfProcessors"), nullptr);
+  EXPECT_EQ(fl_value_lookup_string(result, "cpuModel"), nullptr);
+}
+
+// Little-endian readers for the getDeviceInfoRecord layout.
+static uint32_t record_u32(const uint8_t* bytes, size_t offset) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; i--) value = (value << 8) | bytes[offset + i];
+  return value;
+}
+
+static int64_t record_i64(const uint8_t* bytes, size_t offset) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; i--) value = (value << 8) | bytes[offset + i];
+  return static_cast<int64_t>(value);
+}
+
+TEST(PlatformVersionPlugin, GetDeviceInfoRecordMatchesTheDocumentedLayout) {
+  g_autoptr(GObject) plugin =
+      G_OBJECT(g_object_new(platform_version_plugin_get_type(), nullptr));
+  PlatformVersionPlugin* self = reinterpret_cast<PlatformVersionPlugin*>(plugin);
+
+  g_autoptr(FlMethodResponse) response = get_device_info_record(self);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(response));
+  FlValue* result = fl_method_success_response_get_result(
+      FL_METHOD_SUCCESS_RESPONSE(response));
+  ASSERT_EQ(fl_value_get_type(result), FL_VALUE_TYPE_UINT8_LIST);
+  const uint8_t* bytes = fl_value_get_uint8_list(result);
+  size_t length = fl_value_get_length(result);
+
+  ASSERT_GE(length, 8u);
+  EXPECT_EQ(bytes[0], 1);
+  const size_t int_count = bytes[1];
+  const size_t string_count = bytes[2];
+  EXPECT_EQ(int_count, 9u);
+  EXPECT_EQ(string_count, 10u);
+  EXPECT_EQ(bytes[3], 0);
+  EXPECT_EQ(record_u32(bytes, 4), length);
+
+  // numberOfProcessors is the last int field.
+  EXPECT_GT(record_i64(bytes, 8), 0);
+  EXPECT_EQ(record_i64(bytes, 8 + 8 * 8), sysconf(_SC_NPROCESSORS_ONLN));
+
+  const size_t table_offset = 8 + int_count * 8;
+  std::vector<std::string> strings;
+  for (size_t i = 0; i < string_count; i++) {
+    uint32_t offset = record_u32(bytes, table_offset + i * 8);
+    uint32_t size = record_u32(bytes, table_offset + i * 8 + 4);
+    ASSERT_GE(offset, table_offset + string_count * 8);
+    ASSERT_LE(offset + size, length);
+    strings.emplace_back(reinterpret_cast<const char*>(bytes) + offset, size);
+  }
+  struct utsname uname_data = {};
+  ASSERT_EQ(uname(&uname_data), 0);
+  EXPECT_EQ(strings[1], uname_data.sysname);
+  EXPECT_EQ(strings[2], uname_data.nodename);
+  EXPECT_EQ(strings[5], uname_data.machine);
+  EXPECT_EQ(strings[6], strings[2]);
+
+  // Only the probes behind the record's fields run.
+  g_autoptr(FlMethodResponse) metrics = get_plugin_metrics(self, nullptr);
+  FlValue* probes = fl_value_lookup_string(
+      fl_method_success_response_get_result(
+          FL_METHOD_SUCCESS_RESPONSE(metrics)),
+      "probes");
+  EXPECT_NE(fl_value_lookup_string(probes, "sysinfo"), nullptr);
+  for (const char* name : {"meminfo", "affinity", "cgroup", "cgroupPaths"}) {
+    EXPECT_EQ(fl_value_lookup_string(probes, name), nullptr) << name;
+  }
+}
+
+TEST(PlatformVersionPlugin, BatchRunsCallsInOrderAndReportsErrorsPerCall) {
+  g_autoptr(GObject) plugin =
+      G_OBJECT(g_object_new(platform_version_plugin_get_type(), nullptr));
+  PlatformVersionPlugin* self = reinterpret_cast<PlatformVersionPlugin*>(plugin);
+
+  g_autoptr(FlValue) calls = fl_value_new_list();
+  FlValue* version = fl_value_new_map();
+  fl_value_set_string_take(version, "method",
+                           fl_value_new_string("getPlatformVersion"));
+  fl_value_append_take(calls, version);
+  FlValue* device_info = fl_value_new_map();
+  fl_value_set_string_take(device_info, "method",
+                           fl_value_new_string("getDeviceInfo"));
+  FlValue* keys = fl_value_new_list();
+  fl_value_append_take(keys, fl_value_new_string("availableRam"));
+  FlValue* device_info_args = fl_value_new_map();
+  fl_value_set_string_take(device_info_args, "keys", keys);
+  fl_value_set_string_take(device_info, "arguments", device_info_args);
+  fl_value_append_take(calls, device_info);
+  FlValue* unknown = fl_value_new_map();
+  fl_value_set_string_take(unknown, "method", fl_value_new_string("noSuchMethod"));
+  fl_value_append_take(calls, unknown);
+  FlValue* nested = fl_value_new_map();
+  fl_value_set_string_take(nested, "method", fl_value_new_string("batch"));
+  fl_value_append_take(calls, nested);
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string(args, "calls", calls);
+
+  g_autoptr(FlMethodResponse) response = batch(self, args);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(response));
+  FlValue* replies = fl_method_success_response_get_result(
+      FL_METHOD_SUCCESS_RESPONSE(response));
+  ASSERT_EQ(fl_value_get_length(replies), 4u);
+
+  FlValue* first = fl_value_lookup_string(
+      fl_value_get_list_value(replies, 0), "result");
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(fl_value_get_type(first), FL_VALUE_TYPE_STRING);
+  FlValue* second = fl_value_lookup_string(
+      fl_value_get_list_value(replies, 1), "result");
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(fl_value_get_length(second), 1u);
+  EXPECT_NE(fl_value_lookup_string(fl_value_get_list_value(replies, 2),
+                                   "notImplemented"),
+            nullptr);
+  EXPECT_NE(fl_value_lookup_string(fl_value_get_list_value(replies, 3), "error"),
+            nullptr);
+}
+
+TEST(PlatformVersionPlugin, PluginMetricsCountCallsAndProbesUntilReset) {
+  g_autoptr(GObject) plugin =
+      G_OBJECT(g_object_new(platform_version_plugin_get_type(), nullptr));
+  PlatformVersionPlugin* self = reinterpret_cast<PlatformVersionPlugin*>(plugin);
+
+  g_autoptr(FlValue) calls = fl_value_new_list();
+  for (const char* method : {"getMemoryInfo", "getMemoryInfo", "noSuchMethod"}) {
+    FlValue* call = fl_value_new_map();
+    fl_value_set_string_take(call, "method", fl_value_new_string(method));
+    fl_value_append_take(calls, call);
+  }
+  g_autoptr(FlValue) batch_args = fl_value_new_map();
+  fl_value_set_string(batch_args, "calls", calls);
+  g_autoptr(FlMethodResponse) batch_response = batch(self, batch_args);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(batch_response));
+
+  g_autoptr(FlValue) reset_args = fl_value_new_map();
+  fl_value_set_string_take(reset_args, "reset", fl_value_new_bool(true));
+  g_autoptr(FlMethodResponse) response = get_plugin_metrics(self, reset_args);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(response));
+  FlValue* result = fl_method_success_response_get_result(
+      FL_METHOD_SUCCESS_RESPONSE(response));
+
+  FlValue* methods = fl_value_lookup_string(result, "methods");
+  FlValue* memory = fl_value_lookup_string(methods, "getMemoryInfo");
+  ASSERT_NE(memory, nullptr);
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup_string(memory, "count")), 2);
+  EXPECT_LE(fl_value_get_float(fl_value_lookup_string(memory, "p50Us")),
+            fl_value_get_float(fl_value_lookup_string(memory, "maxUs")));
+  FlValue* other = fl_value_lookup_string(methods, "other");
+  ASSERT_NE(other, nullptr);
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup_string(other, "count")), 1);
+  EXPECT_EQ(fl_value_lookup_string(methods, "getDeviceInfo"), nullptr);
+
+  // The batch shares one /proc/meminfo read between both calls.
+  FlValue* meminfo = fl_value_lookup_string(
+      fl_value_lookup_string(result, "probes"), "meminfo");
+  ASSERT_NE(meminfo, nullptr);
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup_string(meminfo, "count")), 1);
+
+  g_autoptr(FlMethodResponse) after_reset = get_plugin_metrics(self, nullptr);
+  FlValue* after = fl_method_success_response_get_result(
+      FL_METHOD_SUCCESS_RESPONSE(after_reset));
+  EXPECT_EQ(fl_value_get_length(fl_value_lookup_string(after, "methods")), 0u);
+  EXPECT_EQ(fl_value_get_length(fl_value_lookup_string(after, "probes")), 0u);
+}
+
+TEST(PlatformVersionPlugin, GetProcessInfoReportsDeltasFromTheSecondCall) {
+  g_autoptr(GObject) plugin =
+      G_OBJECT(g_object_new(platform_version_plugin_get_type(), nullptr));
+  PlatformVersionPlugin* self = reinterpret_cast<PlatformVersionPlugin*>(plugin);
+
+  g_autoptr(FlMethodResponse) first = get_process_info(self, nullptr);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(first));
+  FlValue* first_result =
+      fl_method_success_response_get_result(FL_METHOD_SUCCESS_RESPONSE(first));
+  EXPECT_GT(fl_value_get_int(fl_value_lookup_string(first_result, "rss")), 0);
+  EXPECT_GE(fl_value_get_int(fl_value_lookup_string(first_result, "threads")),
+            1);
+  EXPECT_EQ(fl_value_lookup_string(first_result, "pss"), nullptr);
+  EXPECT_EQ(fl_value_lookup_string(first_result, "deltas"), nullptr);
+
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, "pss", fl_value_new_bool(true));
+  g_autoptr(FlMethodResponse) second = get_process_info(self, args);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(second));
+  FlValue* second_result =
+      fl_method_success_response_get_result(FL_METHOD_SUCCESS_RESPONSE(second));
+  FlValue* deltas = fl_value_lookup_string(second_result, "deltas");
+  ASSERT_NE(deltas, nullptr);
+  EXPECT_GE(fl_value_get_float(fl_value_lookup_string(deltas, "intervalMs")),
+            0.0);
+  EXPECT_GE(fl_value_get_int(fl_value_lookup_string(deltas, "minorFaults")), 0);
+  // Only the second sample has PSS, so there is no PSS delta yet.
+  EXPECT_EQ(fl_value_lookup_string(deltas, "pss"), nullptr);
+}
+
+TEST(PlatformVersionPlugin, GetThreadCpuUsageListsThreadsByName) {
+  g_autoptr(GObject) plugin =
+      G_OBJECT(g_object_new(platform_version_plugin_get_type(), nullptr));
+  PlatformVersionPlugin* self = reinterpret_cast<PlatformVersionPlugin*>(plugin);
+
+  g_autoptr(FlMethodResponse) first = get_thread_cpu_usage(self);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(first));
+  g_autoptr(FlMethodResponse) second = get_thread_cpu_usage(self);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(second));
+  FlValue* result =
+      fl_method_success_response_get_result(FL_METHOD_SUCCESS_RESPONSE(second));
+  EXPECT_GT(fl_value_get_float(fl_value_lookup_string(result, "intervalMs")),
+            0.0);
+  FlValue* threads = fl_value_lookup_string(result, "threads");
+  FlValue* main_thread = nullptr;
+  for (size_t i = 0; i < fl_value_get_length(threads); i++) {
+    FlValue* thread = fl_value_get_list_value(threads, i);
+    if (fl_value_get_int(fl_value_lookup_string(thread, "tid")) == getpid()) {
+      main_thread = thread;
+    }
+  }
+  ASSERT_NE(main_thread, nullptr);
+  EXPECT_EQ(fl_value_get_type(fl_value_lookup_string(main_thread, "name")),
+            FL_VALUE_TYPE_STRING);
+  EXPECT_EQ(strlen(fl_value_get_string(
+                fl_value_lookup_string(main_thread, "state"))),
+            1u);
+  EXPECT_NE(fl_value_lookup_string(
+                fl_value_lookup_string(main_thread, "deltas"), "cpuPercent"),
+            nullptr);
+}
+
+TEST(PlatformVersionPlugin, ConfigureDispatchRejectsNonMapArguments) {
+  g_autoptr(GObject) plugin =
+      G_OBJECT(g_object_new(platform_version_plugin_get_type(), nullptr));
+  PlatformVersionPlugin* self = reinterpret_cast<PlatformVersionPlugin*>(plugin);
+
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, "async", fl_value_new_bool(false));
+  fl_value_set_string_take(args, "maxThreads", fl_value_new_int(4));
+  g_autoptr(FlMethodResponse) ok = configure_dispatch(self, args);
+  EXPECT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(ok));
+
+  g_autoptr(FlValue) bad_args = fl_value_new_int(1);
+  g_autoptr(FlMethodResponse) error = configure_dispatch(self, bad_args);
+  EXPECT_TRUE(FL_IS_METHOD_ERROR_RESPONSE(error));
+}
+
+TEST(PlatformVersionPlugin, SampleTelemetryReportsDynamicFieldsOnly) {
+  g_autoptr(FlValue) sample = sample_telemetry();
+  ASSERT_NE(sample, nullptr);
+  ASSERT_EQ(fl_value_get_type(sample), FL_VALUE_TYPE_MAP);
+  EXPECT_NE(fl_value_lookup_string(sample, "freeRam"), nullptr);
+  EXPECT_NE(fl_value_lookup_string(sample, "load1"), nullptr);
+  EXPECT_EQ(fl_value_lookup_string(sample, "cpuModel"), nullptr);
+}
+
+TEST(PlatformVersionFfi, ServesCachedSnapshotAndRequestedDynamicGroups) {
+  EXPECT_EQ(pv_abi_version(), static_cast<uint32_t>(PV_ABI_VERSION));
+  EXPECT_EQ(pv_get_snapshot(nullptr), -1);
+
+  pv_snapshot first;
+  pv_snapshot second;
+  memset(&first, 0xff, sizeof(first));
+  ASSERT_EQ(pv_get_snapshot(&first), 0);
+  ASSERT_EQ(pv_get_snapshot(&second), 0);
+  EXPECT_EQ(memcmp(&first, &second, sizeof(first)), 0);
+
+  struct utsname uname_data = {};
+  ASSERT_EQ(uname(&uname_data), 0);
+  EXPECT_STREQ(first.machine, uname_data.machine);
+  EXPECT_EQ(first.number_of_processors, sysconf(_SC_NPROCESSORS_ONLN));
+  EXPECT_NE(memchr(first.version, '\0', sizeof(first.version)), nullptr);
+  EXPECT_GT(strlen(first.cpu_model), 0u);
+
+  pv_dynamic dynamic;
+  EXPECT_EQ(pv_sample_dynamic(&dynamic, PV_DYNAMIC_SYSINFO),
+            static_cast<uint32_t>(PV_DYNAMIC_SYSINFO));
+  EXPECT_GT(dynamic.total_ram, 0);
+  EXPECT_GT(dynamic.processes, 0);
+  EXPECT_EQ(dynamic.available_ram, 0);
+
+  const uint32_t all = PV_DYNAMIC_SYSINFO | PV_DYNAMIC_MEMINFO;
+  EXPECT_EQ(pv_sample_dynamic(&dynamic, all), all);
+  EXPECT_EQ(dynamic.fields, all);
+  EXPECT_GT(dynamic.available_ram, 0);
+}
+
+TEST(PlatformVersionFfi, SharesSnapshotAndSamplerWithThePlugin) {
+  g_autoptr(GObject) plugin =
+      G_OBJECT(g_object_new(platform_version_plugin_get_type(), nullptr));
+  PlatformVersionPlugin* self = reinterpret_cast<PlatformVersionPlugin*>(plugin);
+
+  g_autoptr(FlMethodResponse) info = get_device_info(self, nullptr);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(info));
+  FlValue* result =
+      fl_method_success_response_get_result(FL_METHOD_SUCCESS_RESPONSE(info));
+  pv_snapshot snapshot;
+  ASSERT_EQ(pv_get_snapshot(&snapshot), 0);
+  EXPECT_STREQ(snapshot.cpu_model,
+               fl_value_get_string(fl_value_lookup_string(result, "cpuModel")));
+
+  // A long interval keeps the sampler from refreshing between the reads.
+  g_autoptr(FlValue) args = fl_value_new_map();
+  g_autoptr(FlValue) metrics = fl_value_new_list();
+  fl_value_append_take(metrics, fl_value_new_string("meminfo"));
+  fl_value_set_string(args, "metrics", metrics);
+  fl_value_set_string_take(args, "intervalMs", fl_value_new_int(60000));
+  g_autoptr(FlMethodResponse) configured = configure_sampler(self, args);
+  ASSERT_TRUE(FL_IS_METHOD_SUCCESS_RESPONSE(configured));
+
+  FlValue* sampled = nullptr;
+  g_autoptr(FlMethodResponse) response = nullptr;
+  for (int attempt = 0; attempt < 200 && sampled == nullptr; attempt++) {
+    g_clear_object(&response);
+    response = get_sampled_metrics(self);
+    FlValue* sample = fl_method_success_response_get_result(
+        FL_METHOD_SUCCESS_RESPONSE(response));
+    // The response is null until the sampler thread publishes its first sample.
+    if (fl_value_get_type(sample) == FL_VALUE_TYPE_MAP) {
+      sampled = fl_value_lookup_string(sample, "availableRam");
+    }
+    if (sampled == nullptr) g_usleep(10000);
+  }
+  ASSERT_NE(sampled, nullptr);
+
+  pv_dynamic dynamic;
+  ASSERT_EQ(pv_sample_dynamic(&dynamic, PV_DYNAMIC_MEMINFO),
+            static_cast<uint32_t>(PV_DYNAMIC_MEMINFO));
+  EXPECT_EQ(dynamic.available_ram, fl_value_get_int(sampled));
+
+  // Once the plugin is gone the C ABI reads /proc/meminfo itself again.
+  g_clear_object(&plugin);
+  EXPECT_EQ(pv_sample_dynamic(&dynamic, PV_DYNAMIC_MEMINFO),
+            static_cast<uint32_t>(PV_DYNAMIC_MEMINFO));
+  EXPECT_GT(dynamic.available_ram, 0);
+}
+
 }  // namespace test
 }  // namespace platform_version
@@ -0,0 +1,270 @@
+// Runs the getDeviceInfo probes outside Flutter and prints their results as
+// JSON, so the plugin's native code can be profiled with perf, heaptrack or
+// valgrind on machines without a display or a Flutter toolchain.
+//
+// $ platform_version_cli                        # every probe, once
+// $ platform_version_cli --probe meminfo,cgroup --repeat 100000
+// $ perf record -g platform_version_cli --repeat 1000000 --probe sysinfo
+// $ platform_version_cli -r src/test/fixtures/sysroot/epyc_256_thread -cn 1000
+//
+// The result of the last run goes to stdout. With --repeat, per-probe and
+// per-run latencies go to stderr as JSON in the getPluginMetrics format.
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <memory>
+#include <string>
+
+#include "cpu_affinity.h"
+#include "device_info.h"
+#include "latency_histogram.h"
+#include "meminfo.h"
+#include "string_util.h"
+#include "sysroot.h"
+#include "trace_recorder.h"
+
+static const char kUsage[] =
+    "Usage: platform_version_cli [options]\n"
+    "\n"
+    "Runs the platform_version getDeviceInfo probes and prints the result\n"
+    "as JSON.\n"
+    "\n"
+    "  -p, --probe NAMES    comma-separated probes to run (default: all)\n"
+    "  -l, --list           list the probes and exit\n"
+    "  -n, --repeat N       run the probes N times and report timings\n"
+    "  -i, --interval MS    sleep MS milliseconds between runs (default: 0)\n"
+    "  -c, --cold           re-run the static probes on every run instead of\n"
+    "                       caching them after the first, as the plugin does\n"
+    "  -t, --trace PATH     write a Chrome trace of the runs to PATH\n"
+    "  -r, --sysroot DIR    read /proc, /sys and /etc under DIR, such as a\n"
+    "                       recorded host (default: $"
+    PLATFORM_VERSION_SYSROOT_ENV ", or /)\n"
+    "  -h, --help           show this help\n";
+
+// Prints the keys produced by [probes], plus the NUMA nodes and CPU topology
+// summary that getDeviceInfo has no keys for.
+static void print_results(const DeviceInfoProbeResults& results,
+                          unsigned probes) {
+  DeviceInfo info;
+  device_info_collect(results, probes, &info);
+  printf("{");
+  const char* separator = "";
+  DeviceInfoValue value;
+  for (const DeviceInfoField& field : kDeviceInfoFields) {
+    if (!device_info_get(info, field, &value)) continue;
+    printf("%s\n  \"%s\": ", separator, field.key);
+    if (value.string != nullptr) {
+      json_write_string(stdout, value.string);
+    } else {
+      printf("%lld", static_cast<long long>(value.number));
+    }
+    separator = ",";
+  }
+
+  if (probes & kProbeNumaNodes) {
+    printf("%s\n  \"numaNodes\": [", separator);
+    const char* node_separator = "";
+    for (const NumaNode& node : results.snapshot->numa_nodes) {
+      printf("%s{\"node\": %d, \"cpuList\": \"%s\"}", node_separator, node.node,
+             cpulist_format(node.cpus).c_str());
+      node_separator = ", ";
+    }
+    printf("]");
+    separator = ",";
+  }
+
+  if (probes & kProbeCpuTopology) {
+    const CpuTopology& topology = results.snapshot->cpu_topology;
+    printf("%s\n  \"cpuTopology\": {\"packages\": %d, \"cores\": %d, "
+           "\"logicalProcessors\": %zu, \"threadsPerCore\": %d, "
+           "\"hybrid\": %s}",
+           separator, topology.packages, topology.cores, topology.cpus.size(),
+           topology.threads_per_core, topology.hybrid ? "true" : "false");
+  }
+  printf("\n}\n");
+}
+
+// Prints [histogram] as a getPluginMetrics entry, or nothing if it is empty.
+static bool print_stats(const char* separator,
+                        const char* name,
+                        const LatencyHistogram* histogram) {
+  LatencyStats stats;
+  latency_histogram_stats(histogram, &stats);
+  if (stats.count == 0) return false;
+  fprintf(stderr,
+          "%s\n    \"%s\": {\"count\": %llu, \"errors\": %llu, "
+          "\"meanUs\": %.3f, \"p50Us\": %.3f, \"p90Us\": %.3f, "
+          "\"p99Us\": %.3f, \"maxUs\": %.3f}",
+          separator, name, static_cast<unsigned long long>(stats.count),
+          static_cast<unsigned long long>(stats.errors), stats.mean_ns / 1000.0,
+          stats.p50_ns / 1000.0, stats.p90_ns / 1000.0, stats.p99_ns / 1000.0,
+          stats.max_ns / 1000.0);
+  return true;
+}
+
+static void print_timings(const LatencyHistogram& runs,
+                          const LatencyHistogram* probes,
+                          uint64_t period_ns) {
+  fprintf(stderr, "{\n  \"periodUs\": %.3f,\n  \"runs\": {",
+          period_ns / 1000.0);
+  print_stats("", "all", &runs);
+  fprintf(stderr, "\n  },\n  \"probes\": {");
+  const char* separator = "";
+  for (size_t i = 0; i < kProbeCount; i++) {
+    if (print_stats(separator, kProbeNames[i], &probes[i])) separator = ",";
+  }
+  fprintf(stderr, "\n  }\n}\n");
+}
+
+// Parses a comma-separated list of probe names into [probes].
+static bool parse_probes(const char* names, unsigned* probes) {
+  *probes = 0;
+  std::string list = names;
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t end = list.find(',', start);
+    if (end == std::string::npos) end = list.size();
+    std::string name = list.substr(start, end - start);
+    if (name == "all") {
+      *probes |= kAllProbes;
+    } else {
+      size_t i = 0;
+      while (i < kProbeCount && name != kProbeNames[i]) i++;
+      if (i == kProbeCount) {
+        fprintf(stderr, "platform_version_cli: unknown probe \"%s\"\n",
+                name.c_str());
+        return false;
+      }
+      *probes |= 1u << i;
+    }
+    start = end + 1;
+  }
+  return true;
+}
+
+static bool parse_count(const char* text, unsigned long* value) {
+  char* end = nullptr;
+  *value = strtoul(text, &end, 10);
+  return *text != '\0' && *text != '-' && *end == '\0';
+}
+
+int main(int argc, char** argv) {
+  static const struct option kOptions[] = {
+      {"probe", required_argument, nullptr, 'p'},
+      {"list", no_argument, nullptr, 'l'},
+      {"repeat", required_argument, nullptr, 'n'},
+      {"interval", required_argument, nullptr, 'i'},
+      {"cold", no_argument, nullptr, 'c'},
+      {"trace", required_argument, nullptr, 't'},
+      {"sysroot", required_argument, nullptr, 'r'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0},
+  };
+
+  unsigned probes = kAllProbes;
+  unsigned long repeat = 1;
+  unsigned long interval_ms = 0;
+  bool repeating = false;
+  bool cold = false;
+  const char* trace_path = nullptr;
+  std::string sysroot = sysroot_from_environment();
+  int option;
+  while ((option = getopt_long(argc, argv, "p:ln:i:ct:r:h", kOptions,
+                               nullptr)) != -1) {
+    switch (option) {
+      case 'p':
+        if (!parse_probes(optarg, &probes)) return 2;
+        break;
+      case 'l':
+        for (size_t i = 0; i < kProbeCount; i++) puts(kProbeNames[i]);
+        return 0;
+      case 'n':
+        if (!parse_count(optarg, &repeat) || repeat == 0) {
+          fprintf(stderr, "platform_version_cli: invalid --repeat \"%s\"\n",
+                  optarg);
+          return 2;
+        }
+        repeating = true;
+        break;
+      case 'i':
+        if (!parse_count(optarg, &interval_ms)) {
+          fprintf(stderr, "platform_version_cli: invalid --interval \"%s\"\n",
+                  optarg);
+          return 2;
+        }
+        break;
+      case 'c':
+        cold = true;
+        break;
+      case 't':
+        trace_path = optarg;
+        break;
+      case 'r':
+        sysroot = optarg;
+        while (!sysroot.empty() && sysroot.back() == '/') sysroot.pop_back();
+        break;
+      case 'h':
+        fputs(kUsage, stdout);
+        return 0;
+      default:
+        fputs(kUsage, stderr);
+        return 2;
+    }
+  }
+  if (optind < argc) {
+    fputs(kUsage, stderr);
+    return 2;
+  }
+
+  if (trace_path != nullptr) trace_recorder_set_enabled(true);
+
+  MemInfoReader meminfo_reader;
+  meminfo_reader_open(&meminfo_reader,
+                      sysroot_path(sysroot.c_str(), "/proc/meminfo").path,
+                      sysroot_path(sysroot.c_str(), "/proc/vmstat").path);
+  std::unique_ptr<LatencyHistogram[]> histograms(
+      new LatencyHistogram[kProbeCount]());
+  std::unique_ptr<LatencyHistogram> runs(new LatencyHistogram());
+  auto snapshot = std::make_unique<DeviceSnapshot>();
+  DeviceInfoProbeResults results = {};
+
+  const struct timespec interval = {
+      static_cast<time_t>(interval_ms / 1000),
+      static_cast<long>(interval_ms % 1000) * 1000000,
+  };
+  const uint64_t start_ns = latency_now_ns();
+  for (unsigned long run = 0; run < repeat; run++) {
+    if (run > 0 && interval_ms > 0) nanosleep(&interval, nullptr);
+    if (cold && run > 0) snapshot = std::make_unique<DeviceSnapshot>();
+
+    TraceScope trace("cli", "run");
+    uint64_t run_start_ns = latency_now_ns();
+    DeviceInfoProbeContext context = {snapshot.get(), histograms.get(),
+                                      &meminfo_reader, nullptr,
+                                      sysroot.c_str()};
+    results = {};
+    device_info_run_probes(context, probes, &results);
+    latency_histogram_record(runs.get(), latency_now_ns() - run_start_ns,
+                             false);
+  }
+  const uint64_t period_ns = latency_now_ns() - start_ns;
+
+  print_results(results, probes);
+  if (repeating) print_timings(*runs, histograms.get(), period_ns);
+  meminfo_reader_close(&meminfo_reader);
+
+  if (trace_path != nullptr) {
+    trace_recorder_set_enabled(false);
+    if (trace_recorder_dump(trace_path, true) < 0) {
+      fprintf(stderr, "platform_version_cli: cannot write %s: %s\n",
+              trace_path, strerror(errno));
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -15,6 +15,8 @@ public class PlatformVersionPlugin: NSObject, FlutterPlugin {
       result("macOS " + ProcessInfo.processInfo.operatingSystemVersionString)
     case "getDeviceInfo":
       result(getDeviceInfo())
+    case "getStableDeviceId":
+      result(getOrCreateStableDeviceId())
     default:
       result(FlutterMethodNotImplemented)
     }
@@ -0,0 +1,330 @@
+#include "cgroup.h"
+
+#include <unistd.h>
+
+#include "proc_parser.h"
+#include "string_util.h"
+
+// Legacy memory controllers report "no limit" as the largest page-aligned
+// counter value; treat anything this large as unlimited.
+static const unsigned long long kCgroupV1UnlimitedBytes = 1ULL << 62;
+
+// Whether the [separator]-separated [list] contains [item].
+static bool list_contains(std::string_view list,
+                          std::string_view item,
+                          char separator) {
+  while (!list.empty()) {
+    size_t end = list.find(separator);
+    if (list.substr(0, end) == item) return true;
+    if (end == std::string_view::npos) break;
+    list.remove_prefix(end + 1);
+  }
+  return false;
+}
+
+bool cgroup_parse_membership_line(std::string_view line,
+                                  std::string_view* controllers,
+                                  std::string_view* path) {
+  size_t first = line.find(':');
+  if (first == std::string_view::npos) return false;
+  size_t second = line.find(':', first + 1);
+  if (second == std::string_view::npos) return false;
+  *controllers = line.substr(first + 1, second - first - 1);
+  *path = line.substr(second + 1);
+  return true;
+}
+
+bool cgroup_parse_mountinfo_line(std::string_view line,
+                                 std::string_view* root,
+                                 std::string_view* mount_point,
+                                 std::string_view* fstype,
+                                 std::string_view* super_options) {
+  // "36 32 0:32 / /sys/fs/cgroup/memory rw,relatime - cgroup cgroup rw,memory"
+  // Fields 4 and 5 are the root and mount point; the optional fields end at
+  // " - ", which is followed by the fstype, source and super options.
+  std::string_view fields[5];
+  std::string_view rest = line;
+  for (std::string_view& field : fields) {
+    size_t end = rest.find(' ');
+    if (end == std::string_view::npos) return false;
+    field = rest.substr(0, end);
+    rest.remove_prefix(end + 1);
+  }
+  size_t separator = rest.find(" - ");
+  if (separator == std::string_view::npos) return false;
+  rest.remove_prefix(separator + 3);
+
+  size_t fstype_end = rest.find(' ');
+  if (fstype_end == std::string_view::npos) return false;
+  size_t source_end = rest.find(' ', fstype_end + 1);
+  if (source_end == std::string_view::npos) return false;
+
+  *root = fields[3];
+  *mount_point = fields[4];
+  *fstype = rest.substr(0, fstype_end);
+  *super_options = rest.substr(source_end + 1);
+  return true;
+}
+
+bool cgroup_parse_cpu_max(std::string_view text,
+                          unsigned long long* quota,
+                          unsigned long long* period) {
+  text = string_trim(text);
+  if (text.substr(0, 3) == "max") {
+    *quota = 0;
+    text.remove_prefix(3);
+  } else if (!proc_next_u64(&text, quota)) {
+    return false;
+  }
+  return proc_next_u64(&text, period);
+}
+
+// Points [controller] at [cgroup_path] inside the hierarchy mounted at
+// [mount_point] under [sysroot] with the given [root].
+static void cgroup_controller_set(CgroupController* controller,
+                                  int version,
+                                  std::string_view cgroup_path,
+                                  std::string_view root,
+                                  const char* sysroot,
+                                  std::string_view mount_point) {
+  // Inside a cgroup namespace the mount root and the membership path are
+  // both relative to the namespace. Without one, a container sees the host
+  // path in /proc/self/cgroup but only its own subtree mounted; strip the
+  // mount root so the two line up.
+  if (root != "/" && cgroup_path.substr(0, root.size()) == root) {
+    cgroup_path.remove_prefix(root.size());
+  }
+  controller->version = version;
+  controller->mount = sysroot != nullptr ? sysroot : "";
+  controller->mount.append(mount_point.data(), mount_point.size());
+  controller->dir = controller->mount;
+  if (!cgroup_path.empty() && cgroup_path != "/") {
+    if (cgroup_path.front() != '/') controller->dir += '/';
+    controller->dir.append(cgroup_path.data(), cgroup_path.size());
+  }
+  // A path that is not in the mounted subtree means we cannot see our own
+  // cgroup; fall back to the mount point, which is the closest ancestor.
+  if (access(controller->dir.c_str(), F_OK) != 0) {
+    controller->dir = controller->mount;
+  }
+}
+
+// Whether the unified hierarchy at [mount] has [controller] enabled.
+static bool cgroup_v2_has_controller(const std::string& mount,
+                                     std::string_view controller) {
+  ProcLineReader reader;
+  std::string path = mount + "/cgroup.controllers";
+  if (!proc_line_reader_open(&reader, path.c_str())) return false;
+  std::string_view line;
+  bool found = proc_line_reader_next(&reader, &line) &&
+               list_contains(string_trim(line), controller, ' ');
+  proc_line_reader_close(&reader);
+  return found;
+}
+
+bool cgroup_resolve(const char* cgroup_path,
+                    const char* mountinfo_path,
+                    const char* sysroot,
+                    CgroupPaths* paths) {
+  *paths = {};
+
+  // Membership paths, copied out because the reader's buffer is reused.
+  std::string unified_path, cpu_path, memory_path;
+  bool has_unified = false, has_cpu = false, has_memory = false;
+
+  ProcLineReader reader;
+  if (!proc_line_reader_open(&reader, cgroup_path)) return false;
+  std::string_view line, controllers, path;
+  while (proc_line_reader_next(&reader, &line)) {
+    if (!cgroup_parse_membership_line(line, &controllers, &path)) continue;
+    if (controllers.empty()) {
+      unified_path.assign(path.data(), path.size());
+      has_unified = true;
+    }
+    if (list_contains(controllers, "cpu", ',')) {
+      cpu_path.assign(path.data(), path.size());
+      has_cpu = true;
+    }
+    if (list_contains(controllers, "memory", ',')) {
+      memory_path.assign(path.data(), path.size());
+      has_memory = true;
+    }
+  }
+  proc_line_reader_close(&reader);
+
+  CgroupController unified;
+  if (!proc_line_reader_open(&reader, mountinfo_path)) return false;
+  std::string_view root, mount_point, fstype, options;
+  while (proc_line_reader_next(&reader, &line)) {
+    if (!cgroup_parse_mountinfo_line(line, &root, &mount_point, &fstype,
+                                     &options)) {
+      continue;
+    }
+    if (fstype == "cgroup2") {
+      if (has_unified && unified.version == 0) {
+        cgroup_controller_set(&unified, 2, unified_path, root, sysroot,
+                              mount_point);
+      }
+    } else if (fstype == "cgroup") {
+      if (has_cpu && paths->cpu.version == 0 &&
+          list_contains(options, "cpu", ',')) {
+        cgroup_controller_set(&paths->cpu, 1, cpu_path, root, sysroot,
+                              mount_point);
+      }
+      if (has_memory && paths->memory.version == 0 &&
+          list_contains(options, "memory", ',')) {
+        cgroup_controller_set(&paths->memory, 1, memory_path, root, sysroot,
+                              mount_point);
+      }
+    }
+  }
+  proc_line_reader_close(&reader);
+
+  if (unified.version != 0) {
+    if (paths->cpu.version == 0 &&
+        cgroup_v2_has_controller(unified.mount, "cpu")) {
+      paths->cpu = unified;
+    }
+    if (paths->memory.version == 0 &&
+        cgroup_v2_has_controller(unified.mount, "memory")) {
+      paths->memory = unified;
+    }
+  }
+  return paths->cpu.version != 0 || paths->memory.version != 0;
+}
+
+// Reads the first line of [dir]/[file] into [value]. The view stays valid
+// while [reader] is open.
+static bool cgroup_read_line(ProcLineReader* reader,
+                             const std::string& dir,
+                             const char* file,
+                             std::string_view* value) {
+  std::string path = dir + '/' + file;
+  if (!proc_line_reader_open(reader, path.c_str())) return false;
+  return proc_line_reader_next(reader, value);
+}
+
+static bool cgroup_read_u64(const std::string& dir,
+                            const char* file,
+                            unsigned long long* value) {
+  ProcLineReader reader;
+  std::string_view line;
+  bool ok = cgroup_read_line(&reader, dir, file, &line) &&
+            proc_next_u64(&line, value);
+  proc_line_reader_close(&reader);
+  return ok;
+}
+
+// Reads the CPU quota of [dir] into [quota] and [period]. Returns false if
+// the cgroup has no quota.
+static bool cgroup_read_cpu_quota(const CgroupController& cpu,
+                                  const std::string& dir,
+                                  unsigned long long* quota,
+                                  unsigned long long* period) {
+  if (cpu.version == 2) {
+    ProcLineReader reader;
+    std::string_view line;
+    bool ok = cgroup_read_line(&reader, dir, "cpu.max", &line) &&
+              cgroup_parse_cpu_max(line, quota, period);
+    proc_line_reader_close(&reader);
+    return ok && *quota > 0 && *period > 0;
+  }
+  // cpu.cfs_quota_us is -1 without a quota, which does not parse.
+  return cgroup_read_u64(dir, "cpu.cfs_quota_us", quota) &&
+         cgroup_read_u64(dir, "cpu.cfs_period_us", period) && *quota > 0 &&
+         *period > 0;
+}
+
+static bool cgroup_read_memory_limit(const CgroupController& memory,
+                                     const std::string& dir,
+                                     unsigned long long* limit) {
+  // "max" in memory.max does not parse as a number either.
+  if (memory.version == 2) return cgroup_read_u64(dir, "memory.max", limit);
+  return cgroup_read_u64(dir, "memory.limit_in_bytes", limit) &&
+         *limit < kCgroupV1UnlimitedBytes;
+}
+
+// Moves [dir] to its parent. Returns false once [dir] is the mount point.
+static bool cgroup_parent(const CgroupController& controller,
+                          std::string* dir) {
+  if (dir->size() <= controller.mount.size()) return false;
+  dir->resize(dir->rfind('/'));
+  return dir->size() >= controller.mount.size();
+}
+
+static void cgroup_read_memory_events(const CgroupController& memory,
+                                      CgroupLimits* limits) {
+  ProcLineReader reader;
+  std::string path = memory.dir + (memory.version == 2
+                                       ? "/memory.events"
+                                       : "/memory.oom_control");
+  if (!proc_line_reader_open(&reader, path.c_str())) return;
+  std::string_view line;
+  while (proc_line_reader_next(&reader, &line)) {
+    size_t space = line.find(' ');
+    if (space == std::string_view::npos) continue;
+    std::string_view key = line.substr(0, space);
+    std::string_view value = line.substr(space);
+    unsigned long long* field = nullptr;
+    if (key == "low") {
+      field = &limits->memory_events_low;
+    } else if (key == "high") {
+      field = &limits->memory_events_high;
+    } else if (key == "max") {
+      field = &limits->memory_events_max;
+    } else if (key == "oom") {
+      field = &limits->memory_events_oom;
+    } else if (key == "oom_kill") {
+      field = &limits->memory_events_oom_kill;
+    }
+    if (field != nullptr) proc_next_u64(&value, field);
+  }
+  proc_line_reader_close(&reader);
+}
+
+void cgroup_read_limits(const CgroupPaths& paths, CgroupLimits* limits) {
+  *limits = {};
+
+  // Ancestors constrain their children, so keep the tightest limit found on
+  // the way up to the mount point.
+  if (paths.cpu.version != 0) {
+    std::string dir = paths.cpu.dir;
+    do {
+      unsigned long long quota = 0, period = 0;
+      if (cgroup_read_cpu_quota(paths.cpu, dir, &quota, &period) &&
+          (limits->cpu_quota_us == 0 ||
+           quota * limits->cpu_period_us < limits->cpu_quota_us * period)) {
+        limits->cpu_quota_us = quota;
+        limits->cpu_period_us = period;
+      }
+    } while (cgroup_parent(paths.cpu, &dir));
+  }
+
+  if (paths.memory.version != 0) {
+    std::string dir = paths.memory.dir;
+    do {
+      unsigned long long limit = 0;
+      if (cgroup_read_memory_limit(paths.memory, dir, &limit) &&
+          (limits->memory_limit == 0 || limit < limits->memory_limit)) {
+        limits->memory_limit = limit;
+      }
+    } while (cgroup_parent(paths.memory, &dir));
+
+    cgroup_read_u64(paths.memory.dir,
+                    paths.memory.version == 2 ? "memory.current"
+                                              : "memory.usage_in_bytes",
+                    &limits->memory_usage);
+    cgroup_read_memory_events(paths.memory, limits);
+  }
+}
+
+long cgroup_effective_processors(const CgroupLimits& limits, long available) {
+  long processors = available;
+  if (limits.cpu_quota_us > 0 && limits.cpu_period_us > 0) {
+    long quota_cpus = static_cast<long>(
+        (limits.cpu_quota_us + limits.cpu_period_us - 1) /
+        limits.cpu_period_us);
+    if (quota_cpus < processors) processors = quota_cpus;
+  }
+  return processors > 0 ? processors : 1;
+}
@@ -0,0 +1,83 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_CGROUP_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_CGROUP_H_
+
+#include <string>
+#include <string_view>
+
+// Where one controller of this process's cgroup lives.
+struct CgroupController {
+  // 2 for the unified hierarchy, 1 for a legacy hierarchy, 0 if the
+  // controller is not mounted.
+  int version = 0;
+  // Mount point of the hierarchy.
+  std::string mount;
+  // The process's cgroup directory under [mount].
+  std::string dir;
+};
+
+// The CPU and memory controllers of this process's cgroup. On hybrid systems
+// they may live in different hierarchies.
+struct CgroupPaths {
+  CgroupController cpu;
+  CgroupController memory;
+};
+
+// Limits and usage of the process's cgroup. Limits take every ancestor
+// cgroup into account.
+struct CgroupLimits {
+  // CPU bandwidth: [cpu_quota_us] of CPU time per [cpu_period_us]. Quota is 0
+  // when there is no limit.
+  unsigned long long cpu_quota_us;
+  unsigned long long cpu_period_us;
+
+  // In bytes; [memory_limit] is 0 when there is no limit.
+  unsigned long long memory_limit;
+  unsigned long long memory_usage;
+
+  // memory.events counters. Legacy hierarchies only report oom_kill.
+  unsigned long long memory_events_low;
+  unsigned long long memory_events_high;
+  unsigned long long memory_events_max;
+  unsigned long long memory_events_oom;
+  unsigned long long memory_events_oom_kill;
+};
+
+// Splits a /proc/self/cgroup line, "id:controllers:path", into its
+// comma-separated [controllers] and [path].
+bool cgroup_parse_membership_line(std::string_view line,
+                                  std::string_view* controllers,
+                                  std::string_view* path);
+
+// Pulls the mount [root], [mount_point], [fstype] and [super_options] out of
+// a /proc/self/mountinfo line.
+bool cgroup_parse_mountinfo_line(std::string_view line,
+                                 std::string_view* root,
+                                 std::string_view* mount_point,
+                                 std::string_view* fstype,
+                                 std::string_view* super_options);
+
+// Parses a cgroup v2 cpu.max value, "max 100000" or "50000 100000". [quota]
+// is 0 for "max".
+bool cgroup_parse_cpu_max(std::string_view text,
+                          unsigned long long* quota,
+                          unsigned long long* period);
+
+// Finds the CPU and memory controllers of the process described by the
+// cgroup membership file at [cgroup_path] and the mount table at
+// [mountinfo_path]. Mount points are resolved under [sysroot], which is null
+// or "" for the live system. Legacy controllers win over the unified
+// hierarchy, which is what the kernel enforces on hybrid systems. Returns
+// false if neither controller was found.
+bool cgroup_resolve(const char* cgroup_path,
+                    const char* mountinfo_path,
+                    const char* sysroot,
+                    CgroupPaths* paths);
+
+// Reads the current limits, usage and events of [paths] into [limits].
+void cgroup_read_limits(const CgroupPaths& paths, CgroupLimits* limits);
+
+// The number of CPUs the process can keep busy: [available] capped by the
+// CPU quota, rounded up, and at least 1.
+long cgroup_effective_processors(const CgroupLimits& limits, long available);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_CGROUP_H_
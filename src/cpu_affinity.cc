@@ -0,0 +1,107 @@
+#include "cpu_affinity.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+#include "proc_parser.h"
+#include "string_util.h"
+
+// Largest CPU count to size an affinity mask for; the kernel's NR_CPUS
+// limit is 8192.
+static const int kMaxAffinityCpus = 8192;
+
+bool cpulist_parse(std::string_view text, std::vector<int>* cpus) {
+  cpus->clear();
+  text = string_trim(text);
+  while (!text.empty()) {
+    size_t end = text.find(',');
+    std::string_view range = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+    unsigned long long first = 0, last = 0;
+    if (!proc_next_u64(&range, &first)) return false;
+    last = first;
+    if (!range.empty() && range.front() == '-') {
+      range.remove_prefix(1);
+      if (!proc_next_u64(&range, &last) || last < first) return false;
+    }
+    if (!string_trim(range).empty() || last >= kMaxAffinityCpus) return false;
+    for (unsigned long long cpu = first; cpu <= last; cpu++) {
+      cpus->push_back(static_cast<int>(cpu));
+    }
+  }
+  return true;
+}
+
+std::string cpulist_format(const std::vector<int>& cpus) {
+  std::string text;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) j++;
+    if (!text.empty()) text += ',';
+    text += std::to_string(cpus[i]);
+    if (j > i) {
+      text += '-';
+      text += std::to_string(cpus[j]);
+    }
+    i = j + 1;
+  }
+  return text;
+}
+
+bool cpu_affinity_read(std::vector<int>* cpus) {
+  cpus->clear();
+  // sched_getaffinity() fails with EINVAL while the mask is smaller than the
+  // kernel's, so grow it until it fits.
+  for (int count = CPU_SETSIZE; count <= kMaxAffinityCpus; count *= 2) {
+    cpu_set_t* set = CPU_ALLOC(count);
+    if (set == nullptr) return false;
+    size_t size = CPU_ALLOC_SIZE(count);
+    if (sched_getaffinity(0, size, set) == 0) {
+      for (int cpu = 0; cpu < count; cpu++) {
+        if (CPU_ISSET_S(cpu, size, set)) cpus->push_back(cpu);
+      }
+      CPU_FREE(set);
+      return true;
+    }
+    int error = errno;
+    CPU_FREE(set);
+    if (error != EINVAL) return false;
+  }
+  return false;
+}
+
+long cpu_affinity_count() {
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) return CPU_COUNT(&set);
+  if (errno != EINVAL) return 0;
+  std::vector<int> cpus;
+  return cpu_affinity_read(&cpus) ? static_cast<long>(cpus.size()) : 0;
+}
+
+void numa_read_nodes(const char* node_dir, std::vector<NumaNode>* nodes) {
+  nodes->clear();
+  int dirfd = open(node_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dirfd < 0) return;
+
+  std::vector<int> numbers;
+  sysfs_list_numbered(dirfd, ".", "node", &numbers);
+  // Long enough for the CPU list of a node on any supported machine.
+  char buffer[4096];
+  char path[32];
+  for (int node : numbers) {
+    snprintf(path, sizeof(path), "node%d/cpulist", node);
+    std::string_view line;
+    NumaNode numa_node{node, {}};
+    if (sysfs_read_line_at(dirfd, path, buffer, sizeof(buffer), &line) &&
+        cpulist_parse(line, &numa_node.cpus)) {
+      nodes->push_back(std::move(numa_node));
+    }
+  }
+  close(dirfd);
+}
@@ -0,0 +1,35 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_AFFINITY_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_AFFINITY_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The CPUs of one NUMA node, in ascending order.
+struct NumaNode {
+  int node;
+  std::vector<int> cpus;
+};
+
+// Parses a kernel CPU list such as "0-3,8,10-11" into ascending CPU numbers.
+// Returns false on malformed input; an empty list is valid.
+bool cpulist_parse(std::string_view text, std::vector<int>* cpus);
+
+// Formats ascending CPU numbers as a kernel CPU list, e.g. "0-3,8".
+std::string cpulist_format(const std::vector<int>& cpus);
+
+// Reads the CPUs this process may run on, as set by taskset, systemd's
+// CPUAffinity= or a cpuset cgroup. Handles machines with more CPUs than
+// cpu_set_t holds. Returns false if sched_getaffinity() fails.
+bool cpu_affinity_read(std::vector<int>* cpus);
+
+// The number of CPUs this process may run on, or 0 if sched_getaffinity()
+// fails. Does not allocate on machines with up to CPU_SETSIZE CPUs.
+long cpu_affinity_count();
+
+// Reads the NUMA nodes under [node_dir] (normally /sys/devices/system/node)
+// and their CPUs, ordered by node number. Leaves [nodes] empty on kernels
+// without NUMA support.
+void numa_read_nodes(const char* node_dir, std::vector<NumaNode>* nodes);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_AFFINITY_H_
@@ -0,0 +1,233 @@
+#include "cpu_features.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#elif defined(__aarch64__)
+#include <sys/auxv.h>
+#endif
+
+namespace {
+
+struct CpuFeatureName {
+  CpuFeature feature;
+  const char* name;
+};
+
+const CpuFeatureName kCpuFeatureNames[] = {
+    {kCpuFeatureSse2, "sse2"},
+    {kCpuFeatureSse3, "sse3"},
+    {kCpuFeatureSsse3, "ssse3"},
+    {kCpuFeatureSse41, "sse4_1"},
+    {kCpuFeatureSse42, "sse4_2"},
+    {kCpuFeaturePopcnt, "popcnt"},
+    {kCpuFeatureAes, "aes"},
+    {kCpuFeaturePclmulqdq, "pclmulqdq"},
+    {kCpuFeatureAvx, "avx"},
+    {kCpuFeatureF16c, "f16c"},
+    {kCpuFeatureFma, "fma"},
+    {kCpuFeatureAvx2, "avx2"},
+    {kCpuFeatureBmi1, "bmi1"},
+    {kCpuFeatureBmi2, "bmi2"},
+    {kCpuFeatureLzcnt, "abm"},
+    {kCpuFeatureMovbe, "movbe"},
+    {kCpuFeatureSha, "sha_ni"},
+    {kCpuFeatureAvx512f, "avx512f"},
+    {kCpuFeatureAvx512dq, "avx512dq"},
+    {kCpuFeatureAvx512cd, "avx512cd"},
+    {kCpuFeatureAvx512bw, "avx512bw"},
+    {kCpuFeatureAvx512vl, "avx512vl"},
+    {kCpuFeatureAvx512ifma, "avx512ifma"},
+    {kCpuFeatureAvx512vbmi, "avx512vbmi"},
+    {kCpuFeatureAvx512vbmi2, "avx512_vbmi2"},
+    {kCpuFeatureAvx512vnni, "avx512_vnni"},
+    {kCpuFeatureAvx512bitalg, "avx512_bitalg"},
+    {kCpuFeatureAvx512vpopcntdq, "avx512_vpopcntdq"},
+    {kCpuFeatureAvx512bf16, "avx512_bf16"},
+    {kCpuFeatureAvx512fp16, "avx512_fp16"},
+    {kCpuFeatureAvxVnni, "avx_vnni"},
+    {kCpuFeatureVaes, "vaes"},
+    {kCpuFeatureVpclmulqdq, "vpclmulqdq"},
+    {kCpuFeatureGfni, "gfni"},
+    {kCpuFeatureNeon, "asimd"},
+    {kCpuFeatureArmAes, "aes"},
+    {kCpuFeaturePmull, "pmull"},
+    {kCpuFeatureSha1, "sha1"},
+    {kCpuFeatureSha2, "sha2"},
+    {kCpuFeatureSha3, "sha3"},
+    {kCpuFeatureSha512, "sha512"},
+    {kCpuFeatureCrc32, "crc32"},
+    {kCpuFeatureAtomics, "atomics"},
+    {kCpuFeatureFp16, "asimdhp"},
+    {kCpuFeatureDotProd, "asimddp"},
+    {kCpuFeatureRdm, "asimdrdm"},
+    {kCpuFeatureSve, "sve"},
+    {kCpuFeatureSve2, "sve2"},
+    {kCpuFeatureI8mm, "i8mm"},
+    {kCpuFeatureBf16, "bf16"},
+};
+
+inline uint64_t bit(CpuFeature feature) {
+  return uint64_t{1} << feature;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Sets [feature] in [mask] if bit [index] of [reg] is set.
+inline void set_if(uint64_t* mask,
+                   unsigned int reg,
+                   int index,
+                   CpuFeature feature) {
+  if (reg & (1u << index)) *mask |= bit(feature);
+}
+
+// Reads XCR0, the register state the kernel saves on context switches.
+// Only valid when CPUID reports OSXSAVE.
+inline uint64_t read_xcr0() {
+  unsigned int eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+
+uint64_t detect_x86() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return 0;
+
+  uint64_t mask = 0;
+  set_if(&mask, edx, 26, kCpuFeatureSse2);
+  set_if(&mask, ecx, 0, kCpuFeatureSse3);
+  set_if(&mask, ecx, 1, kCpuFeaturePclmulqdq);
+  set_if(&mask, ecx, 9, kCpuFeatureSsse3);
+  set_if(&mask, ecx, 19, kCpuFeatureSse41);
+  set_if(&mask, ecx, 20, kCpuFeatureSse42);
+  set_if(&mask, ecx, 22, kCpuFeatureMovbe);
+  set_if(&mask, ecx, 23, kCpuFeaturePopcnt);
+  set_if(&mask, ecx, 25, kCpuFeatureAes);
+
+  // AVX and AVX-512 instructions fault unless the kernel saves their
+  // registers, which XCR0 reports: SSE and AVX state for AVX, plus the
+  // opmask and upper ZMM state for AVX-512.
+  bool osxsave = ecx & (1u << 27);
+  uint64_t xcr0 = osxsave ? read_xcr0() : 0;
+  bool avx_state = (xcr0 & 0x6) == 0x6;
+  bool avx512_state = (xcr0 & 0xe6) == 0xe6;
+
+  uint64_t avx = 0;
+  set_if(&avx, ecx, 28, kCpuFeatureAvx);
+  set_if(&avx, ecx, 29, kCpuFeatureF16c);
+  set_if(&avx, ecx, 12, kCpuFeatureFma);
+
+  uint64_t avx512 = 0;
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+    unsigned int max_subleaf = eax;
+    set_if(&mask, ebx, 3, kCpuFeatureBmi1);
+    set_if(&mask, ebx, 8, kCpuFeatureBmi2);
+    set_if(&mask, ebx, 29, kCpuFeatureSha);
+    set_if(&mask, ecx, 8, kCpuFeatureGfni);
+    set_if(&avx, ebx, 5, kCpuFeatureAvx2);
+    set_if(&avx, ecx, 9, kCpuFeatureVaes);
+    set_if(&avx, ecx, 10, kCpuFeatureVpclmulqdq);
+    set_if(&avx512, ebx, 16, kCpuFeatureAvx512f);
+    set_if(&avx512, ebx, 17, kCpuFeatureAvx512dq);
+    set_if(&avx512, ebx, 21, kCpuFeatureAvx512ifma);
+    set_if(&avx512, ebx, 28, kCpuFeatureAvx512cd);
+    set_if(&avx512, ebx, 30, kCpuFeatureAvx512bw);
+    set_if(&avx512, ebx, 31, kCpuFeatureAvx512vl);
+    set_if(&avx512, ecx, 1, kCpuFeatureAvx512vbmi);
+    set_if(&avx512, ecx, 6, kCpuFeatureAvx512vbmi2);
+    set_if(&avx512, ecx, 11, kCpuFeatureAvx512vnni);
+    set_if(&avx512, ecx, 12, kCpuFeatureAvx512bitalg);
+    set_if(&avx512, ecx, 14, kCpuFeatureAvx512vpopcntdq);
+    set_if(&avx512, edx, 23, kCpuFeatureAvx512fp16);
+    if (max_subleaf >= 1 && __get_cpuid_count(7, 1, &eax, &ebx, &ecx, &edx)) {
+      set_if(&avx, eax, 4, kCpuFeatureAvxVnni);
+      set_if(&avx512, eax, 5, kCpuFeatureAvx512bf16);
+    }
+  }
+
+  if (__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx)) {
+    set_if(&mask, ecx, 5, kCpuFeatureLzcnt);
+  }
+
+  if (avx_state) mask |= avx;
+  if (avx_state && avx512_state) mask |= avx512;
+  return mask;
+}
+
+#elif defined(__aarch64__)
+
+// HWCAP bits from <asm/hwcap.h>, spelled out for older kernel headers.
+constexpr unsigned long kHwcapFp = 1UL << 0;
+constexpr unsigned long kHwcapAsimd = 1UL << 1;
+constexpr unsigned long kHwcapAes = 1UL << 3;
+constexpr unsigned long kHwcapPmull = 1UL << 4;
+constexpr unsigned long kHwcapSha1 = 1UL << 5;
+constexpr unsigned long kHwcapSha2 = 1UL << 6;
+constexpr unsigned long kHwcapCrc32 = 1UL << 7;
+constexpr unsigned long kHwcapAtomics = 1UL << 8;
+constexpr unsigned long kHwcapAsimdHp = 1UL << 10;
+constexpr unsigned long kHwcapAsimdRdm = 1UL << 12;
+constexpr unsigned long kHwcapSha3 = 1UL << 17;
+constexpr unsigned long kHwcapAsimdDp = 1UL << 20;
+constexpr unsigned long kHwcapSha512 = 1UL << 21;
+constexpr unsigned long kHwcapSve = 1UL << 22;
+constexpr unsigned long kHwcap2Sve2 = 1UL << 1;
+constexpr unsigned long kHwcap2I8mm = 1UL << 13;
+constexpr unsigned long kHwcap2Bf16 = 1UL << 14;
+
+uint64_t detect_aarch64() {
+  unsigned long hwcap = getauxval(AT_HWCAP);
+  unsigned long hwcap2 = getauxval(AT_HWCAP2);
+
+  struct {
+    unsigned long hwcap;
+    unsigned long hwcap2;
+    CpuFeature feature;
+  } const kBits[] = {
+      {kHwcapFp | kHwcapAsimd, 0, kCpuFeatureNeon},
+      {kHwcapAes, 0, kCpuFeatureArmAes},
+      {kHwcapPmull, 0, kCpuFeaturePmull},
+      {kHwcapSha1, 0, kCpuFeatureSha1},
+      {kHwcapSha2, 0, kCpuFeatureSha2},
+      {kHwcapSha3, 0, kCpuFeatureSha3},
+      {kHwcapSha512, 0, kCpuFeatureSha512},
+      {kHwcapCrc32, 0, kCpuFeatureCrc32},
+      {kHwcapAtomics, 0, kCpuFeatureAtomics},
+      {kHwcapAsimdHp, 0, kCpuFeatureFp16},
+      {kHwcapAsimdDp, 0, kCpuFeatureDotProd},
+      {kHwcapAsimdRdm, 0, kCpuFeatureRdm},
+      {kHwcapSve, 0, kCpuFeatureSve},
+      {0, kHwcap2Sve2, kCpuFeatureSve2},
+      {0, kHwcap2I8mm, kCpuFeatureI8mm},
+      {0, kHwcap2Bf16, kCpuFeatureBf16},
+  };
+
+  uint64_t mask = 0;
+  for (const auto& entry : kBits) {
+    if ((hwcap & entry.hwcap) == entry.hwcap &&
+        (hwcap2 & entry.hwcap2) == entry.hwcap2) {
+      mask |= bit(entry.feature);
+    }
+  }
+  return mask;
+}
+
+#endif
+
+}  // namespace
+
+uint64_t cpu_features_detect() {
+#if defined(__x86_64__) || defined(__i386__)
+  return detect_x86();
+#elif defined(__aarch64__)
+  return detect_aarch64();
+#else
+  return 0;
+#endif
+}
+
+const char* cpu_feature_name(int bit) {
+  for (const CpuFeatureName& entry : kCpuFeatureNames) {
+    if (entry.feature == bit) return entry.name;
+  }
+  return nullptr;
+}
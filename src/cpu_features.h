@@ -0,0 +1,74 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_FEATURES_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_FEATURES_H_
+
+#include <cstdint>
+
+// Bit positions in the mask returned by cpu_features_detect(). The positions
+// are part of the Dart API and must not change; x86 features use bits 0-39
+// and Arm features bits 40-63.
+enum CpuFeature : int {
+  // x86 and x86-64.
+  kCpuFeatureSse2 = 0,
+  kCpuFeatureSse3 = 1,
+  kCpuFeatureSsse3 = 2,
+  kCpuFeatureSse41 = 3,
+  kCpuFeatureSse42 = 4,
+  kCpuFeaturePopcnt = 5,
+  kCpuFeatureAes = 6,
+  kCpuFeaturePclmulqdq = 7,
+  kCpuFeatureAvx = 8,
+  kCpuFeatureF16c = 9,
+  kCpuFeatureFma = 10,
+  kCpuFeatureAvx2 = 11,
+  kCpuFeatureBmi1 = 12,
+  kCpuFeatureBmi2 = 13,
+  kCpuFeatureLzcnt = 14,
+  kCpuFeatureMovbe = 15,
+  kCpuFeatureSha = 16,
+  kCpuFeatureAvx512f = 17,
+  kCpuFeatureAvx512dq = 18,
+  kCpuFeatureAvx512cd = 19,
+  kCpuFeatureAvx512bw = 20,
+  kCpuFeatureAvx512vl = 21,
+  kCpuFeatureAvx512ifma = 22,
+  kCpuFeatureAvx512vbmi = 23,
+  kCpuFeatureAvx512vbmi2 = 24,
+  kCpuFeatureAvx512vnni = 25,
+  kCpuFeatureAvx512bitalg = 26,
+  kCpuFeatureAvx512vpopcntdq = 27,
+  kCpuFeatureAvx512bf16 = 28,
+  kCpuFeatureAvx512fp16 = 29,
+  kCpuFeatureAvxVnni = 30,
+  kCpuFeatureVaes = 31,
+  kCpuFeatureVpclmulqdq = 32,
+  kCpuFeatureGfni = 33,
+  // AArch64.
+  kCpuFeatureNeon = 40,
+  kCpuFeatureArmAes = 41,
+  kCpuFeaturePmull = 42,
+  kCpuFeatureSha1 = 43,
+  kCpuFeatureSha2 = 44,
+  kCpuFeatureSha3 = 45,
+  kCpuFeatureSha512 = 46,
+  kCpuFeatureCrc32 = 47,
+  kCpuFeatureAtomics = 48,
+  kCpuFeatureFp16 = 49,
+  kCpuFeatureDotProd = 50,
+  kCpuFeatureRdm = 51,
+  kCpuFeatureSve = 52,
+  kCpuFeatureSve2 = 53,
+  kCpuFeatureI8mm = 54,
+  kCpuFeatureBf16 = 55,
+};
+
+// Returns the instruction-set extensions this CPU supports and the kernel
+// has enabled, as a mask of 1 << CpuFeature bits. Uses cpuid and xgetbv on
+// x86 and getauxval(AT_HWCAP/AT_HWCAP2) on AArch64; returns 0 elsewhere.
+// Cheap enough to call once at startup and cache.
+uint64_t cpu_features_detect();
+
+// The name of the feature at [bit], as /proc/cpuinfo spells it where it has
+// one, e.g. "avx2" or "asimd"; nullptr for unused bits.
+const char* cpu_feature_name(int bit);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_FEATURES_H_
@@ -0,0 +1,212 @@
+#include "cpu_topology.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "proc_parser.h"
+#include "string_util.h"
+
+// On hybrid systems, cores at or above this share of the fastest core's
+// capacity or frequency count as performance cores. Leaves room for the
+// small frequency differences between "favoured" cores of one type.
+static const unsigned long long kPerformanceCorePercent = 80;
+
+bool cpu_cache_parse_size(std::string_view text, unsigned long long* bytes) {
+  unsigned long long value = 0;
+  if (!proc_next_u64(&text, &value)) return false;
+  text = string_trim(text);
+  if (text.empty()) {
+    *bytes = value;
+  } else if (text == "K") {
+    *bytes = value << 10;
+  } else if (text == "M") {
+    *bytes = value << 20;
+  } else if (text == "G") {
+    *bytes = value << 30;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Reads the topology of logical CPU [cpu] relative to [cpu_dirfd].
+static void cpu_topology_read_cpu(int cpu_dirfd,
+                                  int cpu,
+                                  CpuTopologyCpu* info) {
+  char path[96];
+  unsigned long long value = 0;
+  *info = {};
+  info->cpu = cpu;
+  info->performance = true;
+
+  snprintf(path, sizeof(path), "cpu%d/topology/physical_package_id", cpu);
+  if (sysfs_read_u64_at(cpu_dirfd, path, &value)) {
+    info->package = static_cast<int>(value);
+  }
+  snprintf(path, sizeof(path), "cpu%d/topology/core_id", cpu);
+  info->core = sysfs_read_u64_at(cpu_dirfd, path, &value)
+                   ? static_cast<int>(value)
+                   : cpu;
+
+  char buffer[1024];
+  std::string_view line;
+  std::vector<int> siblings;
+  snprintf(path, sizeof(path), "cpu%d/topology/thread_siblings_list", cpu);
+  info->smt_siblings =
+      sysfs_read_line_at(cpu_dirfd, path, buffer, sizeof(buffer), &line) &&
+              cpulist_parse(line, &siblings) && !siblings.empty()
+          ? static_cast<int>(siblings.size())
+          : 1;
+
+  snprintf(path, sizeof(path), "cpu%d/cpu_capacity", cpu);
+  sysfs_read_u64_at(cpu_dirfd, path, &info->capacity);
+  snprintf(path, sizeof(path), "cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+  sysfs_read_u64_at(cpu_dirfd, path, &info->max_frequency_khz);
+}
+
+// Adds the caches of [cpu] whose instance it owns, i.e. where it is the
+// lowest-numbered CPU sharing the cache, so each instance is counted once.
+static void cpu_topology_read_caches(int cpu_dirfd,
+                                     int cpu,
+                                     std::vector<CpuCache>* caches) {
+  char path[96];
+  snprintf(path, sizeof(path), "cpu%d/cache", cpu);
+  std::vector<int> indexes;
+  if (!sysfs_list_numbered(cpu_dirfd, path, "index", &indexes)) return;
+
+  char buffer[1024];
+  std::string_view line;
+  std::vector<int> shared;
+  for (int index : indexes) {
+    shared.clear();
+    snprintf(path, sizeof(path), "cpu%d/cache/index%d/shared_cpu_list", cpu,
+             index);
+    if (sysfs_read_line_at(cpu_dirfd, path, buffer, sizeof(buffer), &line) &&
+        cpulist_parse(line, &shared) && !shared.empty() &&
+        shared.front() != cpu) {
+      continue;
+    }
+
+    CpuCache cache = {};
+    cache.shared_cpus = shared.empty() ? 1 : static_cast<int>(shared.size());
+    cache.instances = 1;
+    unsigned long long value = 0;
+    snprintf(path, sizeof(path), "cpu%d/cache/index%d/level", cpu, index);
+    if (!sysfs_read_u64_at(cpu_dirfd, path, &value)) continue;
+    cache.level = static_cast<int>(value);
+    snprintf(path, sizeof(path), "cpu%d/cache/index%d/type", cpu, index);
+    if (sysfs_read_line_at(cpu_dirfd, path, buffer, sizeof(buffer), &line)) {
+      cache.type.assign(line.data(), line.size());
+    }
+    snprintf(path, sizeof(path), "cpu%d/cache/index%d/size", cpu, index);
+    if (sysfs_read_line_at(cpu_dirfd, path, buffer, sizeof(buffer), &line)) {
+      cpu_cache_parse_size(line, &cache.size_bytes);
+    }
+    snprintf(path, sizeof(path), "cpu%d/cache/index%d/coherency_line_size",
+             cpu, index);
+    if (sysfs_read_u64_at(cpu_dirfd, path, &value)) {
+      cache.line_size = static_cast<unsigned int>(value);
+    }
+    snprintf(path, sizeof(path), "cpu%d/cache/index%d/ways_of_associativity",
+             cpu, index);
+    if (sysfs_read_u64_at(cpu_dirfd, path, &value)) {
+      cache.ways = static_cast<unsigned int>(value);
+    }
+
+    auto same = std::find_if(
+        caches->begin(), caches->end(), [&cache](const CpuCache& other) {
+          return other.level == cache.level && other.type == cache.type &&
+                 other.size_bytes == cache.size_bytes &&
+                 other.line_size == cache.line_size &&
+                 other.ways == cache.ways &&
+                 other.shared_cpus == cache.shared_cpus;
+        });
+    if (same != caches->end()) {
+      same->instances++;
+    } else {
+      caches->push_back(std::move(cache));
+    }
+  }
+}
+
+// Marks the slower cores of a hybrid system, judged by capacity where the
+// kernel reports differing values and by maximum frequency otherwise.
+static void cpu_topology_classify(CpuTopology* topology) {
+  unsigned long long min_capacity = ~0ULL, max_capacity = 0;
+  unsigned long long min_frequency = ~0ULL, max_frequency = 0;
+  for (const CpuTopologyCpu& cpu : topology->cpus) {
+    min_capacity = std::min(min_capacity, cpu.capacity);
+    max_capacity = std::max(max_capacity, cpu.capacity);
+    min_frequency = std::min(min_frequency, cpu.max_frequency_khz);
+    max_frequency = std::max(max_frequency, cpu.max_frequency_khz);
+  }
+
+  bool by_capacity = min_capacity > 0 &&
+                     min_capacity * 100 < max_capacity * kPerformanceCorePercent;
+  bool by_frequency =
+      !by_capacity && min_frequency > 0 &&
+      min_frequency * 100 < max_frequency * kPerformanceCorePercent;
+  topology->hybrid = by_capacity || by_frequency;
+  if (!topology->hybrid) return;
+
+  for (CpuTopologyCpu& cpu : topology->cpus) {
+    unsigned long long value = by_capacity ? cpu.capacity : cpu.max_frequency_khz;
+    unsigned long long max = by_capacity ? max_capacity : max_frequency;
+    cpu.performance = value * 100 >= max * kPerformanceCorePercent;
+  }
+}
+
+bool cpu_topology_read(const char* cpu_dir,
+                       const char* node_dir,
+                       CpuTopology* topology) {
+  *topology = {};
+  int cpu_dirfd = open(cpu_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (cpu_dirfd < 0) return false;
+
+  std::vector<int> numbers;
+  sysfs_list_numbered(cpu_dirfd, ".", "cpu", &numbers);
+  topology->cpus.resize(numbers.size());
+  for (size_t i = 0; i < numbers.size(); i++) {
+    cpu_topology_read_cpu(cpu_dirfd, numbers[i], &topology->cpus[i]);
+    cpu_topology_read_caches(cpu_dirfd, numbers[i], &topology->caches);
+  }
+  close(cpu_dirfd);
+  if (topology->cpus.empty()) return false;
+
+  cpu_topology_classify(topology);
+
+  // Count packages and cores as distinct ids; a core is identified by its
+  // package and core id.
+  std::vector<std::pair<int, int>> cores;
+  std::vector<int> packages;
+  for (const CpuTopologyCpu& cpu : topology->cpus) {
+    topology->threads_per_core =
+        std::max(topology->threads_per_core, cpu.smt_siblings);
+    if (std::find(packages.begin(), packages.end(), cpu.package) ==
+        packages.end()) {
+      packages.push_back(cpu.package);
+    }
+    std::pair<int, int> core(cpu.package, cpu.core);
+    if (std::find(cores.begin(), cores.end(), core) == cores.end()) {
+      cores.push_back(core);
+      if (cpu.performance) {
+        topology->performance_cores++;
+      } else {
+        topology->efficiency_cores++;
+      }
+    }
+  }
+  topology->packages = static_cast<int>(packages.size());
+  topology->cores = static_cast<int>(cores.size());
+
+  std::sort(topology->caches.begin(), topology->caches.end(),
+            [](const CpuCache& a, const CpuCache& b) {
+              return a.level != b.level ? a.level < b.level : a.type < b.type;
+            });
+  numa_read_nodes(node_dir, &topology->numa_nodes);
+  return true;
+}
@@ -0,0 +1,64 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_TOPOLOGY_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_TOPOLOGY_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cpu_affinity.h"
+
+// One logical CPU as described by sysfs.
+struct CpuTopologyCpu {
+  int cpu;
+  int package;
+  int core;
+  // Number of hardware threads sharing this CPU's core, including itself.
+  int smt_siblings;
+  // Relative compute capacity (1024 for the fastest cores) where the kernel
+  // exposes cpu_capacity, otherwise 0.
+  unsigned long long capacity;
+  // cpufreq maximum in kHz, or 0 without cpufreq.
+  unsigned long long max_frequency_khz;
+  // Set on hybrid systems for the fast (P) cores; always set otherwise.
+  bool performance;
+};
+
+// One kind of cache, e.g. the L2 of the performance cores. Identical
+// instances are folded into one entry.
+struct CpuCache {
+  int level;
+  // "Data", "Instruction" or "Unified".
+  std::string type;
+  unsigned long long size_bytes;
+  unsigned int line_size;
+  unsigned int ways;
+  // Logical CPUs sharing one instance.
+  int shared_cpus;
+  int instances;
+};
+
+struct CpuTopology {
+  std::vector<CpuTopologyCpu> cpus;
+  int packages;
+  int cores;
+  // Most hardware threads found on one core.
+  int threads_per_core;
+  // Whether cores differ in capacity or maximum frequency.
+  bool hybrid;
+  int performance_cores;
+  int efficiency_cores;
+  std::vector<CpuCache> caches;
+  std::vector<NumaNode> numa_nodes;
+};
+
+// Parses a sysfs cache size such as "48K" or "32M" into bytes.
+bool cpu_cache_parse_size(std::string_view text, unsigned long long* bytes);
+
+// Reads the topology of the CPUs under [cpu_dir] (normally
+// /sys/devices/system/cpu) and the NUMA nodes under [node_dir]. Returns false
+// if no CPU directories could be listed.
+bool cpu_topology_read(const char* cpu_dir,
+                       const char* node_dir,
+                       CpuTopology* topology);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_TOPOLOGY_H_
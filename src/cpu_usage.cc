@@ -0,0 +1,89 @@
+#include "cpu_usage.h"
+
+#include "proc_parser.h"
+
+bool proc_stat_parse_cpu_line(std::string_view line, CpuTimes* times) {
+  if (line.substr(0, 3) != "cpu") return false;
+  line.remove_prefix(3);
+
+  times->cpu = -1;
+  if (!line.empty() && line.front() >= '0' && line.front() <= '9') {
+    unsigned long long cpu = 0;
+    proc_next_u64(&line, &cpu);
+    times->cpu = static_cast<int>(cpu);
+  }
+
+  unsigned long long* fields[] = {
+      &times->user,   &times->nice, &times->system,  &times->idle,
+      &times->iowait, &times->irq,  &times->softirq, &times->steal,
+  };
+  for (unsigned long long* field : fields) {
+    // Older kernels report fewer columns; the missing ones read as zero.
+    if (!proc_next_u64(&line, field)) *field = 0;
+  }
+  return true;
+}
+
+bool proc_stat_read(const char* path, std::vector<CpuTimes>* times) {
+  ProcLineReader reader;
+  if (!proc_line_reader_open(&reader, path)) return false;
+
+  times->clear();
+  std::string_view line;
+  CpuTimes cpu_times;
+  while (proc_line_reader_next(&reader, &line)) {
+    if (!proc_stat_parse_cpu_line(line, &cpu_times)) break;
+    times->push_back(cpu_times);
+  }
+
+  proc_line_reader_close(&reader);
+  return !times->empty();
+}
+
+CpuUsage cpu_usage_between(const CpuTimes& before, const CpuTimes& after) {
+  // Counters can go backwards when a CPU is hot-plugged; treat that as zero.
+  auto delta = [](unsigned long long a, unsigned long long b) {
+    return b > a ? static_cast<double>(b - a) : 0.0;
+  };
+  double user = delta(before.user, after.user) + delta(before.nice, after.nice);
+  double system = delta(before.system, after.system) +
+                  delta(before.irq, after.irq) +
+                  delta(before.softirq, after.softirq);
+  double iowait = delta(before.iowait, after.iowait);
+  double steal = delta(before.steal, after.steal);
+  double idle = delta(before.idle, after.idle);
+  double total = user + system + iowait + steal + idle;
+
+  CpuUsage usage = {after.cpu, 0, 0, 0, 0, 0};
+  if (total > 0) {
+    usage.user = 100.0 * user / total;
+    usage.system = 100.0 * system / total;
+    usage.iowait = 100.0 * iowait / total;
+    usage.steal = 100.0 * steal / total;
+    usage.idle = 100.0 * idle / total;
+  }
+  return usage;
+}
+
+bool cpu_usage_sampler_sample(CpuUsageSampler* sampler,
+                              const char* path,
+                              std::vector<CpuUsage>* usage) {
+  if (!proc_stat_read(path, &sampler->current)) return false;
+
+  usage->clear();
+  // CPUs can come and go, so match the previous sample by CPU number. Both
+  // samples are in /proc/stat order (aggregate first, then ascending CPU
+  // numbers), so a single forward walk finds every match.
+  const CpuTimes zero = {};
+  const std::vector<CpuTimes>& previous = sampler->previous;
+  size_t j = 0;
+  for (const CpuTimes& after : sampler->current) {
+    while (j < previous.size() && previous[j].cpu < after.cpu) j++;
+    const CpuTimes& before =
+        j < previous.size() && previous[j].cpu == after.cpu ? previous[j] : zero;
+    usage->push_back(cpu_usage_between(before, after));
+  }
+
+  sampler->previous.swap(sampler->current);
+  return true;
+}
@@ -0,0 +1,60 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_USAGE_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_USAGE_H_
+
+#include <string_view>
+#include <vector>
+
+// Cumulative jiffies for one line of /proc/stat.
+struct CpuTimes {
+  // CPU number, or -1 for the aggregate "cpu" line.
+  int cpu;
+  unsigned long long user;
+  unsigned long long nice;
+  unsigned long long system;
+  unsigned long long idle;
+  unsigned long long iowait;
+  unsigned long long irq;
+  unsigned long long softirq;
+  unsigned long long steal;
+};
+
+// Share of time, in percent, spent in each state between two samples.
+struct CpuUsage {
+  // CPU number, or -1 for the aggregate of all CPUs.
+  int cpu;
+  // user + nice.
+  double user;
+  // system + irq + softirq.
+  double system;
+  double iowait;
+  double steal;
+  double idle;
+};
+
+// Parses one "cpu" or "cpuN" line of /proc/stat. Returns false for any other
+// line.
+bool proc_stat_parse_cpu_line(std::string_view line, CpuTimes* times);
+
+// Reads every cpu line of the /proc/stat style file at [path] into [times],
+// aggregate first. Stops at the first non-cpu line, so the long "intr" line
+// is never read. Returns false if the file cannot be opened.
+bool proc_stat_read(const char* path, std::vector<CpuTimes>* times);
+
+// Computes the usage between [before] and [after] for the same CPU.
+CpuUsage cpu_usage_between(const CpuTimes& before, const CpuTimes& after);
+
+// Keeps the previous /proc/stat sample so that each call reports usage since
+// the last one. Not thread-safe.
+struct CpuUsageSampler {
+  std::vector<CpuTimes> previous;
+  std::vector<CpuTimes> current;
+};
+
+// Reads [path] once and stores usage since the previous call in [usage],
+// aggregate first. The first call reports usage since boot. Returns false if
+// [path] cannot be read.
+bool cpu_usage_sampler_sample(CpuUsageSampler* sampler,
+                              const char* path,
+                              std::vector<CpuUsage>* usage);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_CPU_USAGE_H_
@@ -0,0 +1,325 @@
+#include "device_info.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include "proc_parser.h"
+#include "stable_device_id.h"
+#include "sysroot.h"
+#include "trace_recorder.h"
+
+const char* const kProbeNames[] = {
+    "stableDeviceId", "kernel", "processors", "cpuInfo", "osRelease",
+    "nodeName", "sysinfo", "meminfo", "cgroupPaths", "cgroup",
+    "numaNodes", "affinity", "cpuTopology",
+};
+static_assert(1u << (kProbeCount - 1) == kProbeCpuTopology,
+              "kProbeNames must name every probe bit");
+
+// Records the time from construction to the end of the enclosing scope as
+// one run of [probe], unless [histograms] is null, and traces it while
+// tracing is on. Set [failed] to count the run as an error.
+struct ProbeTimer {
+  ProbeTimer(LatencyHistogram* histograms, unsigned probe)
+      : trace("probe", kProbeNames[__builtin_ctz(probe)]),
+        histogram(histograms != nullptr
+                      ? &histograms[__builtin_ctz(probe)]
+                      : nullptr),
+        start_ns(latency_now_ns()) {}
+  ~ProbeTimer() {
+    if (histogram == nullptr) return;
+    latency_histogram_record(histogram, latency_now_ns() - start_ns, failed);
+  }
+
+  TraceScope trace;
+  LatencyHistogram* histogram;
+  uint64_t start_ns;
+  bool failed = false;
+};
+
+// Runs the static [probes] that have not run yet against the files under
+// [sysroot], timing each into [histograms]. Must be called with the snapshot lock held.
+static void probe_device_snapshot(DeviceSnapshot* snapshot,
+                                  unsigned probes,
+                                  LatencyHistogram* histograms,
+                                  const char* sysroot) {
+  probes &= kStaticProbes & ~snapshot->probed;
+
+  if (probes & kProbeStableDeviceId) {
+    ProbeTimer timer(histograms, kProbeStableDeviceId);
+    snapshot->stable_device_id = stable_device_id_get();
+    timer.failed = snapshot->stable_device_id.empty();
+  }
+
+  if (probes & kProbeKernel) {
+    ProbeTimer timer(histograms, kProbeKernel);
+    struct utsname uname_data = {};
+    timer.failed = uname(&uname_data) != 0;
+    snapshot->system_name = uname_data.sysname;
+    snapshot->release = uname_data.release;
+    snapshot->version = uname_data.version;
+    snapshot->machine = uname_data.machine;
+  }
+
+  if (probes & kProbeProcessors) {
+    ProbeTimer timer(histograms, kProbeProcessors);
+    snapshot->number_of_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    timer.failed = snapshot->number_of_processors <= 0;
+  }
+
+  // Try to get CPU model from /proc/cpuinfo
+  if (probes & kProbeCpuInfo) {
+    ProbeTimer timer(histograms, kProbeCpuInfo);
+    snapshot->cpu_model = "Unknown";
+    timer.failed =
+        !cpuinfo_read_model_name(sysroot_path(sysroot, "/proc/cpuinfo").path,
+                                 &snapshot->cpu_model);
+  }
+
+  // Try to get distribution info from /etc/os-release
+  if (probes & kProbeOsRelease) {
+    ProbeTimer timer(histograms, kProbeOsRelease);
+    snapshot->distribution_name = "Unknown";
+    snapshot->distribution_version = "Unknown";
+    timer.failed =
+        !os_release_read(sysroot_path(sysroot, "/etc/os-release").path,
+                         &snapshot->distribution_name,
+                         &snapshot->distribution_version);
+  }
+
+  // Cgroup membership only changes if the process is moved, which sandboxes
+  // and containers do not do after launch.
+  if (probes & kProbeCgroupPaths) {
+    ProbeTimer timer(histograms, kProbeCgroupPaths);
+    timer.failed =
+        !cgroup_resolve(sysroot_path(sysroot, "/proc/self/cgroup").path,
+                        sysroot_path(sysroot, "/proc/self/mountinfo").path,
+                        sysroot, &snapshot->cgroup);
+  }
+
+  if (probes & kProbeNumaNodes) {
+    ProbeTimer timer(histograms, kProbeNumaNodes);
+    numa_read_nodes(sysroot_path(sysroot, "/sys/devices/system/node").path,
+                    &snapshot->numa_nodes);
+  }
+
+  if (probes & kProbeCpuTopology) {
+    ProbeTimer timer(histograms, kProbeCpuTopology);
+    timer.failed = !cpu_topology_read(
+        sysroot_path(sysroot, "/sys/devices/system/cpu").path,
+        sysroot_path(sysroot, "/sys/devices/system/node").path,
+        &snapshot->cpu_topology);
+  }
+
+  snapshot->probed |= probes;
+}
+
+void device_info_run_probes(const DeviceInfoProbeContext& context,
+                            unsigned probes,
+                            DeviceInfoProbeResults* results) {
+  DeviceSnapshot* snapshot = context.snapshot;
+  if (probes & kProbeCgroup) {
+    probes |= kProbeCgroupPaths | kProbeProcessors | kProbeAffinity;
+  }
+
+  if ((probes & kStaticProbes) != 0) {
+    std::lock_guard<std::mutex> lock(snapshot->mutex);
+    probe_device_snapshot(snapshot, probes, context.histograms,
+                          context.sysroot);
+  }
+  results->snapshot = snapshot;
+  probes &= ~results->probed;
+  results->probed |= probes & ~kStaticProbes;
+
+  // The node name is re-read because the hostname may be changed while the
+  // app is running.
+  if (probes & kProbeNodeName) {
+    ProbeTimer timer(context.histograms, kProbeNodeName);
+    results->uname_data = {};
+    timer.failed = uname(&results->uname_data) != 0;
+  }
+
+  // With the background sampler running these are a copy of its latest
+  // sample rather than a syscall on this thread.
+  MetricsSample sample;
+  unsigned sampled = 0;
+  if ((probes & (kProbeSysinfo | kProbeMeminfo)) &&
+      context.sampler != nullptr &&
+      metrics_sampler_read(context.sampler, &sample)) {
+    sampled = sample.metrics;
+  }
+
+  if (probes & kProbeSysinfo) {
+    ProbeTimer timer(context.histograms, kProbeSysinfo);
+    if (sampled & kMetricSysinfo) {
+      results->sys_info = sample.sys_info;
+    } else {
+      results->sys_info = {};
+      timer.failed = sysinfo(&results->sys_info) != 0;
+    }
+  }
+
+  if (probes & kProbeMeminfo) {
+    ProbeTimer timer(context.histograms, kProbeMeminfo);
+    if (sampled & kMetricMeminfo) {
+      results->meminfo = sample.meminfo;
+    } else {
+      timer.failed =
+          !meminfo_reader_read(context.meminfo_reader, &results->meminfo);
+    }
+  }
+
+  // The affinity mask can be changed at runtime with taskset.
+  if (probes & kProbeAffinity) {
+    ProbeTimer timer(context.histograms, kProbeAffinity);
+    results->allowed_processors = cpu_affinity_count();
+    timer.failed = results->allowed_processors <= 0;
+  }
+
+  // Limits can be changed at runtime too, e.g. by `docker update`.
+  if (probes & kProbeCgroup) {
+    ProbeTimer timer(context.histograms, kProbeCgroup);
+    cgroup_read_limits(snapshot->cgroup, &results->cgroup_limits);
+    long available = snapshot->number_of_processors;
+    if (results->allowed_processors > 0 &&
+        results->allowed_processors < available) {
+      available = results->allowed_processors;
+    }
+    results->effective_processors =
+        cgroup_effective_processors(results->cgroup_limits, available);
+  }
+}
+
+const DeviceInfoKey kDeviceInfoKeys[] = {
+    {"stableDeviceId", kProbeStableDeviceId,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->stable_device_id = r.snapshot->stable_device_id.c_str();
+     }},
+    {"systemName", kProbeKernel,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->system_name = r.snapshot->system_name.c_str();
+     }},
+    {"nodeName", kProbeNodeName,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->node_name = r.uname_data.nodename;
+     }},
+    {"release", kProbeKernel,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->release = r.snapshot->release.c_str();
+     }},
+    {"version", kProbeKernel,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->version = r.snapshot->version.c_str();
+     }},
+    {"machine", kProbeKernel,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->machine = r.snapshot->machine.c_str();
+     }},
+    {"hostname", kProbeNodeName,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->hostname = r.uname_data.nodename;
+     }},
+    {"totalRam", kProbeSysinfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->total_ram = r.sys_info.totalram;
+     }},
+    {"freeRam", kProbeSysinfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->free_ram = r.sys_info.freeram;
+     }},
+    {"sharedRam", kProbeSysinfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->shared_ram = r.sys_info.sharedram;
+     }},
+    {"bufferRam", kProbeSysinfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->buffer_ram = r.sys_info.bufferram;
+     }},
+    {"totalSwap", kProbeSysinfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->total_swap = r.sys_info.totalswap;
+     }},
+    {"freeSwap", kProbeSysinfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->free_swap = r.sys_info.freeswap;
+     }},
+    {"processes", kProbeSysinfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->processes = r.sys_info.procs;
+     }},
+    {"uptime", kProbeSysinfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->uptime = r.sys_info.uptime;
+     }},
+    {"numberOfProcessors", kProbeProcessors,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->number_of_processors = r.snapshot->number_of_processors;
+     }},
+    {"cpuModel", kProbeCpuInfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->cpu_model = r.snapshot->cpu_model.c_str();
+     }},
+    {"distributionName", kProbeOsRelease,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->distribution_name = r.snapshot->distribution_name.c_str();
+     }},
+    {"distributionVersion", kProbeOsRelease,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->distribution_version = r.snapshot->distribution_version.c_str();
+     }},
+    {"availableRam", kProbeMeminfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->available_ram = r.meminfo.mem_available;
+     }},
+    {"cachedRam", kProbeMeminfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->cached_ram = r.meminfo.cached;
+     }},
+    {"dirtyRam", kProbeMeminfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->dirty_ram = r.meminfo.dirty;
+     }},
+    {"writebackRam", kProbeMeminfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->writeback_ram = r.meminfo.writeback;
+     }},
+    {"slabReclaimable", kProbeMeminfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->slab_reclaimable = r.meminfo.slab_reclaimable;
+     }},
+    {"swapCached", kProbeMeminfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->swap_cached = r.meminfo.swap_cached;
+     }},
+    {"swapInPages", kProbeMeminfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->swap_in_pages = r.meminfo.swap_in_pages;
+     }},
+    {"swapOutPages", kProbeMeminfo,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->swap_out_pages = r.meminfo.swap_out_pages;
+     }},
+    {"allowedProcessors", kProbeAffinity,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->allowed_processors = r.allowed_processors;
+     }},
+    {"effectiveProcessors", kProbeCgroup,
+     [](const DeviceInfoProbeResults& r, DeviceInfo* info) {
+       info->effective_processors = r.effective_processors;
+     }},
+};
+
+const DeviceInfoKey* device_info_find_key(const char* name) {
+  for (const DeviceInfoKey& key : kDeviceInfoKeys) {
+    if (strcmp(key.name, name) == 0) return &key;
+  }
+  return nullptr;
+}
+
+void device_info_collect(const DeviceInfoProbeResults& results,
+                         unsigned probes,
+                         DeviceInfo* info) {
+  for (const DeviceInfoKey& key : kDeviceInfoKeys) {
+    if (key.probe & probes) key.set(results, info);
+  }
+}
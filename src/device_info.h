@@ -0,0 +1,138 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/sysinfo.h>
+#include <sys/utsname.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cgroup.h"
+#include "cpu_affinity.h"
+#include "cpu_topology.h"
+#include "device_info_fields.h"
+#include "latency_histogram.h"
+#include "meminfo.h"
+#include "metrics_sampler.h"
+
+// The probes behind getDeviceInfo. Each output key is produced by exactly one
+// probe, so a call only pays for the probes its keys need.
+enum DeviceInfoProbe : unsigned {
+  // Static probes; their results are cached in DeviceSnapshot.
+  kProbeStableDeviceId = 1 << 0,
+  kProbeKernel = 1 << 1,
+  kProbeProcessors = 1 << 2,
+  kProbeCpuInfo = 1 << 3,
+  kProbeOsRelease = 1 << 4,
+  kProbeCgroupPaths = 1 << 8,
+  kProbeNumaNodes = 1 << 10,
+  kProbeCpuTopology = 1 << 12,
+  // Dynamic probes; re-run on every call.
+  kProbeNodeName = 1 << 5,
+  kProbeSysinfo = 1 << 6,
+  kProbeMeminfo = 1 << 7,
+  // Reads the limits of the cgroup found by kProbeCgroupPaths.
+  kProbeCgroup = 1 << 9,
+  kProbeAffinity = 1 << 11,
+};
+
+static const unsigned kStaticProbes = kProbeStableDeviceId | kProbeKernel |
+                                      kProbeProcessors | kProbeCpuInfo |
+                                      kProbeOsRelease | kProbeCgroupPaths |
+                                      kProbeNumaNodes | kProbeCpuTopology;
+
+constexpr size_t kProbeCount = 13;
+static const unsigned kAllProbes = (1u << kProbeCount) - 1;
+
+// Probe names, as reported by getPluginMetrics, indexed by probe bit.
+extern const char* const kProbeNames[kProbeCount];
+
+// Device properties that cannot change while the process is running. Each
+// static probe fills its fields on first use; [probed] records which ones
+// have run.
+struct DeviceSnapshot {
+  // Guards [probed] and the probes' writes. Fields are written once, before
+  // their probe bit is set, so they can be read without the lock afterwards.
+  std::mutex mutex;
+  unsigned probed = 0;
+
+  std::string stable_device_id;
+  std::string system_name;
+  std::string release;
+  std::string version;
+  std::string machine;
+  std::string cpu_model;
+  std::string distribution_name;
+  std::string distribution_version;
+  long number_of_processors = 0;
+  CgroupPaths cgroup;
+  std::vector<NumaNode> numa_nodes;
+  CpuTopology cpu_topology;
+};
+
+// Results of one getDeviceInfo call's probes. The calls of a batch share one
+// instance, so each dynamic probe runs at most once per batch.
+struct DeviceInfoProbeResults {
+  // Dynamic probes that have already run into this instance.
+  unsigned probed;
+  const DeviceSnapshot* snapshot;
+  struct utsname uname_data;
+  struct sysinfo sys_info;
+  MemInfo meminfo;
+  CgroupLimits cgroup_limits;
+  long effective_processors;
+  long allowed_processors;
+};
+
+// What the probes read from and record into.
+struct DeviceInfoProbeContext {
+  // Cache for the static probes, shared by every call.
+  DeviceSnapshot* snapshot;
+  // One latency histogram per probe, indexed by probe bit, or null to leave
+  // the probes untimed.
+  LatencyHistogram* histograms;
+  // /proc/meminfo and /proc/vmstat, kept open for pread().
+  const MemInfoReader* meminfo_reader;
+  // When set, sysinfo and meminfo are copied from its latest sample instead
+  // of being read on the calling thread.
+  const MetricsSampler* sampler;
+  // Directory the static probes read /proc, /sys and /etc from; null or ""
+  // for the live system. See sysroot.h.
+  const char* sysroot;
+};
+
+// Runs [probes] and the probes they depend on, and stores their results.
+// Static results come from the context's snapshot, probing any that have not
+// run yet; dynamic probes that already ran into [results] are skipped. Each
+// probe that runs is timed into the context's histograms and traced. Safe to
+// call from several threads sharing one context.
+void device_info_run_probes(const DeviceInfoProbeContext& context,
+                            unsigned probes,
+                            DeviceInfoProbeResults* results);
+
+// Maps an output key to the probe that produces it and a setter that copies
+// its value from the probe results into the matching DeviceInfo member.
+struct DeviceInfoKey {
+  const char* name;
+  unsigned probe;
+  void (*set)(const DeviceInfoProbeResults& results, DeviceInfo* info);
+};
+
+constexpr size_t kDeviceInfoKeyCount = 29;
+
+// Every key reported by getDeviceInfo, in reporting order.
+extern const DeviceInfoKey kDeviceInfoKeys[kDeviceInfoKeyCount];
+
+// Returns the key called [name], or nullptr if there is none.
+const DeviceInfoKey* device_info_find_key(const char* name);
+
+// Sets the members of [info] produced by [probes]. String members point into
+// [results] and its snapshot.
+void device_info_collect(const DeviceInfoProbeResults& results,
+                         unsigned probes,
+                         DeviceInfo* info);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_H_
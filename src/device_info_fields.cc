@@ -0,0 +1,71 @@
+#include "device_info_fields.h"
+
+#include <string.h>
+
+const DeviceInfoField kDeviceInfoFields[] = {
+    {"stableDeviceId", &DeviceInfo::stable_device_id, nullptr},
+    {"systemName", &DeviceInfo::system_name, nullptr},
+    {"nodeName", &DeviceInfo::node_name, nullptr},
+    {"release", &DeviceInfo::release, nullptr},
+    {"version", &DeviceInfo::version, nullptr},
+    {"machine", &DeviceInfo::machine, nullptr},
+    {"hostname", &DeviceInfo::hostname, nullptr},
+    {"totalRam", nullptr, &DeviceInfo::total_ram},
+    {"freeRam", nullptr, &DeviceInfo::free_ram},
+    {"sharedRam", nullptr, &DeviceInfo::shared_ram},
+    {"bufferRam", nullptr, &DeviceInfo::buffer_ram},
+    {"totalSwap", nullptr, &DeviceInfo::total_swap},
+    {"freeSwap", nullptr, &DeviceInfo::free_swap},
+    {"processes", nullptr, &DeviceInfo::processes},
+    {"uptime", nullptr, &DeviceInfo::uptime},
+    {"numberOfProcessors", nullptr, &DeviceInfo::number_of_processors},
+    {"cpuModel", &DeviceInfo::cpu_model, nullptr},
+    {"distributionName", &DeviceInfo::distribution_name, nullptr},
+    {"distributionVersion", &DeviceInfo::distribution_version, nullptr},
+    {"availableRam", nullptr, &DeviceInfo::available_ram},
+    {"cachedRam", nullptr, &DeviceInfo::cached_ram},
+    {"dirtyRam", nullptr, &DeviceInfo::dirty_ram},
+    {"writebackRam", nullptr, &DeviceInfo::writeback_ram},
+    {"slabReclaimable", nullptr, &DeviceInfo::slab_reclaimable},
+    {"swapCached", nullptr, &DeviceInfo::swap_cached},
+    {"swapInPages", nullptr, &DeviceInfo::swap_in_pages},
+    {"swapOutPages", nullptr, &DeviceInfo::swap_out_pages},
+    {"allowedProcessors", nullptr, &DeviceInfo::allowed_processors},
+    {"effectiveProcessors", nullptr, &DeviceInfo::effective_processors},
+    {"computerName", &DeviceInfo::computer_name, nullptr},
+    {"majorVersion", nullptr, &DeviceInfo::major_version},
+    {"minorVersion", nullptr, &DeviceInfo::minor_version},
+    {"buildNumber", nullptr, &DeviceInfo::build_number},
+    {"platformId", nullptr, &DeviceInfo::platform_id},
+    {"processorArchitecture", nullptr, &DeviceInfo::processor_architecture},
+    {"totalPhysicalMemory", nullptr, &DeviceInfo::total_physical_memory},
+    {"availablePhysicalMemory", nullptr,
+     &DeviceInfo::available_physical_memory},
+    {"totalVirtualMemory", nullptr, &DeviceInfo::total_virtual_memory},
+    {"availableVirtualMemory", nullptr,
+     &DeviceInfo::available_virtual_memory},
+    {"processorArchitectureString", &DeviceInfo::processor_architecture_string,
+     nullptr},
+};
+
+const DeviceInfoField* device_info_find_field(const char* key) {
+  for (const DeviceInfoField& field : kDeviceInfoFields) {
+    if (strcmp(field.key, key) == 0) return &field;
+  }
+  return nullptr;
+}
+
+bool device_info_get(const DeviceInfo& info,
+                     const DeviceInfoField& field,
+                     DeviceInfoValue* value) {
+  if (field.string != nullptr) {
+    const char* string = info.*field.string;
+    if (string == nullptr) return false;
+    *value = device_info_string(string);
+    return true;
+  }
+  const std::optional<int64_t>& number = info.*field.number;
+  if (!number.has_value()) return false;
+  *value = device_info_int(*number);
+  return true;
+}
@@ -0,0 +1,98 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_FIELDS_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_FIELDS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+
+// A getDeviceInfo value: a string if [string] is set, otherwise [number].
+struct DeviceInfoValue {
+  const char* string;
+  int64_t number;
+};
+
+inline DeviceInfoValue device_info_string(const char* value) {
+  return {value, 0};
+}
+
+inline DeviceInfoValue device_info_int(int64_t value) {
+  return {nullptr, value};
+}
+
+// Device information, one member per getDeviceInfo key, filled in by the
+// platform's probes and turned into a channel map by its adapter
+// (device_info_to_fl_value() on Linux, DeviceInfoToEncodableMap() on
+// Windows). Members the platform does not report, or the caller did not ask
+// for, stay unset: null strings and empty optionals. Owns no strings: they
+// point into the data they were read from, which must outlive it.
+struct DeviceInfo {
+  // Every platform.
+  const char* stable_device_id = nullptr;
+  std::optional<int64_t> number_of_processors;
+
+  // Linux.
+  const char* system_name = nullptr;
+  const char* node_name = nullptr;
+  const char* release = nullptr;
+  const char* version = nullptr;
+  const char* machine = nullptr;
+  const char* hostname = nullptr;
+  std::optional<int64_t> total_ram;
+  std::optional<int64_t> free_ram;
+  std::optional<int64_t> shared_ram;
+  std::optional<int64_t> buffer_ram;
+  std::optional<int64_t> total_swap;
+  std::optional<int64_t> free_swap;
+  std::optional<int64_t> processes;
+  std::optional<int64_t> uptime;
+  const char* cpu_model = nullptr;
+  const char* distribution_name = nullptr;
+  const char* distribution_version = nullptr;
+  std::optional<int64_t> available_ram;
+  std::optional<int64_t> cached_ram;
+  std::optional<int64_t> dirty_ram;
+  std::optional<int64_t> writeback_ram;
+  std::optional<int64_t> slab_reclaimable;
+  std::optional<int64_t> swap_cached;
+  std::optional<int64_t> swap_in_pages;
+  std::optional<int64_t> swap_out_pages;
+  std::optional<int64_t> allowed_processors;
+  std::optional<int64_t> effective_processors;
+
+  // Windows.
+  const char* computer_name = nullptr;
+  std::optional<int64_t> major_version;
+  std::optional<int64_t> minor_version;
+  std::optional<int64_t> build_number;
+  std::optional<int64_t> platform_id;
+  std::optional<int64_t> processor_architecture;
+  std::optional<int64_t> total_physical_memory;
+  std::optional<int64_t> available_physical_memory;
+  std::optional<int64_t> total_virtual_memory;
+  std::optional<int64_t> available_virtual_memory;
+  const char* processor_architecture_string = nullptr;
+};
+
+// A DeviceInfo member and its getDeviceInfo key. Exactly one of [string] and
+// [number] is set.
+struct DeviceInfoField {
+  const char* key;
+  const char* DeviceInfo::*string;
+  std::optional<int64_t> DeviceInfo::*number;
+};
+
+constexpr size_t kDeviceInfoFieldCount = 40;
+
+// Every DeviceInfo member, in reporting order.
+extern const DeviceInfoField kDeviceInfoFields[kDeviceInfoFieldCount];
+
+// Returns the field whose key is [key], or nullptr if there is none.
+const DeviceInfoField* device_info_find_field(const char* key);
+
+// Reads [field] of [info] into [value]. Returns false if it is unset.
+bool device_info_get(const DeviceInfo& info,
+                     const DeviceInfoField& field,
+                     DeviceInfoValue* value);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_FIELDS_H_
@@ -0,0 +1,88 @@
+#include "latency_histogram.h"
+
+#include <time.h>
+
+uint64_t latency_now_ns() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000ull +
+         static_cast<uint64_t>(now.tv_nsec);
+}
+
+int latency_histogram_bucket(uint64_t duration_ns) {
+  if (duration_ns < 4) return static_cast<int>(duration_ns);
+  // The top bit picks the power of two, the two bits below it the quarter.
+  int top = 63 - __builtin_clzll(duration_ns);
+  int quarter = static_cast<int>(duration_ns >> (top - 2)) & 3;
+  int bucket = 4 + (top - 2) * 4 + quarter;
+  return bucket < kLatencyHistogramBuckets ? bucket
+                                           : kLatencyHistogramBuckets - 1;
+}
+
+uint64_t latency_histogram_bucket_limit(int bucket) {
+  if (bucket < 4) return static_cast<uint64_t>(bucket);
+  if (bucket == kLatencyHistogramBuckets - 1) return UINT64_MAX;
+  int shift = (bucket - 4) / 4;
+  uint64_t quarter = static_cast<uint64_t>((bucket - 4) % 4);
+  return ((5 + quarter) << shift) - 1;
+}
+
+void latency_histogram_record(LatencyHistogram* histogram,
+                              uint64_t duration_ns,
+                              bool error) {
+  histogram->buckets[latency_histogram_bucket(duration_ns)].fetch_add(
+      1, std::memory_order_relaxed);
+  histogram->total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+  if (error) histogram->errors.fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t max = histogram->max_ns.load(std::memory_order_relaxed);
+  while (duration_ns > max &&
+         !histogram->max_ns.compare_exchange_weak(max, duration_ns,
+                                                  std::memory_order_relaxed)) {
+  }
+}
+
+void latency_histogram_stats(const LatencyHistogram* histogram,
+                             LatencyStats* stats) {
+  uint64_t counts[kLatencyHistogramBuckets];
+  uint64_t count = 0;
+  for (int i = 0; i < kLatencyHistogramBuckets; i++) {
+    counts[i] = histogram->buckets[i].load(std::memory_order_relaxed);
+    count += counts[i];
+  }
+
+  *stats = {};
+  stats->count = count;
+  stats->errors = histogram->errors.load(std::memory_order_relaxed);
+  stats->max_ns = histogram->max_ns.load(std::memory_order_relaxed);
+  if (count == 0) return;
+  stats->mean_ns =
+      histogram->total_ns.load(std::memory_order_relaxed) / count;
+
+  // The smallest bucket limit with at least [per_thousand] of the calls at or
+  // below it.
+  auto percentile = [&](uint64_t per_thousand) {
+    uint64_t rank = (count * per_thousand + 999) / 1000;
+    uint64_t seen = 0;
+    for (int i = 0; i < kLatencyHistogramBuckets; i++) {
+      seen += counts[i];
+      if (seen >= rank) {
+        uint64_t limit = latency_histogram_bucket_limit(i);
+        return limit < stats->max_ns ? limit : stats->max_ns;
+      }
+    }
+    return stats->max_ns;
+  };
+  stats->p50_ns = percentile(500);
+  stats->p90_ns = percentile(900);
+  stats->p99_ns = percentile(990);
+}
+
+void latency_histogram_reset(LatencyHistogram* histogram) {
+  for (std::atomic<uint64_t>& bucket : histogram->buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  histogram->errors.store(0, std::memory_order_relaxed);
+  histogram->total_ns.store(0, std::memory_order_relaxed);
+  histogram->max_ns.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,58 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_LATENCY_HISTOGRAM_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include <atomic>
+
+// Buckets are log-linear: exact below 4 ns, then four per power of two, so a
+// percentile is within 25% of the true value. The last bucket collects
+// everything from about half an hour up.
+constexpr int kLatencyHistogramBuckets = 160;
+
+// Call latencies and error counts for one method or probe. Recording is a
+// few relaxed atomic increments, so any thread may record without locking.
+struct LatencyHistogram {
+  std::atomic<uint64_t> buckets[kLatencyHistogramBuckets];
+  std::atomic<uint64_t> errors;
+  std::atomic<uint64_t> total_ns;
+  std::atomic<uint64_t> max_ns;
+};
+
+// A summary of a LatencyHistogram. Percentiles are bucket upper bounds,
+// capped at the maximum.
+struct LatencyStats {
+  uint64_t count;
+  uint64_t errors;
+  uint64_t mean_ns;
+  uint64_t p50_ns;
+  uint64_t p90_ns;
+  uint64_t p99_ns;
+  uint64_t max_ns;
+};
+
+// Returns CLOCK_MONOTONIC in nanoseconds. Served from the vDSO, so it does
+// not enter the kernel.
+uint64_t latency_now_ns();
+
+// Returns the bucket [duration_ns] falls into.
+int latency_histogram_bucket(uint64_t duration_ns);
+
+// Returns the largest duration that falls into [bucket].
+uint64_t latency_histogram_bucket_limit(int bucket);
+
+// Records one call that took [duration_ns], counting it as an error if
+// [error] is set.
+void latency_histogram_record(LatencyHistogram* histogram,
+                              uint64_t duration_ns,
+                              bool error);
+
+// Summarizes [histogram]. Calls recorded concurrently may or may not be
+// included.
+void latency_histogram_stats(const LatencyHistogram* histogram,
+                             LatencyStats* stats);
+
+// Clears [histogram].
+void latency_histogram_reset(LatencyHistogram* histogram);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,105 @@
+#include "meminfo.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "proc_parser.h"
+#include "string_util.h"
+
+namespace {
+
+struct MemInfoField {
+  std::string_view key;
+  unsigned long long MemInfo::*field;
+};
+
+// The /proc/meminfo lines we keep, in file order.
+constexpr MemInfoField kMemInfoFields[] = {
+    {"MemTotal", &MemInfo::mem_total},
+    {"MemFree", &MemInfo::mem_free},
+    {"MemAvailable", &MemInfo::mem_available},
+    {"Buffers", &MemInfo::buffers},
+    {"Cached", &MemInfo::cached},
+    {"SwapCached", &MemInfo::swap_cached},
+    {"SwapTotal", &MemInfo::swap_total},
+    {"SwapFree", &MemInfo::swap_free},
+    {"Dirty", &MemInfo::dirty},
+    {"Writeback", &MemInfo::writeback},
+    {"SReclaimable", &MemInfo::slab_reclaimable},
+};
+
+constexpr size_t kMemInfoFieldCount =
+    sizeof(kMemInfoFields) / sizeof(kMemInfoFields[0]);
+
+}  // namespace
+
+bool meminfo_parse_line(std::string_view line, MemInfo* info) {
+  size_t colon = line.find(':');
+  if (colon == std::string_view::npos) return false;
+  std::string_view key = line.substr(0, colon);
+
+  for (const MemInfoField& field : kMemInfoFields) {
+    if (key != field.key) continue;
+    std::string_view cursor = line.substr(colon + 1);
+    unsigned long long value = 0;
+    if (!proc_next_u64(&cursor, &value)) return false;
+    // Sizes are reported in kB.
+    if (string_trim(cursor) == "kB") value *= 1024;
+    info->*field.field = value;
+    return true;
+  }
+  return false;
+}
+
+bool vmstat_parse_line(std::string_view line, MemInfo* info) {
+  size_t space = line.find(' ');
+  if (space == std::string_view::npos) return false;
+  std::string_view key = line.substr(0, space);
+  std::string_view cursor = line.substr(space);
+
+  if (key == "pswpin") return proc_next_u64(&cursor, &info->swap_in_pages);
+  if (key == "pswpout") return proc_next_u64(&cursor, &info->swap_out_pages);
+  return false;
+}
+
+void meminfo_reader_open(MemInfoReader* reader,
+                         const char* meminfo_path,
+                         const char* vmstat_path) {
+  reader->meminfo_fd = open(meminfo_path, O_RDONLY | O_CLOEXEC);
+  reader->vmstat_fd = open(vmstat_path, O_RDONLY | O_CLOEXEC);
+}
+
+void meminfo_reader_close(MemInfoReader* reader) {
+  if (reader->meminfo_fd >= 0) close(reader->meminfo_fd);
+  if (reader->vmstat_fd >= 0) close(reader->vmstat_fd);
+  reader->meminfo_fd = -1;
+  reader->vmstat_fd = -1;
+}
+
+bool meminfo_reader_read(const MemInfoReader* reader, MemInfo* info) {
+  if (reader->meminfo_fd < 0) return false;
+  *info = {};
+
+  ProcLineReader lines;
+  std::string_view line;
+  size_t found = 0;
+  bool have_available = false;
+  proc_line_reader_attach(&lines, reader->meminfo_fd);
+  while (found < kMemInfoFieldCount && proc_line_reader_next(&lines, &line)) {
+    if (meminfo_parse_line(line, info)) {
+      found++;
+      if (line.substr(0, 13) == "MemAvailable:") have_available = true;
+    }
+  }
+  if (found == 0) return false;
+  if (!have_available) info->mem_available = info->mem_free;
+
+  // pswpin and pswpout sit in the middle of /proc/vmstat; stop once both
+  // have been seen.
+  int swap_counters = 0;
+  proc_line_reader_attach(&lines, reader->vmstat_fd);
+  while (swap_counters < 2 && proc_line_reader_next(&lines, &line)) {
+    if (vmstat_parse_line(line, info)) swap_counters++;
+  }
+  return true;
+}
@@ -0,0 +1,54 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_MEMINFO_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_MEMINFO_H_
+
+#include <string_view>
+
+// Memory accounting from /proc/meminfo and the swap counters from
+// /proc/vmstat. Sizes are in bytes; fields missing from the files are zero.
+struct MemInfo {
+  unsigned long long mem_total;
+  unsigned long long mem_free;
+  // Estimate of memory available to new work without swapping, including
+  // reclaimable page cache. Falls back to MemFree on kernels before 3.14.
+  unsigned long long mem_available;
+  unsigned long long buffers;
+  unsigned long long cached;
+  unsigned long long swap_cached;
+  unsigned long long dirty;
+  unsigned long long writeback;
+  unsigned long long slab_reclaimable;
+  unsigned long long swap_total;
+  unsigned long long swap_free;
+  // Pages swapped in and out since boot.
+  unsigned long long swap_in_pages;
+  unsigned long long swap_out_pages;
+};
+
+// Applies one /proc/meminfo line to [info]. Returns false for lines that
+// carry no field MemInfo tracks.
+bool meminfo_parse_line(std::string_view line, MemInfo* info);
+
+// Applies one /proc/vmstat line to [info]. Returns false for lines that carry
+// no field MemInfo tracks.
+bool vmstat_parse_line(std::string_view line, MemInfo* info);
+
+// Keeps /proc/meminfo and /proc/vmstat open so each sample is two pread()
+// passes from offset 0 and no open() or close(). The descriptors are only
+// read with pread(), so one reader can be sampled from several threads.
+struct MemInfoReader {
+  int meminfo_fd;
+  int vmstat_fd;
+};
+
+// Opens the files. Either descriptor may end up as -1 if its file is missing.
+void meminfo_reader_open(MemInfoReader* reader,
+                         const char* meminfo_path,
+                         const char* vmstat_path);
+
+void meminfo_reader_close(MemInfoReader* reader);
+
+// Takes one sample into [info]. Returns false if /proc/meminfo could not be
+// read.
+bool meminfo_reader_read(const MemInfoReader* reader, MemInfo* info);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_MEMINFO_H_
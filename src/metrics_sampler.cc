@@ -0,0 +1,209 @@
+#include "metrics_sampler.h"
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "proc_parser.h"
+
+// Parses a load average such as "0.52" and advances [cursor] past it.
+static bool next_load(std::string_view* cursor, double* value) {
+  unsigned long long whole = 0;
+  if (!proc_next_u64(cursor, &whole)) return false;
+  *value = static_cast<double>(whole);
+  if (cursor->empty() || cursor->front() != '.') return true;
+  cursor->remove_prefix(1);
+  double scale = 0.1;
+  while (!cursor->empty() && cursor->front() >= '0' && cursor->front() <= '9') {
+    *value += (cursor->front() - '0') * scale;
+    scale /= 10;
+    cursor->remove_prefix(1);
+  }
+  return true;
+}
+
+bool loadavg_parse(std::string_view line, LoadAvg* loadavg) {
+  if (!next_load(&line, &loadavg->load1) ||
+      !next_load(&line, &loadavg->load5) ||
+      !next_load(&line, &loadavg->load15) ||
+      !proc_next_u64(&line, &loadavg->running)) {
+    return false;
+  }
+  if (line.empty() || line.front() != '/') return false;
+  line.remove_prefix(1);
+  return proc_next_u64(&line, &loadavg->total);
+}
+
+// The published sample and its sequence number, on cache lines of their own
+// so that readers polling it never share a line with the sampler's other
+// state. The sequence is odd while a refresh is being written.
+struct alignas(64) MetricsSeqlock {
+  std::atomic<uint32_t> sequence{0};
+  MetricsSample sample = {};
+};
+
+struct _MetricsSampler {
+  MetricsSeqlock published;
+
+  // Descriptors kept open for pread(); -1 if the file is missing.
+  MemInfoReader meminfo_reader;
+  int loadavg_fd;
+  int stat_fd;
+
+  // Only touched by the sampler thread, or by metrics_sampler_start() before
+  // the thread exists.
+  uint64_t refreshes;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  // Guarded by [mutex].
+  unsigned metrics;
+  unsigned interval_ms;
+  bool reconfigured;
+  bool stopping;
+
+  std::thread thread;
+};
+
+static void sampler_refresh(MetricsSampler* sampler, unsigned metrics) {
+  MetricsSample sample = {};
+  sample.refreshes = ++sampler->refreshes;
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  sample.timestamp_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000ull +
+                        static_cast<uint64_t>(now.tv_nsec);
+
+  if ((metrics & kMetricSysinfo) && sysinfo(&sample.sys_info) == 0) {
+    sample.metrics |= kMetricSysinfo;
+  }
+
+  if ((metrics & kMetricMeminfo) &&
+      meminfo_reader_read(&sampler->meminfo_reader, &sample.meminfo)) {
+    sample.metrics |= kMetricMeminfo;
+  }
+
+  ProcLineReader lines;
+  std::string_view line;
+  if (metrics & kMetricLoadavg) {
+    proc_line_reader_attach(&lines, sampler->loadavg_fd);
+    if (proc_line_reader_next(&lines, &line) &&
+        loadavg_parse(line, &sample.loadavg)) {
+      sample.metrics |= kMetricLoadavg;
+    }
+  }
+
+  // The aggregate line comes first, so one line is all that is read.
+  if (metrics & kMetricCpuTimes) {
+    proc_line_reader_attach(&lines, sampler->stat_fd);
+    if (proc_line_reader_next(&lines, &line) &&
+        proc_stat_parse_cpu_line(line, &sample.cpu_times) &&
+        sample.cpu_times.cpu == -1) {
+      sample.metrics |= kMetricCpuTimes;
+    }
+  }
+
+  // Single writer: bump the sequence to odd, write, bump it back to even.
+  MetricsSeqlock* published = &sampler->published;
+  uint32_t sequence = published->sequence.load(std::memory_order_relaxed);
+  published->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(&published->sample, &sample, sizeof(sample));
+  published->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+static void sampler_run(MetricsSampler* sampler) {
+  std::unique_lock<std::mutex> lock(sampler->mutex);
+  while (!sampler->stopping) {
+    if (sampler->metrics == 0) {
+      sampler->wake.wait(lock, [sampler] {
+        return sampler->stopping || sampler->reconfigured;
+      });
+    } else {
+      sampler->wake.wait_for(
+          lock, std::chrono::milliseconds(sampler->interval_ms),
+          [sampler] { return sampler->stopping || sampler->reconfigured; });
+    }
+    if (sampler->stopping) break;
+    sampler->reconfigured = false;
+
+    unsigned metrics = sampler->metrics;
+    lock.unlock();
+    sampler_refresh(sampler, metrics);
+    lock.lock();
+  }
+}
+
+static int open_proc_file(const char* proc_dir, const char* name) {
+  std::string path = std::string(proc_dir) + "/" + name;
+  return open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+MetricsSampler* metrics_sampler_start(const char* proc_dir,
+                                      unsigned metrics,
+                                      unsigned interval_ms) {
+  MetricsSampler* sampler = new MetricsSampler();
+  std::string meminfo_path = std::string(proc_dir) + "/meminfo";
+  std::string vmstat_path = std::string(proc_dir) + "/vmstat";
+  meminfo_reader_open(&sampler->meminfo_reader, meminfo_path.c_str(),
+                      vmstat_path.c_str());
+  sampler->loadavg_fd = open_proc_file(proc_dir, "loadavg");
+  sampler->stat_fd = open_proc_file(proc_dir, "stat");
+  sampler->refreshes = 0;
+  sampler->metrics = metrics & kAllMetrics;
+  sampler->interval_ms = interval_ms;
+  sampler->reconfigured = false;
+  sampler->stopping = false;
+
+  // Readers see a complete sample as soon as the sampler is returned.
+  sampler_refresh(sampler, sampler->metrics);
+  sampler->thread = std::thread(sampler_run, sampler);
+  return sampler;
+}
+
+void metrics_sampler_configure(MetricsSampler* sampler,
+                               unsigned metrics,
+                               unsigned interval_ms) {
+  {
+    std::lock_guard<std::mutex> lock(sampler->mutex);
+    sampler->metrics = metrics & kAllMetrics;
+    sampler->interval_ms = interval_ms;
+    sampler->reconfigured = true;
+  }
+  sampler->wake.notify_one();
+}
+
+bool metrics_sampler_read(const MetricsSampler* sampler,
+                          MetricsSample* sample) {
+  const MetricsSeqlock* published = &sampler->published;
+  for (;;) {
+    uint32_t before = published->sequence.load(std::memory_order_acquire);
+    if (before & 1) continue;
+    memcpy(sample, &published->sample, sizeof(*sample));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (published->sequence.load(std::memory_order_relaxed) == before) break;
+  }
+  return sample->metrics != 0;
+}
+
+void metrics_sampler_stop(MetricsSampler* sampler) {
+  {
+    std::lock_guard<std::mutex> lock(sampler->mutex);
+    sampler->stopping = true;
+  }
+  sampler->wake.notify_one();
+  sampler->thread.join();
+
+  meminfo_reader_close(&sampler->meminfo_reader);
+  if (sampler->loadavg_fd >= 0) close(sampler->loadavg_fd);
+  if (sampler->stat_fd >= 0) close(sampler->stat_fd);
+  delete sampler;
+}
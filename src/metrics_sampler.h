@@ -0,0 +1,83 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_METRICS_SAMPLER_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_METRICS_SAMPLER_H_
+
+#include <stdint.h>
+#include <sys/sysinfo.h>
+
+#include <string_view>
+
+#include "cpu_usage.h"
+#include "meminfo.h"
+
+// Groups of dynamic metrics the background sampler can refresh.
+enum MetricsSamplerMetric : unsigned {
+  // One sysinfo() call: RAM, swap, process count, uptime and load averages.
+  kMetricSysinfo = 1 << 0,
+  // /proc/meminfo and /proc/vmstat, through MemInfoReader.
+  kMetricMeminfo = 1 << 1,
+  // /proc/loadavg, which adds runnable and total task counts.
+  kMetricLoadavg = 1 << 2,
+  // The aggregate "cpu" line of /proc/stat.
+  kMetricCpuTimes = 1 << 3,
+};
+
+static const unsigned kAllMetrics =
+    kMetricSysinfo | kMetricMeminfo | kMetricLoadavg | kMetricCpuTimes;
+
+// The contents of /proc/loadavg.
+struct LoadAvg {
+  double load1;
+  double load5;
+  double load15;
+  // Runnable scheduling entities and all of them.
+  unsigned long long running;
+  unsigned long long total;
+};
+
+// Parses a /proc/loadavg line such as "0.52 0.58 0.59 2/1234 5678". Returns
+// false if the line is malformed.
+bool loadavg_parse(std::string_view line, LoadAvg* loadavg);
+
+// One refresh of the metric groups in [metrics]; groups that were not
+// sampled are zero.
+struct MetricsSample {
+  unsigned metrics;
+  // CLOCK_MONOTONIC time of the refresh.
+  uint64_t timestamp_ns;
+  // Number of refreshes since the sampler started.
+  uint64_t refreshes;
+  struct sysinfo sys_info;
+  MemInfo meminfo;
+  LoadAvg loadavg;
+  CpuTimes cpu_times;
+};
+
+// Refreshes MetricsSample on a background thread and publishes it through a
+// seqlock, so readers on any thread get the latest sample with a plain copy
+// and no syscall. Readers never block the sampler and only retry while a
+// refresh is being published.
+typedef struct _MetricsSampler MetricsSampler;
+
+// Takes a first sample of [metrics] from the files under [proc_dir]
+// (normally "/proc") on the calling thread, then starts refreshing it every
+// [interval_ms] milliseconds.
+MetricsSampler* metrics_sampler_start(const char* proc_dir,
+                                      unsigned metrics,
+                                      unsigned interval_ms);
+
+// Changes the sampled groups and the interval and refreshes right away.
+// With [metrics] zero the thread publishes an empty sample and sleeps until
+// it is reconfigured.
+void metrics_sampler_configure(MetricsSampler* sampler,
+                               unsigned metrics,
+                               unsigned interval_ms);
+
+// Copies the latest sample into [sample]. Safe to call from any thread
+// while the sampler is running. Returns false if no group is being sampled.
+bool metrics_sampler_read(const MetricsSampler* sampler,
+                          MetricsSample* sample);
+
+// Stops the thread, waiting for an in-progress refresh, and frees [sampler].
+void metrics_sampler_stop(MetricsSampler* sampler);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_METRICS_SAMPLER_H_
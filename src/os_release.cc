@@ -0,0 +1,40 @@
+#include "os_release.h"
+
+#include "string_util.h"
+
+std::string_view os_release_unquote(std::string_view value) {
+  if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') &&
+      value.back() == value.front()) {
+    return value.substr(1, value.size() - 2);
+  }
+  return value;
+}
+
+bool os_release_parse_line(std::string_view line,
+                           std::string_view* key,
+                           std::string_view* value) {
+  line = string_trim(line);
+  if (line.empty() || line.front() == '#') return false;
+  size_t equals = line.find('=');
+  if (equals == std::string_view::npos) return false;
+  *key = line.substr(0, equals);
+  *value = os_release_unquote(line.substr(equals + 1));
+  return true;
+}
+
+void os_release_unescape(std::string_view value, std::string* out) {
+  out->clear();
+  size_t start = 0;
+  for (size_t i = 0; i + 1 < value.size(); i++) {
+    char next = value[i + 1];
+    if (value[i] != '\\' ||
+        (next != '"' && next != '\\' && next != '`' && next != '$')) {
+      continue;
+    }
+    out->append(value.data() + start, i - start);
+    start = i + 1;
+    // Skip the escaped character, so \\ yields a single backslash.
+    i++;
+  }
+  out->append(value.data() + start, value.size() - start);
+}
@@ -0,0 +1,21 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_OS_RELEASE_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_OS_RELEASE_H_
+
+#include <string>
+#include <string_view>
+
+// Removes one pair of matching single or double quotes around [value].
+std::string_view os_release_unquote(std::string_view value);
+
+// Splits an os-release line into [key] and unquoted [value]. Returns false
+// for blank lines, comments and lines without '='.
+bool os_release_parse_line(std::string_view line,
+                           std::string_view* key,
+                           std::string_view* value);
+
+// Copies [value], as returned by os_release_parse_line(), to [out] with the
+// shell escapes \", \\, \` and \$ resolved. os-release(5) allows them in
+// double-quoted values; a backslash before any other character is kept.
+void os_release_unescape(std::string_view value, std::string* out);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_OS_RELEASE_H_
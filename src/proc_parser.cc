@@ -0,0 +1,227 @@
+#include "proc_parser.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <algorithm>
+#include <cstring>
+
+#include "string_util.h"
+#include "trace_recorder.h"
+
+void proc_line_reader_attach(ProcLineReader* reader, int fd) {
+  reader->fd = fd;
+  reader->owns_fd = false;
+  reader->offset = 0;
+  reader->start = 0;
+  reader->end = 0;
+  reader->eof = fd < 0;
+  reader->skipping = false;
+}
+
+bool proc_line_reader_open(ProcLineReader* reader, const char* path) {
+  proc_line_reader_attach(reader, open(path, O_RDONLY | O_CLOEXEC));
+  reader->owns_fd = true;
+  return reader->fd >= 0;
+}
+
+void proc_line_reader_close(ProcLineReader* reader) {
+  if (reader->owns_fd && reader->fd >= 0) {
+    close(reader->fd);
+    reader->fd = -1;
+  }
+}
+
+bool proc_line_reader_next(ProcLineReader* reader, std::string_view* line) {
+  for (;;) {
+    const char* begin = reader->buffer + reader->start;
+    size_t available = reader->end - reader->start;
+    const char* newline =
+        static_cast<const char*>(memchr(begin, '\n', available));
+    if (newline != nullptr) {
+      size_t length = static_cast<size_t>(newline - begin);
+      reader->start += length + 1;
+      if (reader->skipping) {
+        // This was the tail of an over-long line that was already returned.
+        reader->skipping = false;
+        continue;
+      }
+      *line = std::string_view(begin, length);
+      return true;
+    }
+
+    if (reader->eof) {
+      if (available == 0 || reader->skipping) {
+        reader->start = reader->end;
+        return false;
+      }
+      // Last line without a trailing newline.
+      reader->start = reader->end;
+      *line = std::string_view(begin, available);
+      return true;
+    }
+
+    // Move the partial line to the front and refill behind it.
+    if (reader->start > 0) {
+      memmove(reader->buffer, begin, available);
+      reader->start = 0;
+      reader->end = available;
+    }
+    if (reader->end == sizeof(reader->buffer)) {
+      // The line does not fit. Hand out what we have and drop the rest.
+      reader->start = 0;
+      reader->end = 0;
+      if (!reader->skipping) {
+        reader->skipping = true;
+        *line = std::string_view(reader->buffer, sizeof(reader->buffer));
+        return true;
+      }
+    }
+
+    ssize_t n;
+    {
+      TraceScope trace("io", "pread");
+      n = pread(reader->fd, reader->buffer + reader->end,
+                sizeof(reader->buffer) - reader->end, reader->offset);
+    }
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      reader->eof = true;
+    } else {
+      reader->end += static_cast<size_t>(n);
+      reader->offset += n;
+    }
+  }
+}
+
+bool proc_next_u64(std::string_view* cursor, unsigned long long* value) {
+  size_t i = 0;
+  while (i < cursor->size() && ((*cursor)[i] == ' ' || (*cursor)[i] == '\t')) {
+    i++;
+  }
+  size_t digits_start = i;
+  unsigned long long result = 0;
+  while (i < cursor->size() && (*cursor)[i] >= '0' && (*cursor)[i] <= '9') {
+    result = result * 10 + static_cast<unsigned long long>((*cursor)[i] - '0');
+    i++;
+  }
+  if (i == digits_start) return false;
+  *value = result;
+  cursor->remove_prefix(i);
+  return true;
+}
+
+bool cpuinfo_read_model_name(const char* path, std::string* model) {
+  static constexpr std::string_view kModelName = "model name";
+
+  ProcLineReader reader;
+  if (!proc_line_reader_open(&reader, path)) return false;
+
+  bool found = false;
+  std::string_view line;
+  while (proc_line_reader_next(&reader, &line)) {
+    if (line.substr(0, kModelName.size()) != kModelName) continue;
+    size_t colon = line.find(':', kModelName.size());
+    if (colon == std::string_view::npos) continue;
+    std::string_view value = string_trim(line.substr(colon + 1));
+    model->assign(value.data(), value.size());
+    found = true;
+    break;
+  }
+
+  proc_line_reader_close(&reader);
+  return found;
+}
+
+bool os_release_read(const char* path, std::string* name, std::string* version) {
+  ProcLineReader reader;
+  if (!proc_line_reader_open(&reader, path)) return false;
+
+  std::string_view line;
+  std::string_view key;
+  std::string_view value;
+  while (proc_line_reader_next(&reader, &line)) {
+    if (!os_release_parse_line(line, &key, &value)) continue;
+    if (key == "NAME") {
+      os_release_unescape(value, name);
+    } else if (key == "VERSION") {
+      os_release_unescape(value, version);
+    }
+  }
+
+  proc_line_reader_close(&reader);
+  return true;
+}
+
+bool sysfs_list_numbered(int dirfd,
+                         const char* path,
+                         std::string_view prefix,
+                         std::vector<int>* numbers) {
+  numbers->clear();
+  int fd = openat(dirfd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) return false;
+  bool listed = dir_list_numbered(fd, prefix, numbers);
+  close(fd);
+  return listed;
+}
+
+bool dir_list_numbered(int fd,
+                       std::string_view prefix,
+                       std::vector<int>* numbers) {
+  TraceScope trace("io", "getdents64");
+  numbers->clear();
+  if (lseek(fd, 0, SEEK_SET) < 0) return false;
+
+  // struct linux_dirent64 records, packed back to back.
+  alignas(8) char buffer[8192];
+  for (;;) {
+    long n = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    for (long offset = 0; offset < n;) {
+      auto* entry = reinterpret_cast<struct dirent64*>(buffer + offset);
+      offset += entry->d_reclen;
+      std::string_view name = entry->d_name;
+      if (name.substr(0, prefix.size()) != prefix) continue;
+      std::string_view number = name.substr(prefix.size());
+      unsigned long long value = 0;
+      if (!number.empty() && number.front() >= '0' && number.front() <= '9' &&
+          proc_next_u64(&number, &value) && number.empty()) {
+        numbers->push_back(static_cast<int>(value));
+      }
+    }
+  }
+
+  std::sort(numbers->begin(), numbers->end());
+  return true;
+}
+
+bool sysfs_read_line_at(int dirfd,
+                        const char* path,
+                        char* buffer,
+                        size_t size,
+                        std::string_view* line) {
+  TraceScope trace("io", "sysfs_read");
+  int fd = openat(dirfd, path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  ssize_t n;
+  do {
+    n = pread(fd, buffer, size, 0);
+  } while (n < 0 && errno == EINTR);
+  close(fd);
+  if (n < 0) return false;
+
+  std::string_view text(buffer, static_cast<size_t>(n));
+  *line = string_trim(text.substr(0, text.find('\n')));
+  return true;
+}
+
+bool sysfs_read_u64_at(int dirfd, const char* path, unsigned long long* value) {
+  char buffer[32];
+  std::string_view line;
+  return sysfs_read_line_at(dirfd, path, buffer, sizeof(buffer), &line) &&
+         proc_next_u64(&line, value);
+}
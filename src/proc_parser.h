@@ -0,0 +1,91 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_PROC_PARSER_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_PROC_PARSER_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "os_release.h"
+
+// Size of the line buffer embedded in ProcLineReader. Lines longer than this
+// are returned truncated to the first kProcLineReaderBufferSize bytes.
+constexpr size_t kProcLineReaderBufferSize = 4096;
+
+// Reads a file line by line through a fixed buffer, using pread() and
+// memchr() and never allocating. Meant to live on the stack.
+struct ProcLineReader {
+  int fd;
+  bool owns_fd;
+  off_t offset;
+  size_t start;
+  size_t end;
+  bool eof;
+  bool skipping;
+  char buffer[kProcLineReaderBufferSize];
+};
+
+// Opens [path] for reading. Returns false if the file cannot be opened.
+bool proc_line_reader_open(ProcLineReader* reader, const char* path);
+
+// Starts reading [fd] from offset 0 without taking ownership of it. Lets a
+// long-lived descriptor be re-read with pread() instead of reopening the file
+// on every sample.
+void proc_line_reader_attach(ProcLineReader* reader, int fd);
+
+// Closes the file opened by proc_line_reader_open(). Does nothing for an
+// attached descriptor. Safe to call twice.
+void proc_line_reader_close(ProcLineReader* reader);
+
+// Stores the next line, without its trailing newline, in [line]. The view
+// points into the reader's buffer and is only valid until the next call.
+// Returns false at end of file.
+bool proc_line_reader_next(ProcLineReader* reader, std::string_view* line);
+
+// Parses the unsigned decimal number at the start of [cursor], after any
+// spaces or tabs, and advances [cursor] past it. Returns false if there is no
+// number.
+bool proc_next_u64(std::string_view* cursor, unsigned long long* value);
+
+// Copies the first "model name" value from a /proc/cpuinfo style file into
+// [model]. Returns false if the file has no such entry. Does not allocate
+// unless [model] has to grow.
+bool cpuinfo_read_model_name(const char* path, std::string* model);
+
+// Copies NAME and VERSION from an os-release file into [name] and [version].
+// Entries missing from the file leave the outputs untouched. Returns false if
+// the file cannot be opened. Does not allocate unless the outputs have to
+// grow.
+bool os_release_read(const char* path, std::string* name, std::string* version);
+
+// Lists the entries of the directory [path], relative to the directory
+// descriptor [dirfd], that are named [prefix] followed by a number, such as
+// "cpu12" for prefix "cpu", and stores the numbers in ascending order. Reads
+// the directory with getdents64() in one pass. Returns false if the directory
+// cannot be opened.
+bool sysfs_list_numbered(int dirfd,
+                         const char* path,
+                         std::string_view prefix,
+                         std::vector<int>* numbers);
+
+// Like sysfs_list_numbered(), but lists the open directory [fd] from its
+// start, so a directory that is listed on every sample is only opened once.
+bool dir_list_numbered(int fd,
+                       std::string_view prefix,
+                       std::vector<int>* numbers);
+
+// Reads the first line of the small file [path], relative to [dirfd], into
+// [buffer] and points [line] at it, trimmed. Returns false if the file
+// cannot be read.
+bool sysfs_read_line_at(int dirfd,
+                        const char* path,
+                        char* buffer,
+                        size_t size,
+                        std::string_view* line);
+
+// Reads the unsigned number at the start of [path], relative to [dirfd].
+bool sysfs_read_u64_at(int dirfd, const char* path, unsigned long long* value);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_PROC_PARSER_H_
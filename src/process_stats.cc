@@ -0,0 +1,252 @@
+#include "process_stats.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "latency_histogram.h"
+#include "proc_parser.h"
+#include "string_util.h"
+#include "trace_recorder.h"
+
+namespace {
+
+struct ProcessStatsField {
+  std::string_view key;
+  unsigned long long ProcessStats::*field;
+};
+
+// The /proc/self/status lines we keep, in file order.
+constexpr ProcessStatsField kStatusFields[] = {
+    {"VmHWM", &ProcessStats::vm_hwm},
+    {"RssAnon", &ProcessStats::rss_anon},
+    {"RssFile", &ProcessStats::rss_file},
+    {"RssShmem", &ProcessStats::rss_shmem},
+    {"VmSwap", &ProcessStats::vm_swap},
+    {"Threads", &ProcessStats::threads},
+    {"voluntary_ctxt_switches", &ProcessStats::voluntary_context_switches},
+    {"nonvoluntary_ctxt_switches",
+     &ProcessStats::involuntary_context_switches},
+};
+
+// The /proc/self/io lines we keep, in file order.
+constexpr ProcessStatsField kIoFields[] = {
+    {"rchar", &ProcessStats::read_chars},
+    {"wchar", &ProcessStats::write_chars},
+    {"read_bytes", &ProcessStats::read_bytes},
+    {"write_bytes", &ProcessStats::write_bytes},
+};
+
+constexpr size_t kStatusFieldCount =
+    sizeof(kStatusFields) / sizeof(kStatusFields[0]);
+constexpr size_t kIoFieldCount = sizeof(kIoFields) / sizeof(kIoFields[0]);
+
+// Applies a "Key: value [kB]" line to the matching entry of [fields].
+template <size_t N>
+bool parse_keyed_line(std::string_view line,
+                      const ProcessStatsField (&fields)[N],
+                      ProcessStats* stats) {
+  size_t colon = line.find(':');
+  if (colon == std::string_view::npos) return false;
+  std::string_view key = line.substr(0, colon);
+
+  for (const ProcessStatsField& field : fields) {
+    if (key != field.key) continue;
+    std::string_view cursor = line.substr(colon + 1);
+    unsigned long long value = 0;
+    if (!proc_next_u64(&cursor, &value)) return false;
+    if (string_trim(cursor) == "kB") value *= 1024;
+    stats->*field.field = value;
+    return true;
+  }
+  return false;
+}
+
+// Opens [name] under the directory [dirfd], or returns -1.
+int open_at(int dirfd, const char* name) {
+  return dirfd < 0 ? -1 : openat(dirfd, name, O_RDONLY | O_CLOEXEC);
+}
+
+// Reads the single-line file [fd] into [buffer] and points [line] at it.
+bool read_line(int fd, char* buffer, size_t size, std::string_view* line) {
+  if (fd < 0) return false;
+  ssize_t length;
+  {
+    TraceScope trace("io", "pread");
+    length = pread(fd, buffer, size, 0);
+  }
+  if (length <= 0) return false;
+  std::string_view text(buffer, static_cast<size_t>(length));
+  *line = string_trim(text.substr(0, text.find('\n')));
+  return true;
+}
+
+}  // namespace
+
+bool proc_stat_split(std::string_view line,
+                     std::string_view* name,
+                     char* state,
+                     unsigned long long* fields,
+                     size_t count) {
+  size_t open_paren = line.find('(');
+  size_t close_paren = line.rfind(')');
+  if (open_paren == std::string_view::npos ||
+      close_paren == std::string_view::npos || close_paren < open_paren) {
+    return false;
+  }
+  *name = line.substr(open_paren + 1, close_paren - open_paren - 1);
+
+  std::string_view cursor = string_trim(line.substr(close_paren + 1));
+  if (cursor.empty()) return false;
+  *state = cursor.front();
+  cursor.remove_prefix(1);
+  for (size_t i = 0; i < count; i++) {
+    while (!cursor.empty() && cursor.front() == ' ') cursor.remove_prefix(1);
+    if (!cursor.empty() && cursor.front() == '-') cursor.remove_prefix(1);
+    if (!proc_next_u64(&cursor, &fields[i])) return false;
+  }
+  return true;
+}
+
+bool process_stat_parse(std::string_view line,
+                        long ticks_per_second,
+                        ProcessStats* stats) {
+  // Fields 4 to 15: ppid, pgrp, session, tty_nr, tpgid, flags, minflt,
+  // cminflt, majflt, cmajflt, utime and stime.
+  std::string_view name;
+  char state;
+  unsigned long long fields[12];
+  if (!proc_stat_split(line, &name, &state, fields, 12)) return false;
+  stats->minor_faults = fields[6];
+  stats->major_faults = fields[8];
+  if (ticks_per_second > 0) {
+    stats->user_time_ms = fields[10] * 1000 / ticks_per_second;
+    stats->system_time_ms = fields[11] * 1000 / ticks_per_second;
+  }
+  return true;
+}
+
+bool process_statm_parse(std::string_view line,
+                         long page_size,
+                         ProcessStats* stats) {
+  unsigned long long size = 0;
+  unsigned long long resident = 0;
+  if (!proc_next_u64(&line, &size) || !proc_next_u64(&line, &resident)) {
+    return false;
+  }
+  stats->vm_size = size * page_size;
+  stats->rss = resident * page_size;
+  return true;
+}
+
+bool process_status_parse_line(std::string_view line, ProcessStats* stats) {
+  return parse_keyed_line(line, kStatusFields, stats);
+}
+
+bool process_io_parse_line(std::string_view line, ProcessStats* stats) {
+  return parse_keyed_line(line, kIoFields, stats);
+}
+
+bool process_smaps_rollup_parse_line(std::string_view line,
+                                     ProcessStats* stats) {
+  static constexpr ProcessStatsField kPss[] = {{"Pss", &ProcessStats::pss}};
+  return parse_keyed_line(line, kPss, stats);
+}
+
+void process_stats_reader_open(ProcessStatsReader* reader,
+                               const char* proc_dir) {
+  int dirfd = open(proc_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  reader->stat_fd = open_at(dirfd, "stat");
+  reader->statm_fd = open_at(dirfd, "statm");
+  reader->status_fd = open_at(dirfd, "status");
+  reader->io_fd = open_at(dirfd, "io");
+  reader->smaps_rollup_fd = open_at(dirfd, "smaps_rollup");
+  if (dirfd >= 0) close(dirfd);
+  reader->ticks_per_second = sysconf(_SC_CLK_TCK);
+  reader->page_size = sysconf(_SC_PAGESIZE);
+}
+
+void process_stats_reader_close(ProcessStatsReader* reader) {
+  for (int* fd : {&reader->stat_fd, &reader->statm_fd, &reader->status_fd,
+                  &reader->io_fd, &reader->smaps_rollup_fd}) {
+    if (*fd >= 0) close(*fd);
+    *fd = -1;
+  }
+}
+
+bool process_stats_reader_read(const ProcessStatsReader* reader,
+                               bool pss,
+                               ProcessStats* stats) {
+  *stats = {};
+  stats->timestamp_ns = latency_now_ns();
+
+  // stat is a few hundred bytes and statm a few dozen.
+  char buffer[1024];
+  std::string_view line;
+  if (!read_line(reader->stat_fd, buffer, sizeof(buffer), &line) ||
+      !process_stat_parse(line, reader->ticks_per_second, stats)) {
+    return false;
+  }
+  if (read_line(reader->statm_fd, buffer, sizeof(buffer), &line)) {
+    process_statm_parse(line, reader->page_size, stats);
+  }
+
+  if (reader->status_fd < 0) return false;
+  ProcLineReader lines;
+  size_t found = 0;
+  proc_line_reader_attach(&lines, reader->status_fd);
+  while (found < kStatusFieldCount && proc_line_reader_next(&lines, &line)) {
+    if (process_status_parse_line(line, stats)) found++;
+  }
+  if (found == 0) return false;
+
+  if (reader->io_fd >= 0) {
+    found = 0;
+    proc_line_reader_attach(&lines, reader->io_fd);
+    while (found < kIoFieldCount && proc_line_reader_next(&lines, &line)) {
+      if (process_io_parse_line(line, stats)) found++;
+    }
+    stats->has_io = found > 0;
+  }
+
+  // Pss is the second line of smaps_rollup, after the summary line.
+  if (pss && reader->smaps_rollup_fd >= 0) {
+    proc_line_reader_attach(&lines, reader->smaps_rollup_fd);
+    while (!stats->has_pss && proc_line_reader_next(&lines, &line)) {
+      stats->has_pss = process_smaps_rollup_parse_line(line, stats);
+    }
+  }
+  return true;
+}
+
+ProcessStatsDelta process_stats_between(const ProcessStats& before,
+                                        const ProcessStats& after) {
+  auto delta = [](unsigned long long a, unsigned long long b) {
+    return b > a ? b - a : 0ull;
+  };
+  auto signed_delta = [](unsigned long long a, unsigned long long b) {
+    return static_cast<long long>(b) - static_cast<long long>(a);
+  };
+
+  ProcessStatsDelta result = {};
+  if (after.timestamp_ns > before.timestamp_ns) {
+    result.interval_ms = (after.timestamp_ns - before.timestamp_ns) / 1e6;
+  }
+  result.rss = signed_delta(before.rss, after.rss);
+  if (before.has_pss && after.has_pss) {
+    result.pss = signed_delta(before.pss, after.pss);
+  }
+  result.minor_faults = delta(before.minor_faults, after.minor_faults);
+  result.major_faults = delta(before.major_faults, after.major_faults);
+  result.voluntary_context_switches = delta(before.voluntary_context_switches,
+                                            after.voluntary_context_switches);
+  result.involuntary_context_switches =
+      delta(before.involuntary_context_switches,
+            after.involuntary_context_switches);
+  result.user_time_ms = delta(before.user_time_ms, after.user_time_ms);
+  result.system_time_ms = delta(before.system_time_ms, after.system_time_ms);
+  if (before.has_io && after.has_io) {
+    result.read_bytes = delta(before.read_bytes, after.read_bytes);
+    result.write_bytes = delta(before.write_bytes, after.write_bytes);
+  }
+  return result;
+}
@@ -0,0 +1,136 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_PROCESS_STATS_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_PROCESS_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+// Resource usage of the calling process from /proc/self. Sizes are in bytes
+// and CPU times in milliseconds; fields missing from the files are zero.
+struct ProcessStats {
+  // latency_now_ns() when the sample was taken.
+  uint64_t timestamp_ns;
+
+  // From statm.
+  unsigned long long vm_size;
+  unsigned long long rss;
+
+  // From status. RssAnon, RssFile and RssShmem need Linux 4.5.
+  unsigned long long vm_hwm;
+  unsigned long long rss_anon;
+  unsigned long long rss_file;
+  unsigned long long rss_shmem;
+  unsigned long long vm_swap;
+  unsigned long long threads;
+  unsigned long long voluntary_context_switches;
+  unsigned long long involuntary_context_switches;
+
+  // From stat.
+  unsigned long long minor_faults;
+  unsigned long long major_faults;
+  unsigned long long user_time_ms;
+  unsigned long long system_time_ms;
+
+  // From io, which is missing without CONFIG_TASK_IO_ACCOUNTING and may be
+  // unreadable inside a sandbox. [read_bytes] and [write_bytes] count block
+  // I/O; [read_chars] and [write_chars] every read() and write().
+  bool has_io;
+  unsigned long long read_chars;
+  unsigned long long write_chars;
+  unsigned long long read_bytes;
+  unsigned long long write_bytes;
+
+  // Proportional set size from smaps_rollup (Linux 4.14). Only read on
+  // request: the kernel walks every mapping to produce it.
+  bool has_pss;
+  unsigned long long pss;
+};
+
+// Change between two samples. Counters that went backwards report zero;
+// sizes are signed.
+struct ProcessStatsDelta {
+  double interval_ms;
+  long long rss;
+  // Only meaningful when both samples have PSS.
+  long long pss;
+  unsigned long long minor_faults;
+  unsigned long long major_faults;
+  unsigned long long voluntary_context_switches;
+  unsigned long long involuntary_context_switches;
+  unsigned long long user_time_ms;
+  unsigned long long system_time_ms;
+  // Only meaningful when both samples have I/O counters.
+  unsigned long long read_bytes;
+  unsigned long long write_bytes;
+};
+
+// Splits a /proc/<pid>/stat line into the command [name], the one-letter
+// [state] and the [count] numeric fields that follow, from ppid (field 4)
+// on. The name may contain spaces and parentheses, so fields are counted
+// from its last ')'. The few fields that can be negative, such as tpgid and
+// nice, are stored without their sign. Returns false if the line is cut
+// short.
+bool proc_stat_split(std::string_view line,
+                     std::string_view* name,
+                     char* state,
+                     unsigned long long* fields,
+                     size_t count);
+
+// Parses the single line of /proc/self/stat into the fault counters and CPU
+// times, converting clock ticks with [ticks_per_second]. Returns false if the
+// line is cut short.
+bool process_stat_parse(std::string_view line,
+                        long ticks_per_second,
+                        ProcessStats* stats);
+
+// Parses the single line of /proc/self/statm, which counts pages of
+// [page_size] bytes.
+bool process_statm_parse(std::string_view line,
+                         long page_size,
+                         ProcessStats* stats);
+
+// Applies one /proc/self/status line to [stats]. Returns false for lines that
+// carry no field ProcessStats tracks.
+bool process_status_parse_line(std::string_view line, ProcessStats* stats);
+
+// Applies one /proc/self/io line to [stats]. Returns false for lines that
+// carry no field ProcessStats tracks.
+bool process_io_parse_line(std::string_view line, ProcessStats* stats);
+
+// Applies one /proc/self/smaps_rollup line to [stats]. Returns false for any
+// line but "Pss:".
+bool process_smaps_rollup_parse_line(std::string_view line,
+                                     ProcessStats* stats);
+
+// Keeps the /proc/self files open so each sample is a few pread() passes from
+// offset 0 and no open() or close(). The descriptors are only read with
+// pread(), so one reader can be sampled from several threads.
+struct ProcessStatsReader {
+  int stat_fd;
+  int statm_fd;
+  int status_fd;
+  int io_fd;
+  int smaps_rollup_fd;
+  long ticks_per_second;
+  long page_size;
+};
+
+// Opens the files under [proc_dir], normally "/proc/self". Any descriptor may
+// end up as -1 if its file is missing or unreadable.
+void process_stats_reader_open(ProcessStatsReader* reader,
+                               const char* proc_dir);
+
+void process_stats_reader_close(ProcessStatsReader* reader);
+
+// Takes one sample into [stats], reading smaps_rollup too when [pss] is set.
+// Returns false if stat or status could not be read.
+bool process_stats_reader_read(const ProcessStatsReader* reader,
+                               bool pss,
+                               ProcessStats* stats);
+
+// Computes the change from [before] to [after].
+ProcessStatsDelta process_stats_between(const ProcessStats& before,
+                                        const ProcessStats& after);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_PROCESS_STATS_H_
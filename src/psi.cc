@@ -0,0 +1,113 @@
+#include "psi.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "proc_parser.h"
+
+// Parses the number after "[key]=" in [text], e.g. "avg10=1.23".
+static bool psi_parse_field(std::string_view text,
+                            std::string_view key,
+                            std::string_view* value) {
+  size_t pos = 0;
+  while ((pos = text.find(key, pos)) != std::string_view::npos) {
+    size_t end = pos + key.size();
+    bool at_word_start = pos == 0 || text[pos - 1] == ' ';
+    if (at_word_start && end < text.size() && text[end] == '=') {
+      std::string_view rest = text.substr(end + 1);
+      *value = rest.substr(0, rest.find(' '));
+      return true;
+    }
+    pos = end;
+  }
+  return false;
+}
+
+static double psi_parse_percent(std::string_view value) {
+  // Values look like "12.34"; copy to a terminated buffer for strtod().
+  char buffer[32];
+  size_t length = value.size() < sizeof(buffer) - 1 ? value.size()
+                                                    : sizeof(buffer) - 1;
+  memcpy(buffer, value.data(), length);
+  buffer[length] = '\0';
+  return strtod(buffer, nullptr);
+}
+
+bool psi_parse_line(std::string_view text, PsiLine* line, bool* is_full) {
+  if (text.substr(0, 5) == "some ") {
+    *is_full = false;
+  } else if (text.substr(0, 5) == "full ") {
+    *is_full = true;
+  } else {
+    return false;
+  }
+
+  std::string_view avg10, avg60, avg300, total;
+  if (!psi_parse_field(text, "avg10", &avg10) ||
+      !psi_parse_field(text, "avg60", &avg60) ||
+      !psi_parse_field(text, "avg300", &avg300) ||
+      !psi_parse_field(text, "total", &total)) {
+    return false;
+  }
+  line->avg10 = psi_parse_percent(avg10);
+  line->avg60 = psi_parse_percent(avg60);
+  line->avg300 = psi_parse_percent(avg300);
+  line->total_us = 0;
+  proc_next_u64(&total, &line->total_us);
+  return true;
+}
+
+bool psi_read_fd(int fd, PsiStats* stats) {
+  *stats = {};
+  bool has_some = false;
+
+  ProcLineReader reader;
+  proc_line_reader_attach(&reader, fd);
+  std::string_view text;
+  PsiLine line;
+  bool is_full = false;
+  while (proc_line_reader_next(&reader, &text)) {
+    if (!psi_parse_line(text, &line, &is_full)) continue;
+    if (is_full) {
+      stats->full = line;
+      stats->has_full = true;
+    } else {
+      stats->some = line;
+      has_some = true;
+    }
+  }
+  return has_some;
+}
+
+bool psi_read_path(const char* path, PsiStats* stats) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  bool ok = psi_read_fd(fd, stats);
+  close(fd);
+  return ok;
+}
+
+int psi_open_trigger(const char* path,
+                     const char* type,
+                     unsigned int stall_us,
+                     unsigned int window_us) {
+  int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) return -1;
+
+  char trigger[64];
+  int length =
+      snprintf(trigger, sizeof(trigger), "%s %u %u", type, stall_us, window_us);
+  // The kernel expects the terminating NUL to be written as well.
+  if (write(fd, trigger, length + 1) < 0) {
+    int saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+    return -1;
+  }
+  return fd;
+}
@@ -0,0 +1,45 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_PSI_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_PSI_H_
+
+#include <string_view>
+
+// One line of a /proc/pressure file: the share of wall time, in percent, in
+// which tasks stalled on the resource, averaged over 10, 60 and 300 seconds,
+// and the total stall time in microseconds.
+struct PsiLine {
+  double avg10;
+  double avg60;
+  double avg300;
+  unsigned long long total_us;
+};
+
+// A whole /proc/pressure file. [has_full] is false for files without a
+// "full" line, such as /proc/pressure/cpu on kernels before 5.13.
+struct PsiStats {
+  PsiLine some;
+  PsiLine full;
+  bool has_full;
+};
+
+// Parses a "some ..." or "full ..." line into [line]. Returns false for
+// anything else; [is_full] tells which kind was parsed.
+bool psi_parse_line(std::string_view text, PsiLine* line, bool* is_full);
+
+// Reads the pressure file open at [fd] from offset 0. Works for trigger
+// descriptors too. Returns false if no "some" line could be read.
+bool psi_read_fd(int fd, PsiStats* stats);
+
+// Like psi_read_fd() but opens and closes [path].
+bool psi_read_path(const char* path, PsiStats* stats);
+
+// Registers a PSI trigger on the pressure file at [path]: notify when tasks
+// stall for [stall_us] within any [window_us] window. [type] is "some" or
+// "full". Returns a descriptor that becomes readable with POLLPRI when the
+// trigger fires, or -1 with errno set if the kernel lacks PSI or refuses the
+// trigger (before Linux 6.5 only privileged processes may create them).
+int psi_open_trigger(const char* path,
+                     const char* type,
+                     unsigned int stall_us,
+                     unsigned int window_us);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_PSI_H_
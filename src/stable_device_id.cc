@@ -0,0 +1,168 @@
+#include "stable_device_id.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/file.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <mutex>
+#include <utility>
+
+// Longest ID we accept from disk. Generated IDs are 36-character UUIDs.
+static const size_t kMaxStableDeviceIdLength = 128;
+
+// Reads the ID stored in [file_path]. Returns an empty string if the file is
+// missing, empty or unreadable.
+static std::string read_stable_device_id(const std::string& file_path) {
+  int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return std::string();
+
+  char buffer[kMaxStableDeviceIdLength];
+  size_t length = 0;
+  while (length < sizeof(buffer)) {
+    ssize_t n = read(fd, buffer + length, sizeof(buffer) - length);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    length += static_cast<size_t>(n);
+  }
+  close(fd);
+
+  // Only the first line is the ID; older versions wrote it without a newline.
+  size_t end = 0;
+  while (end < length && buffer[end] != '\n' && buffer[end] != '\r') end++;
+  return std::string(buffer, end);
+}
+
+static bool write_all(int fd, const char* data, size_t length) {
+  while (length > 0) {
+    ssize_t n = write(fd, data, length);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    length -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Atomically replaces [file_path] with [id]. The data and the directory
+// entry are both flushed before returning.
+static bool write_stable_device_id(const std::string& dir_path,
+                                   const std::string& file_path,
+                                   const std::string& id) {
+  std::string tmp_path = file_path + ".tmp." + std::to_string(getpid());
+
+  int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) return false;
+  bool ok = write_all(fd, id.data(), id.size()) && fsync(fd) == 0;
+  ok = close(fd) == 0 && ok;
+  if (!ok || rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+
+  int dir_fd = open(dir_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    close(dir_fd);
+  }
+  return true;
+}
+
+// Creates [path] and any missing parent directories with [mode].
+static void make_directories(const std::string& path, mode_t mode) {
+  for (size_t slash = path.find('/', 1); slash != std::string::npos;
+       slash = path.find('/', slash + 1)) {
+    mkdir(path.substr(0, slash).c_str(), mode);
+  }
+  mkdir(path.c_str(), mode);
+}
+
+// Returns a random (version 4) UUID, or an empty string if the kernel has no
+// randomness to give.
+static std::string random_uuid() {
+  unsigned char bytes[16];
+  size_t length = 0;
+  while (length < sizeof(bytes)) {
+    ssize_t n = getrandom(bytes + length, sizeof(bytes) - length, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return std::string();
+    length += static_cast<size_t>(n);
+  }
+  bytes[6] = (bytes[6] & 0x0F) | 0x40;
+  bytes[8] = (bytes[8] & 0x3F) | 0x80;
+
+  char uuid[37];
+  snprintf(uuid, sizeof(uuid),
+           "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-"
+           "%02x%02x%02x%02x%02x%02x",
+           bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5],
+           bytes[6], bytes[7], bytes[8], bytes[9], bytes[10], bytes[11],
+           bytes[12], bytes[13], bytes[14], bytes[15]);
+  return uuid;
+}
+
+// Returns $XDG_CONFIG_HOME, falling back to ~/.config as the XDG base
+// directory specification says.
+static std::string user_config_dir() {
+  const char* config_home = getenv("XDG_CONFIG_HOME");
+  if (config_home != nullptr && config_home[0] == '/') return config_home;
+  const char* home = getenv("HOME");
+  if (home != nullptr && home[0] != '\0') return std::string(home) + "/.config";
+  return ".";
+}
+
+std::string stable_device_id_load_or_create(const std::string& dir_path) {
+  std::string file_path = dir_path + "/stable_device_id";
+
+  // Fast path: the ID already exists and no lock is needed to read it,
+  // because it is only ever replaced by an atomic rename.
+  std::string existing = read_stable_device_id(file_path);
+  if (!existing.empty()) return existing;
+
+  make_directories(dir_path, 0700);
+
+  std::string lock_path = dir_path + "/stable_device_id.lock";
+  int lock_fd = open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (lock_fd >= 0) {
+    while (flock(lock_fd, LOCK_EX) != 0 && errno == EINTR) {
+    }
+  }
+
+  // Another process may have created the ID while we waited for the lock.
+  std::string id = read_stable_device_id(file_path);
+  if (id.empty()) {
+    std::string new_id = random_uuid();
+
+    // An ID that could not be persisted is still returned, matching the
+    // previous behaviour.
+    if (!new_id.empty()) {
+      write_stable_device_id(dir_path, file_path, new_id);
+    }
+    id = new_id;
+  }
+
+  if (lock_fd >= 0) {
+    flock(lock_fd, LOCK_UN);
+    close(lock_fd);
+  }
+  return id;
+}
+
+std::string stable_device_id_get() {
+  static std::mutex mutex;
+  static std::string* memoized = nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (memoized == nullptr) {
+    std::string dir_path = user_config_dir() + "/platform_version";
+    std::string id = stable_device_id_load_or_create(dir_path);
+    if (!id.empty()) {
+      memoized = new std::string(std::move(id));
+    }
+  }
+  return memoized != nullptr ? *memoized : std::string();
+}
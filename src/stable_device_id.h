@@ -0,0 +1,20 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_STABLE_DEVICE_ID_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_STABLE_DEVICE_ID_H_
+
+#include <string>
+
+// Returns the stable device ID stored under
+// $XDG_CONFIG_HOME/platform_version, creating it on first use. The value is
+// memoized for the lifetime of the process, so only the first call touches
+// the file system. Returns an empty string if no ID could be read or created.
+std::string stable_device_id_get();
+
+// Reads the ID from [dir_path]/stable_device_id, or creates it there.
+//
+// Creation is serialized across processes with an flock() on
+// [dir_path]/stable_device_id.lock, and the file is written to a temporary
+// name, fsync()ed and renamed into place, so concurrent launches agree on one
+// ID and a crash never leaves a truncated file behind. Not memoized.
+std::string stable_device_id_load_or_create(const std::string& dir_path);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_STABLE_DEVICE_ID_H_
@@ -0,0 +1,72 @@
+#include "string_util.h"
+
+std::string_view string_trim(std::string_view value) {
+  size_t begin = 0;
+  size_t end = value.size();
+  while (begin < end && (value[begin] == ' ' || value[begin] == '\t')) begin++;
+  while (end > begin && (value[end - 1] == ' ' || value[end - 1] == '\t')) end--;
+  return value.substr(begin, end - begin);
+}
+
+size_t utf8_truncated_length(std::string_view value, size_t max_length) {
+  if (value.size() <= max_length) return value.size();
+  size_t length = max_length;
+  // Back up over continuation bytes to the start of the cut sequence.
+  while (length > 0 &&
+         (static_cast<unsigned char>(value[length]) & 0xC0) == 0x80) {
+    length--;
+  }
+  return length;
+}
+
+// Appends [code_point] to [out] as UTF-8.
+static void append_utf8(std::string* out, char32_t code_point) {
+  if (code_point < 0x80) {
+    out->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+std::string utf16_to_utf8(std::u16string_view value) {
+  std::string out;
+  out.reserve(value.size());
+  for (size_t i = 0; i < value.size(); i++) {
+    char32_t unit = value[i];
+    if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < value.size() &&
+        value[i + 1] >= 0xDC00 && value[i + 1] <= 0xDFFF) {
+      char32_t low = value[++i];
+      append_utf8(&out, 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00));
+    } else if (unit >= 0xD800 && unit <= 0xDFFF) {
+      append_utf8(&out, 0xFFFD);
+    } else {
+      append_utf8(&out, unit);
+    }
+  }
+  return out;
+}
+
+void json_write_string(FILE* file, const char* value) {
+  fputc('"', file);
+  for (const char* c = value; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      fputc('\\', file);
+      fputc(*c, file);
+    } else if (static_cast<unsigned char>(*c) < 0x20) {
+      fprintf(file, "\\u%04x", static_cast<unsigned>(*c));
+    } else {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
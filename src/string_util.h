@@ -0,0 +1,24 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_STRING_UTIL_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_STRING_UTIL_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <string>
+#include <string_view>
+
+// Removes leading and trailing spaces and tabs.
+std::string_view string_trim(std::string_view value);
+
+// Returns the length of the longest prefix of [value] that is at most
+// [max_length] bytes and does not end inside a UTF-8 sequence.
+size_t utf8_truncated_length(std::string_view value, size_t max_length);
+
+// Converts UTF-16, as in Windows wide strings, to UTF-8. Unpaired surrogates
+// become U+FFFD.
+std::string utf16_to_utf8(std::u16string_view value);
+
+// Writes [value] to [file] as a quoted JSON string.
+void json_write_string(FILE* file, const char* value);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_STRING_UTIL_H_
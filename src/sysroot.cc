@@ -0,0 +1,25 @@
+#include "sysroot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+
+SysrootPath sysroot_path(const char* sysroot, const char* path) {
+  SysrootPath resolved;
+  snprintf(resolved.path, sizeof(resolved.path), "%s%s",
+           sysroot != nullptr ? sysroot : "", path);
+  return resolved;
+}
+
+const char* sysroot_from_environment() {
+  // Leaked on purpose: probes on other threads may hold the pointer until
+  // exit.
+  static const std::string* sysroot = [] {
+    const char* value = getenv(PLATFORM_VERSION_SYSROOT_ENV);
+    std::string* root = new std::string(value != nullptr ? value : "");
+    while (!root->empty() && root->back() == '/') root->pop_back();
+    return root;
+  }();
+  return sysroot->c_str();
+}
@@ -0,0 +1,29 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_SYSROOT_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_SYSROOT_H_
+
+#include <stddef.h>
+
+// Names a directory to read /proc, /sys and /etc from instead of the live
+// system, such as one of the recorded hosts under src/test/fixtures/sysroot.
+// Probes that use syscalls (uname(), sysinfo(), sysconf() and
+// sched_getaffinity()) still describe the live system.
+#define PLATFORM_VERSION_SYSROOT_ENV "PLATFORM_VERSION_SYSROOT"
+
+// Longest path sysroot_path() builds, including the terminator.
+constexpr size_t kSysrootPathMax = 4096;
+
+// An absolute path resolved against a sysroot, built without allocating.
+struct SysrootPath {
+  char path[kSysrootPathMax];
+};
+
+// Returns [path], which must be absolute, under [sysroot]. A null or empty
+// [sysroot] is the live system and leaves [path] unchanged. Paths longer
+// than kSysrootPathMax are truncated.
+SysrootPath sysroot_path(const char* sysroot, const char* path);
+
+// Returns the directory named by PLATFORM_VERSION_SYSROOT, without trailing
+// slashes, or "" for the live system. Read once per process.
+const char* sysroot_from_environment();
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_SYSROOT_H_
@@ -0,0 +1,1043 @@
+// Tests of the Linux probes in platform_version_core. They read fixtures
+// written to /tmp, or the host's own /proc and sysfs where the exact values
+// cannot matter.
+
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "cgroup.h"
+#include "cpu_affinity.h"
+#include "cpu_features.h"
+#include "cpu_topology.h"
+#include "cpu_usage.h"
+#include "device_info.h"
+#include "latency_histogram.h"
+#include "meminfo.h"
+#include "metrics_sampler.h"
+#include "proc_parser.h"
+#include "process_stats.h"
+#include "psi.h"
+#include "stable_device_id.h"
+#include "sysroot.h"
+#include "thread_stats.h"
+#include "trace_recorder.h"
+
+// Counts heap allocations made by the code under test, so the parsers can be
+// checked for allocations per call. Every allocation in the process goes
+// through these, operator new included.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void __libc_free(void* p);
+}
+
+static std::atomic<size_t> allocation_count{0};
+
+extern "C" void* malloc(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(p, size);
+}
+
+extern "C" void free(void* p) { __libc_free(p); }
+
+namespace platform_version {
+namespace test {
+
+// Writes [contents] to a new temporary file and returns its path.
+static std::string write_fixture(const std::string& contents) {
+  char path[] = "/tmp/platform_version_fixture_XXXXXX";
+  int fd = mkstemp(path);
+  EXPECT_GE(fd, 0);
+  EXPECT_EQ(write(fd, contents.data(), contents.size()),
+            static_cast<ssize_t>(contents.size()));
+  close(fd);
+  return path;
+}
+
+TEST(StableDeviceId, IsCreatedOnceAndPersisted) {
+  char dir_template[] = "/tmp/platform_version_test_XXXXXX";
+  ASSERT_NE(mkdtemp(dir_template), nullptr);
+  std::string dir_path = std::string(dir_template) + "/platform_version";
+
+  std::string first = stable_device_id_load_or_create(dir_path);
+  std::string second = stable_device_id_load_or_create(dir_path);
+  ASSERT_FALSE(first.empty());
+  EXPECT_EQ(first, second);
+
+  std::ifstream in(dir_path + "/stable_device_id");
+  std::string stored;
+  std::getline(in, stored);
+  EXPECT_EQ(stored, first);
+
+  std::filesystem::remove_all(dir_template);
+}
+
+TEST(DeviceInfo, RunsDependenciesOnceAndCachesStaticProbes) {
+  DeviceSnapshot snapshot;
+  LatencyHistogram histograms[kProbeCount] = {};
+  MemInfoReader meminfo_reader;
+  meminfo_reader_open(&meminfo_reader, "/proc/meminfo", "/proc/vmstat");
+  DeviceInfoProbeContext context = {&snapshot, histograms, &meminfo_reader,
+                                    nullptr};
+  auto runs = [&histograms](unsigned probe) {
+    LatencyStats stats;
+    latency_histogram_stats(&histograms[__builtin_ctz(probe)], &stats);
+    return stats.count;
+  };
+
+  // kProbeCgroup pulls in the cgroup paths, processor count and affinity.
+  DeviceInfoProbeResults results = {};
+  device_info_run_probes(context, kProbeCgroup, &results);
+  EXPECT_EQ(snapshot.probed, unsigned{kProbeCgroupPaths | kProbeProcessors});
+  EXPECT_EQ(results.probed, unsigned{kProbeCgroup | kProbeAffinity});
+  EXPECT_GT(results.effective_processors, 0);
+
+  // Dynamic probes run once per results, static ones once per snapshot.
+  device_info_run_probes(context, kProbeCgroup, &results);
+  EXPECT_EQ(runs(kProbeCgroup), 1u);
+  DeviceInfoProbeResults next = {};
+  device_info_run_probes(context, kProbeCgroup | kProbeMeminfo, &next);
+  EXPECT_EQ(runs(kProbeCgroup), 2u);
+  EXPECT_EQ(runs(kProbeMeminfo), 1u);
+  EXPECT_EQ(runs(kProbeCgroupPaths), 1u);
+  EXPECT_EQ(runs(kProbeKernel), 0u);
+
+  const DeviceInfoKey* key = device_info_find_key("effectiveProcessors");
+  ASSERT_NE(key, nullptr);
+  DeviceInfo info;
+  key->set(next, &info);
+  EXPECT_EQ(info.effective_processors, next.effective_processors);
+  EXPECT_FALSE(info.available_ram.has_value());
+  device_info_find_key("availableRam")->set(next, &info);
+  EXPECT_GT(info.available_ram.value_or(0), 0);
+  EXPECT_EQ(device_info_find_key("unknownKey"), nullptr);
+  meminfo_reader_close(&meminfo_reader);
+}
+
+TEST(ProcParser, ReadsLinesAcrossBufferRefills) {
+  std::string long_line(kProcLineReaderBufferSize + 100, 'x');
+  std::string path = write_fixture("first\n" + long_line + "\nlast");
+
+  ProcLineReader reader;
+  ASSERT_TRUE(proc_line_reader_open(&reader, path.c_str()));
+  std::string_view line;
+  ASSERT_TRUE(proc_line_reader_next(&reader, &line));
+  EXPECT_EQ(line, "first");
+  // Over-long lines are truncated to the buffer size.
+  ASSERT_TRUE(proc_line_reader_next(&reader, &line));
+  EXPECT_EQ(line.size(), kProcLineReaderBufferSize);
+  ASSERT_TRUE(proc_line_reader_next(&reader, &line));
+  EXPECT_EQ(line, "last");
+  EXPECT_FALSE(proc_line_reader_next(&reader, &line));
+  proc_line_reader_close(&reader);
+  unlink(path.c_str());
+}
+
+TEST(ProcParser, ReadsCpuModelName) {
+  std::string path = write_fixture(
+      "processor\t: 0\n"
+      "vendor_id\t: GenuineIntel\n"
+      "model name\t: Intel(R) Core(TM) i7-8650U CPU @ 1.90GHz\n"
+      "processor\t: 1\n"
+      "model name\t: ignored\n");
+
+  std::string model = "Unknown";
+  EXPECT_TRUE(cpuinfo_read_model_name(path.c_str(), &model));
+  EXPECT_EQ(model, "Intel(R) Core(TM) i7-8650U CPU @ 1.90GHz");
+  unlink(path.c_str());
+}
+
+TEST(ProcParser, ReadsOsReleaseNameAndVersion) {
+  std::string path = write_fixture(
+      "PRETTY_NAME=\"Debian GNU/Linux 12 (bookworm)\"\n"
+      "# comment\n"
+      "NAME='Debian GNU/Linux'\n"
+      "VERSION_ID=\"12\"\n"
+      "VERSION=\"12 (bookworm)\"\n"
+      "ID=debian\n");
+
+  std::string name = "Unknown";
+  std::string version = "Unknown";
+  EXPECT_TRUE(os_release_read(path.c_str(), &name, &version));
+  EXPECT_EQ(name, "Debian GNU/Linux");
+  EXPECT_EQ(version, "12 (bookworm)");
+  unlink(path.c_str());
+}
+
+TEST(ProcParser, ParsersDoNotAllocatePerCall) {
+  std::string model;
+  std::string name;
+  std::string version;
+  model.reserve(256);
+  name.reserve(256);
+  version.reserve(256);
+
+  const int kIterations = 100;
+  size_t before = allocation_count.load();
+  for (int i = 0; i < kIterations; i++) {
+    cpuinfo_read_model_name("/proc/cpuinfo", &model);
+    os_release_read("/etc/os-release", &name, &version);
+  }
+  size_t allocations = allocation_count.load() - before;
+  RecordProperty("AllocationsPerCall",
+                 static_cast<int>(allocations / kIterations));
+  EXPECT_EQ(allocations, 0u);
+}
+
+TEST(CpuUsage, ComputesUsageBetweenProcStatSamples) {
+  std::string first = write_fixture(
+      "cpu  100 0 50 800 50 0 0 0 0 0\n"
+      "cpu0 50 0 25 400 25 0 0 0 0 0\n"
+      "cpu1 50 0 25 400 25 0 0 0 0 0\n"
+      "intr 12345 0 0\n");
+  std::string second = write_fixture(
+      "cpu  200 0 100 1000 50 0 0 50 0 0\n"
+      "cpu0 150 0 50 400 25 0 0 0 0 0\n"
+      "cpu1 50 0 50 600 25 0 0 0 0 0\n"
+      "intr 12345 0 0\n");
+
+  CpuUsageSampler sampler;
+  std::vector<CpuUsage> usage;
+  ASSERT_TRUE(cpu_usage_sampler_sample(&sampler, first.c_str(), &usage));
+  ASSERT_TRUE(cpu_usage_sampler_sample(&sampler, second.c_str(), &usage));
+  ASSERT_EQ(usage.size(), 3u);
+
+  EXPECT_EQ(usage[0].cpu, -1);
+  EXPECT_DOUBLE_EQ(usage[0].user, 25.0);
+  EXPECT_DOUBLE_EQ(usage[0].system, 12.5);
+  EXPECT_DOUBLE_EQ(usage[0].steal, 12.5);
+  EXPECT_DOUBLE_EQ(usage[0].idle, 50.0);
+
+  EXPECT_EQ(usage[1].cpu, 0);
+  EXPECT_DOUBLE_EQ(usage[1].user, 80.0);
+  EXPECT_EQ(usage[2].cpu, 1);
+  EXPECT_DOUBLE_EQ(usage[2].idle, 800.0 / 9.0);
+
+  unlink(first.c_str());
+  unlink(second.c_str());
+}
+
+TEST(MemInfo, ReadsMeminfoAndVmstatThroughPersistentDescriptors) {
+  std::string meminfo = write_fixture(
+      "MemTotal:       16303428 kB\n"
+      "MemFree:          734540 kB\n"
+      "MemAvailable:    9822316 kB\n"
+      "Buffers:          512000 kB\n"
+      "Cached:          8001234 kB\n"
+      "SwapCached:         1024 kB\n"
+      "SwapTotal:       2097148 kB\n"
+      "SwapFree:        2000000 kB\n"
+      "Dirty:               348 kB\n"
+      "Writeback:             0 kB\n"
+      "SReclaimable:     600000 kB\n");
+  std::string vmstat = write_fixture(
+      "nr_free_pages 183635\n"
+      "pswpin 42\n"
+      "pswpout 77\n"
+      "pgfault 123456\n");
+
+  MemInfoReader reader;
+  meminfo_reader_open(&reader, meminfo.c_str(), vmstat.c_str());
+  MemInfo info;
+  // Sampling twice exercises the pread() from offset 0 on the same fds.
+  ASSERT_TRUE(meminfo_reader_read(&reader, &info));
+  ASSERT_TRUE(meminfo_reader_read(&reader, &info));
+  meminfo_reader_close(&reader);
+
+  EXPECT_EQ(info.mem_available, 9822316ull * 1024);
+  EXPECT_EQ(info.cached, 8001234ull * 1024);
+  EXPECT_EQ(info.dirty, 348ull * 1024);
+  EXPECT_EQ(info.slab_reclaimable, 600000ull * 1024);
+  EXPECT_EQ(info.swap_in_pages, 42u);
+  EXPECT_EQ(info.swap_out_pages, 77u);
+
+  unlink(meminfo.c_str());
+  unlink(vmstat.c_str());
+}
+
+TEST(MemInfo, FallsBackToMemFreeWithoutMemAvailable) {
+  std::string meminfo = write_fixture(
+      "MemTotal:       16303428 kB\n"
+      "MemFree:          734540 kB\n");
+
+  MemInfoReader reader;
+  meminfo_reader_open(&reader, meminfo.c_str(), "/nonexistent");
+  MemInfo info;
+  ASSERT_TRUE(meminfo_reader_read(&reader, &info));
+  meminfo_reader_close(&reader);
+
+  EXPECT_EQ(info.mem_available, 734540ull * 1024);
+  unlink(meminfo.c_str());
+}
+
+TEST(ProcessStats, ParsesStatWithSpacesAndParenthesesInTheName) {
+  ProcessStats stats = {};
+  ASSERT_TRUE(process_stat_parse(
+      "4242 (my (app) 2) S 1 4242 4242 34816 -1 4194304 1500 20 7 3 250 "
+      "125 0 0 20 0 12 0 100 1000000 500",
+      100, &stats));
+  EXPECT_EQ(stats.minor_faults, 1500u);
+  EXPECT_EQ(stats.major_faults, 7u);
+  EXPECT_EQ(stats.user_time_ms, 2500u);
+  EXPECT_EQ(stats.system_time_ms, 1250u);
+  EXPECT_FALSE(process_stat_parse("4242 (app) S 1 4242", 100, &stats));
+}
+
+TEST(ProcessStats, ReadsProcSelfFilesThroughPersistentDescriptors) {
+  char dir[] = "/tmp/platform_version_self_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  std::filesystem::path root(dir);
+  std::ofstream(root / "stat")
+      << "7 (app) R 1 7 7 0 -1 0 900 0 4 0 10 5 0 0 20 0 3 0 1 2 3\n";
+  std::ofstream(root / "statm") << "1000 250 100 10 0 300 0\n";
+  std::ofstream(root / "status") << "Name:\tapp\n"
+                                    "VmHWM:\t    2048 kB\n"
+                                    "VmRSS:\t    1000 kB\n"
+                                    "RssAnon:\t     600 kB\n"
+                                    "RssFile:\t     400 kB\n"
+                                    "RssShmem:\t       0 kB\n"
+                                    "VmSwap:\t      16 kB\n"
+                                    "Threads:\t3\n"
+                                    "voluntary_ctxt_switches:\t120\n"
+                                    "nonvoluntary_ctxt_switches:\t8\n";
+  std::ofstream(root / "smaps_rollup")
+      << "00400000-7fff00000000 ---p 00000000 00:00 0 [rollup]\n"
+         "Rss:                1000 kB\n"
+         "Pss:                 800 kB\n";
+
+  ProcessStatsReader reader;
+  process_stats_reader_open(&reader, dir);
+  // No io file, as under a sandbox that hides it.
+  EXPECT_EQ(reader.io_fd, -1);
+  reader.ticks_per_second = 100;
+  reader.page_size = 4096;
+  ProcessStats before;
+  ProcessStats after;
+  ASSERT_TRUE(process_stats_reader_read(&reader, false, &before));
+  EXPECT_FALSE(before.has_pss);
+  EXPECT_FALSE(before.has_io);
+
+  std::ofstream(root / "stat")
+      << "7 (app) R 1 7 7 0 -1 0 950 0 6 0 20 5 0 0 20 0 3 0 1 2 3\n";
+  std::ofstream(root / "statm") << "1000 200 100 10 0 300 0\n";
+  ASSERT_TRUE(process_stats_reader_read(&reader, true, &after));
+  process_stats_reader_close(&reader);
+
+  EXPECT_EQ(after.vm_size, 1000u * 4096);
+  EXPECT_EQ(after.rss, 200u * 4096);
+  EXPECT_EQ(after.vm_hwm, 2048u * 1024);
+  EXPECT_EQ(after.rss_anon, 600u * 1024);
+  EXPECT_EQ(after.vm_swap, 16u * 1024);
+  EXPECT_EQ(after.threads, 3u);
+  EXPECT_EQ(after.voluntary_context_switches, 120u);
+  EXPECT_EQ(after.involuntary_context_switches, 8u);
+  EXPECT_TRUE(after.has_pss);
+  EXPECT_EQ(after.pss, 800u * 1024);
+
+  ProcessStatsDelta delta = process_stats_between(before, after);
+  EXPECT_EQ(delta.rss, -50ll * 4096);
+  EXPECT_EQ(delta.minor_faults, 50u);
+  EXPECT_EQ(delta.major_faults, 2u);
+  EXPECT_EQ(delta.user_time_ms, 100u);
+  EXPECT_EQ(delta.system_time_ms, 0u);
+  EXPECT_GE(delta.interval_ms, 0.0);
+  // Counters that go backwards report zero rather than wrapping.
+  EXPECT_EQ(process_stats_between(after, before).minor_faults, 0u);
+
+  std::filesystem::remove_all(root);
+}
+
+TEST(ProcessStats, SeesFaultsOfTheCallingProcess) {
+  ProcessStatsReader reader;
+  process_stats_reader_open(&reader, "/proc/self");
+  ProcessStats before;
+  ASSERT_TRUE(process_stats_reader_read(&reader, false, &before));
+  EXPECT_GT(before.rss, 0u);
+  EXPECT_GE(before.vm_hwm, before.rss_anon);
+  EXPECT_GE(before.threads, 1u);
+
+  // Touching fresh pages faults them in.
+  const size_t size = 64 << 20;
+  char* block = static_cast<char*>(malloc(size));
+  ASSERT_NE(block, nullptr);
+  for (size_t i = 0; i < size; i += 4096) block[i] = 1;
+  ProcessStats after;
+  ASSERT_TRUE(process_stats_reader_read(&reader, true, &after));
+  free(block);
+  process_stats_reader_close(&reader);
+
+  ProcessStatsDelta delta = process_stats_between(before, after);
+  EXPECT_GE(delta.minor_faults, 1000u);
+  EXPECT_GT(delta.rss, 0);
+  EXPECT_GT(delta.interval_ms, 0.0);
+}
+
+TEST(ThreadStats, ParsesNameStateTimesAndLastCpu) {
+  ThreadStats stats;
+  ASSERT_TRUE(thread_stat_parse(
+      "4250 (1.raster) R 1 4242 4242 0 -1 4194368 300 0 0 0 420 80 0 0 -2 0 "
+      "25 0 1234 900000 2000 18446744073709551615 1 1 0 0 0 0 0 4096 1260 "
+      "0 0 0 -1 5 0 0 0 0 0",
+      4250, 100, &stats));
+  EXPECT_EQ(stats.tid, 4250);
+  EXPECT_STREQ(stats.name, "1.raster");
+  EXPECT_EQ(stats.state, 'R');
+  EXPECT_EQ(stats.user_time_ms, 4200u);
+  EXPECT_EQ(stats.system_time_ms, 800u);
+  EXPECT_EQ(stats.last_cpu, 5);
+  EXPECT_FALSE(thread_stat_parse("4250 (1.raster) R 1 4242", 4250, 100,
+                                 &stats));
+}
+
+TEST(ThreadStats, FollowsThreadsComingAndGoingBetweenSamples) {
+  char dir[] = "/tmp/platform_version_task_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  std::filesystem::path root(dir);
+  auto put_thread = [&](int tid, const char* name, int utime, int cpu) {
+    std::filesystem::create_directories(root / std::to_string(tid));
+    std::ofstream(root / std::to_string(tid) / "stat")
+        << tid << " (" << name << ") S 1 100 100 0 -1 0 0 0 0 0 " << utime
+        << " 10 0 0 20 0 3 0 1 2 3 4 5 6 0 0 0 0 0 0 0 0 0 0 17 " << cpu
+        << " 0 0 0 0 0\n";
+  };
+  put_thread(100, "app", 50, 0);
+  put_thread(101, "1.ui", 20, 1);
+  put_thread(102, "1.raster", 30, 2);
+
+  ThreadStatsSampler sampler;
+  ASSERT_TRUE(thread_stats_sampler_open(&sampler, dir));
+  sampler.ticks_per_second = 100;
+  std::vector<ThreadCpuUsage> usage;
+  double interval_ms = -1;
+  ASSERT_TRUE(thread_stats_sampler_sample(&sampler, &usage, &interval_ms));
+  EXPECT_EQ(interval_ms, 0.0);
+  ASSERT_EQ(usage.size(), 3u);
+  EXPECT_STREQ(usage[1].stats.name, "1.ui");
+  // The first sample reports the time since each thread started.
+  EXPECT_EQ(usage[2].user_time_ms, 300u);
+  EXPECT_EQ(usage[2].cpu_percent, 0.0);
+
+  // 101 exits, 102 keeps running and 103 starts.
+  std::filesystem::remove_all(root / "101");
+  put_thread(102, "1.raster", 90, 3);
+  put_thread(103, "1.io", 5, 0);
+  ASSERT_TRUE(thread_stats_sampler_sample(&sampler, &usage, &interval_ms));
+  EXPECT_GT(interval_ms, 0.0);
+  ASSERT_EQ(usage.size(), 3u);
+  EXPECT_EQ(usage[0].stats.tid, 100);
+  EXPECT_EQ(usage[0].user_time_ms, 0u);
+  EXPECT_EQ(usage[1].stats.tid, 102);
+  EXPECT_EQ(usage[1].stats.last_cpu, 3);
+  EXPECT_EQ(usage[1].user_time_ms, 600u);
+  EXPECT_GT(usage[1].cpu_percent, 0.0);
+  EXPECT_EQ(usage[2].stats.tid, 103);
+  EXPECT_EQ(usage[2].user_time_ms, 50u);
+  ASSERT_EQ(sampler.threads.size(), 3u);
+
+  thread_stats_sampler_close(&sampler);
+  std::filesystem::remove_all(root);
+}
+
+TEST(ThreadStats, FindsTheCallingThreadByName) {
+  ThreadStatsSampler sampler;
+  ASSERT_TRUE(thread_stats_sampler_open(&sampler, "/proc/self/task"));
+  std::atomic<bool> stop{false};
+  std::thread worker([&] {
+    pthread_setname_np(pthread_self(), "pv.busy");
+    while (!stop) {
+    }
+  });
+  std::vector<ThreadCpuUsage> usage;
+  double interval_ms = 0;
+  ASSERT_TRUE(thread_stats_sampler_sample(&sampler, &usage, &interval_ms));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_TRUE(thread_stats_sampler_sample(&sampler, &usage, &interval_ms));
+  stop = true;
+  worker.join();
+  thread_stats_sampler_close(&sampler);
+
+  bool found_main = false;
+  bool found_worker = false;
+  for (const ThreadCpuUsage& thread : usage) {
+    if (thread.stats.tid == getpid()) found_main = true;
+    if (strcmp(thread.stats.name, "pv.busy") == 0) found_worker = true;
+  }
+  EXPECT_TRUE(found_main);
+  EXPECT_TRUE(found_worker);
+}
+
+TEST(MetricsSampler, PublishesSamplesAndFollowsReconfiguration) {
+  LoadAvg loadavg;
+  EXPECT_FALSE(loadavg_parse("0.52 0.58", &loadavg));
+  EXPECT_FALSE(loadavg_parse("0.52 0.58 0.59 2", &loadavg));
+
+  char dir[] = "/tmp/platform_version_proc_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  std::filesystem::path root(dir);
+  std::ofstream(root / "meminfo") << "MemTotal: 16303428 kB\n"
+                                  << "MemAvailable: 9822316 kB\n";
+  std::ofstream(root / "vmstat") << "pswpin 42\npswpout 77\n";
+  std::ofstream(root / "loadavg") << "0.52 1.05 12.50 3/1234 5678\n";
+  std::ofstream(root / "stat") << "cpu  100 5 50 1000 20 1 2 3 0 0\n"
+                               << "cpu0 100 5 50 1000 20 1 2 3 0 0\n";
+
+  // Wait for the sampler thread rather than sleeping a fixed time.
+  auto wait_for = [](const std::function<bool()>& done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done() && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return done();
+  };
+
+  const unsigned metrics = kMetricMeminfo | kMetricLoadavg | kMetricCpuTimes;
+  MetricsSampler* sampler = metrics_sampler_start(dir, metrics, 5);
+  MetricsSample sample;
+  ASSERT_TRUE(metrics_sampler_read(sampler, &sample));
+  EXPECT_EQ(sample.metrics, metrics);
+  EXPECT_EQ(sample.meminfo.mem_available, 9822316ull * 1024);
+  EXPECT_EQ(sample.meminfo.swap_out_pages, 77u);
+  EXPECT_DOUBLE_EQ(sample.loadavg.load1, 0.52);
+  EXPECT_DOUBLE_EQ(sample.loadavg.load15, 12.5);
+  EXPECT_EQ(sample.loadavg.running, 3u);
+  EXPECT_EQ(sample.loadavg.total, 1234u);
+  EXPECT_EQ(sample.cpu_times.cpu, -1);
+  EXPECT_EQ(sample.cpu_times.idle, 1000u);
+  EXPECT_EQ(sample.cpu_times.steal, 3u);
+  EXPECT_EQ(sample.sys_info.totalram, 0u);
+
+  const uint64_t first = sample.refreshes;
+  EXPECT_TRUE(wait_for([&] {
+    metrics_sampler_read(sampler, &sample);
+    return sample.refreshes > first;
+  }));
+
+  // With nothing to sample the snapshot is empty and readers fall back.
+  metrics_sampler_configure(sampler, 0, 5);
+  EXPECT_TRUE(wait_for([&] { return !metrics_sampler_read(sampler, &sample); }));
+
+  metrics_sampler_configure(sampler, kMetricSysinfo, 60000);
+  EXPECT_TRUE(wait_for([&] {
+    return metrics_sampler_read(sampler, &sample) &&
+           sample.metrics == kMetricSysinfo;
+  }));
+  EXPECT_GT(sample.sys_info.totalram, 0u);
+  EXPECT_GT(sample.timestamp_ns, 0u);
+
+  // Stopping must not wait out the 60 second interval.
+  metrics_sampler_stop(sampler);
+  std::filesystem::remove_all(root);
+}
+
+TEST(LatencyHistogram, BucketsAndPercentilesStayWithinAQuarter) {
+  for (uint64_t ns : {0ull, 3ull, 4ull, 7ull, 8ull, 1000ull, 123456789ull}) {
+    int bucket = latency_histogram_bucket(ns);
+    EXPECT_LE(ns, latency_histogram_bucket_limit(bucket));
+    if (bucket > 0) {
+      EXPECT_GT(ns, latency_histogram_bucket_limit(bucket - 1));
+    }
+  }
+  EXPECT_EQ(latency_histogram_bucket(UINT64_MAX), kLatencyHistogramBuckets - 1);
+
+  static LatencyHistogram histogram;
+  for (uint64_t us = 1; us <= 100; us++) {
+    latency_histogram_record(&histogram, us * 1000, us % 10 == 0);
+  }
+  LatencyStats stats;
+  latency_histogram_stats(&histogram, &stats);
+  EXPECT_EQ(stats.count, 100u);
+  EXPECT_EQ(stats.errors, 10u);
+  EXPECT_EQ(stats.max_ns, 100000u);
+  EXPECT_EQ(stats.mean_ns, 50500u);
+  EXPECT_GE(stats.p50_ns, 50000u);
+  EXPECT_LE(stats.p50_ns, 50000u * 5 / 4);
+  EXPECT_GE(stats.p99_ns, 99000u);
+  EXPECT_LE(stats.p99_ns, stats.max_ns);
+
+  latency_histogram_reset(&histogram);
+  latency_histogram_stats(&histogram, &stats);
+  EXPECT_EQ(stats.count, 0u);
+  EXPECT_EQ(stats.max_ns, 0u);
+}
+
+TEST(TraceRecorder, DumpsEventsFromEveryThreadAsTraceEventJson) {
+  { TraceScope ignored("test", "beforeEnabling"); }
+
+  trace_recorder_set_enabled(true);
+  { TraceScope outer("test", "outer"); }
+  std::thread worker([] { TraceScope scope("test", "onWorker"); });
+  worker.join();
+  trace_recorder_set_enabled(false);
+  { TraceScope ignored("test", "afterDisabling"); }
+
+  std::string path = write_fixture("");
+  ASSERT_EQ(trace_recorder_dump(path.c_str(), true), 4);
+  std::ifstream in(path);
+  std::string json((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+  EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+  EXPECT_NE(json.find("\"name\":\"outer\",\"cat\":\"test\",\"ph\":\"B\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"onWorker\",\"cat\":\"test\",\"ph\":\"E\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"ph\":\"M\""), std::string::npos);
+  EXPECT_EQ(json.find("beforeEnabling"), std::string::npos);
+  EXPECT_EQ(json.find("afterDisabling"), std::string::npos);
+  EXPECT_EQ(json.substr(json.size() - 3), "]}\n");
+
+  // The first dump cleared the rings.
+  EXPECT_EQ(trace_recorder_dump(path.c_str(), true), 0);
+  EXPECT_EQ(trace_recorder_dump("/nonexistent/dir/trace.json", true), -1);
+  unlink(path.c_str());
+}
+
+TEST(TraceRecorder, ReusesTheRingsOfExitedThreads) {
+  trace_recorder_set_enabled(true);
+  std::thread first([] { TraceScope scope("test", "onFirstWorker"); });
+  first.join();
+  // Takes over the first worker's ring, dropping its undumped events.
+  std::thread second([] { TraceScope scope("test", "onSecondWorker"); });
+  second.join();
+  trace_recorder_set_enabled(false);
+
+  std::string path = write_fixture("");
+  ASSERT_EQ(trace_recorder_dump(path.c_str(), true), 2);
+  std::ifstream in(path);
+  std::string json((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+  EXPECT_EQ(json.find("onFirstWorker"), std::string::npos);
+  EXPECT_NE(json.find("onSecondWorker"), std::string::npos);
+  unlink(path.c_str());
+}
+
+TEST(Psi, ReadsSomeAndFullLines) {
+  std::string path = write_fixture(
+      "some avg10=12.50 avg60=3.05 avg300=0.71 total=98765432\n"
+      "full avg10=1.00 avg60=0.25 avg300=0.00 total=1234\n");
+
+  PsiStats stats;
+  ASSERT_TRUE(psi_read_path(path.c_str(), &stats));
+  EXPECT_DOUBLE_EQ(stats.some.avg10, 12.5);
+  EXPECT_DOUBLE_EQ(stats.some.avg60, 3.05);
+  EXPECT_DOUBLE_EQ(stats.some.avg300, 0.71);
+  EXPECT_EQ(stats.some.total_us, 98765432u);
+  ASSERT_TRUE(stats.has_full);
+  EXPECT_DOUBLE_EQ(stats.full.avg10, 1.0);
+  EXPECT_EQ(stats.full.total_us, 1234u);
+
+  PsiLine line;
+  bool is_full = false;
+  EXPECT_FALSE(psi_parse_line("some avg10=1.00", &line, &is_full));
+  EXPECT_FALSE(psi_parse_line("other avg10=1.00 avg60=0 avg300=0 total=0",
+                              &line, &is_full));
+  unlink(path.c_str());
+}
+
+TEST(Cgroup, ParsesMembershipAndMountinfoLines) {
+  std::string_view controllers, path;
+  ASSERT_TRUE(cgroup_parse_membership_line("4:cpu,cpuacct:/user.slice",
+                                           &controllers, &path));
+  EXPECT_EQ(controllers, "cpu,cpuacct");
+  EXPECT_EQ(path, "/user.slice");
+
+  std::string_view root, mount_point, fstype, options;
+  ASSERT_TRUE(cgroup_parse_mountinfo_line(
+      "36 32 0:32 / /sys/fs/cgroup/memory rw,relatime shared:9 - cgroup "
+      "cgroup rw,memory",
+      &root, &mount_point, &fstype, &options));
+  EXPECT_EQ(root, "/");
+  EXPECT_EQ(mount_point, "/sys/fs/cgroup/memory");
+  EXPECT_EQ(fstype, "cgroup");
+  EXPECT_EQ(options, "rw,memory");
+
+  unsigned long long quota = 1, period = 0;
+  ASSERT_TRUE(cgroup_parse_cpu_max("max 100000\n", &quota, &period));
+  EXPECT_EQ(quota, 0u);
+  EXPECT_EQ(period, 100000u);
+}
+
+TEST(Cgroup, ReadsTightestUnifiedLimitsUpTheHierarchy) {
+  char mount[] = "/tmp/platform_version_cgroup_XXXXXX";
+  ASSERT_NE(mkdtemp(mount), nullptr);
+  std::filesystem::path root(mount);
+  std::filesystem::create_directories(root / "app.slice" / "app");
+  auto put = [&](const std::filesystem::path& file, const char* contents) {
+    std::ofstream(root / file) << contents;
+  };
+  put("cgroup.controllers", "cpuset cpu io memory pids\n");
+  put("app.slice/cpu.max", "400000 100000\n");
+  put("app.slice/memory.max", "1073741824\n");
+  put("app.slice/app/cpu.max", "150000 100000\n");
+  put("app.slice/app/memory.max", "max\n");
+  put("app.slice/app/memory.current", "52428800\n");
+  put("app.slice/app/memory.events",
+      "low 1\nhigh 2\nmax 3\noom 4\noom_kill 5\noom_group_kill 0\n");
+
+  std::string cgroup = write_fixture("0::/app.slice/app\n");
+  std::string mountinfo = write_fixture(
+      "25 1 0:23 / /proc rw,nosuid - proc proc rw\n"
+      "30 25 0:26 / " + std::string(mount) +
+      " rw,nosuid shared:4 - cgroup2 cgroup2 rw,nsdelegate\n");
+
+  CgroupPaths paths;
+  ASSERT_TRUE(cgroup_resolve(cgroup.c_str(), mountinfo.c_str(), nullptr, &paths));
+  EXPECT_EQ(paths.cpu.version, 2);
+  EXPECT_EQ(paths.memory.dir, std::string(mount) + "/app.slice/app");
+
+  CgroupLimits limits;
+  cgroup_read_limits(paths, &limits);
+  EXPECT_EQ(limits.cpu_quota_us, 150000u);
+  EXPECT_EQ(limits.cpu_period_us, 100000u);
+  EXPECT_EQ(limits.memory_limit, 1073741824u);
+  EXPECT_EQ(limits.memory_usage, 52428800u);
+  EXPECT_EQ(limits.memory_events_max, 3u);
+  EXPECT_EQ(limits.memory_events_oom_kill, 5u);
+  EXPECT_EQ(cgroup_effective_processors(limits, 64), 2);
+  EXPECT_EQ(cgroup_effective_processors(limits, 1), 1);
+
+  std::filesystem::remove_all(root);
+  unlink(cgroup.c_str());
+  unlink(mountinfo.c_str());
+}
+
+TEST(CpuAffinity, ParsesAndFormatsCpuLists) {
+  std::vector<int> cpus;
+  ASSERT_TRUE(cpulist_parse("0-3,8,10-11", &cpus));
+  EXPECT_EQ(cpus, std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(cpulist_format(cpus), "0-3,8,10-11");
+
+  ASSERT_TRUE(cpulist_parse("", &cpus));
+  EXPECT_TRUE(cpus.empty());
+  EXPECT_FALSE(cpulist_parse("3-1", &cpus));
+  EXPECT_FALSE(cpulist_parse("0-x", &cpus));
+}
+
+TEST(CpuAffinity, ReadsAllowedCpusAndNumaNodes) {
+  std::vector<int> cpus;
+  ASSERT_TRUE(cpu_affinity_read(&cpus));
+  EXPECT_FALSE(cpus.empty());
+  EXPECT_EQ(cpu_affinity_count(), static_cast<long>(cpus.size()));
+
+  char dir[] = "/tmp/platform_version_numa_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  std::filesystem::path root(dir);
+  std::filesystem::create_directories(root / "node1");
+  std::filesystem::create_directories(root / "node0");
+  std::filesystem::create_directories(root / "power");
+  std::ofstream(root / "node0" / "cpulist") << "0-3,8-11\n";
+  std::ofstream(root / "node1" / "cpulist") << "4-7,12-15\n";
+
+  std::vector<NumaNode> nodes;
+  numa_read_nodes(dir, &nodes);
+  ASSERT_EQ(nodes.size(), 2u);
+  EXPECT_EQ(nodes[0].node, 0);
+  EXPECT_EQ(nodes[1].node, 1);
+  EXPECT_EQ(cpulist_format(nodes[1].cpus), "4-7,12-15");
+
+  std::filesystem::remove_all(root);
+}
+
+TEST(CpuTopology, ReadsHybridTopologyAndCachesFromSysfs) {
+  char dir[] = "/tmp/platform_version_cpu_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  std::filesystem::path root(dir);
+  auto put = [&](const std::string& file, const std::string& contents) {
+    std::filesystem::create_directories((root / file).parent_path());
+    std::ofstream(root / file) << contents << "\n";
+  };
+  // Two performance cores with two threads each, then two efficiency cores.
+  const int core_ids[] = {0, 0, 1, 1, 8, 9};
+  const char* siblings[] = {"0-1", "0-1", "2-3", "2-3", "4", "5"};
+  for (int cpu = 0; cpu < 6; cpu++) {
+    std::string base = "cpu/cpu" + std::to_string(cpu) + "/";
+    put(base + "topology/physical_package_id", "0");
+    put(base + "topology/core_id", std::to_string(core_ids[cpu]));
+    put(base + "topology/thread_siblings_list", siblings[cpu]);
+    put(base + "cpu_capacity", cpu < 4 ? "1024" : "400");
+    put(base + "cache/index0/level", "1");
+    put(base + "cache/index0/type", "Data");
+    put(base + "cache/index0/size", cpu < 4 ? "48K" : "32K");
+    put(base + "cache/index0/coherency_line_size", "64");
+    put(base + "cache/index0/ways_of_associativity", "12");
+    put(base + "cache/index0/shared_cpu_list", siblings[cpu]);
+    put(base + "cache/index1/level", "3");
+    put(base + "cache/index1/type", "Unified");
+    put(base + "cache/index1/size", "12M");
+    put(base + "cache/index1/coherency_line_size", "64");
+    put(base + "cache/index1/shared_cpu_list", "0-5");
+  }
+  put("cpu/online", "0-5");
+  put("node/node0/cpulist", "0-5");
+
+  CpuTopology topology;
+  ASSERT_TRUE(cpu_topology_read((root / "cpu").c_str(),
+                                (root / "node").c_str(), &topology));
+  EXPECT_EQ(topology.cpus.size(), 6u);
+  EXPECT_EQ(topology.packages, 1);
+  EXPECT_EQ(topology.cores, 4);
+  EXPECT_EQ(topology.threads_per_core, 2);
+  EXPECT_TRUE(topology.hybrid);
+  EXPECT_EQ(topology.performance_cores, 2);
+  EXPECT_EQ(topology.efficiency_cores, 2);
+  EXPECT_FALSE(topology.cpus[4].performance);
+
+  ASSERT_EQ(topology.caches.size(), 3u);
+  EXPECT_EQ(topology.caches[0].level, 1);
+  EXPECT_EQ(topology.caches[0].instances + topology.caches[1].instances, 4);
+  EXPECT_EQ(topology.caches[2].level, 3);
+  EXPECT_EQ(topology.caches[2].size_bytes, 12ull << 20);
+  EXPECT_EQ(topology.caches[2].shared_cpus, 6);
+  EXPECT_EQ(topology.caches[2].instances, 1);
+  ASSERT_EQ(topology.numa_nodes.size(), 1u);
+
+  std::filesystem::remove_all(root);
+}
+
+TEST(CpuFeatures, DetectsBaselineFeaturesOfTheBuildArchitecture) {
+  uint64_t mask = cpu_features_detect();
+#if defined(__x86_64__)
+  // SSE2 is part of the x86-64 baseline.
+  EXPECT_TRUE(mask & (uint64_t{1} << kCpuFeatureSse2));
+#elif defined(__aarch64__)
+  // So is Advanced SIMD on AArch64.
+  EXPECT_TRUE(mask & (uint64_t{1} << kCpuFeatureNeon));
+#endif
+  // AVX-512 subsets are only reported together with the foundation.
+  if (mask & (uint64_t{1} << kCpuFeatureAvx512bw)) {
+    EXPECT_TRUE(mask & (uint64_t{1} << kCpuFeatureAvx512f));
+  }
+  for (int bit = 0; bit < 64; bit++) {
+    if ((mask >> bit) & 1) {
+      EXPECT_NE(cpu_feature_name(bit), nullptr) << bit;
+    }
+  }
+  EXPECT_STREQ(cpu_feature_name(kCpuFeatureAvx2), "avx2");
+  EXPECT_EQ(cpu_feature_name(63), nullptr);
+}
+
+// Returns the recorded host [name] under test/fixtures/sysroot.
+static std::string sysroot_fixture(const char* name) {
+  return std::string(PLATFORM_VERSION_FIXTURE_DIR) + "/sysroot/" + name;
+}
+
+// Runs the file-backed probes against a recorded host, as the plugin does
+// with PLATFORM_VERSION_SYSROOT set.
+struct RecordedHost {
+  explicit RecordedHost(const char* name) : sysroot(sysroot_fixture(name)) {
+    meminfo_reader_open(
+        &meminfo_reader,
+        sysroot_path(sysroot.c_str(), "/proc/meminfo").path,
+        sysroot_path(sysroot.c_str(), "/proc/vmstat").path);
+    DeviceInfoProbeContext context = {&snapshot, histograms, &meminfo_reader,
+                                      nullptr, sysroot.c_str()};
+    device_info_run_probes(context,
+                           kProbeCpuInfo | kProbeOsRelease | kProbeMeminfo |
+                               kProbeCgroup | kProbeNumaNodes |
+                               kProbeCpuTopology,
+                           &results);
+  }
+  ~RecordedHost() { meminfo_reader_close(&meminfo_reader); }
+
+  // The CpuCache of [level] and [type], or nullptr.
+  const CpuCache* cache(int level, const char* type) const {
+    for (const CpuCache& cache : snapshot.cpu_topology.caches) {
+      if (cache.level == level && cache.type == type) return &cache;
+    }
+    return nullptr;
+  }
+
+  std::string sysroot;
+  DeviceSnapshot snapshot;
+  LatencyHistogram histograms[kProbeCount] = {};
+  MemInfoReader meminfo_reader;
+  DeviceInfoProbeResults results = {};
+};
+
+TEST(Sysroot, ResolvesAbsolutePathsUnderTheRoot) {
+  EXPECT_STREQ(sysroot_path(nullptr, "/proc/stat").path, "/proc/stat");
+  EXPECT_STREQ(sysroot_path("", "/proc/stat").path, "/proc/stat");
+  EXPECT_STREQ(sysroot_path("/srv/host", "/proc/stat").path,
+               "/srv/host/proc/stat");
+
+  std::string long_root(kSysrootPathMax, 'x');
+  EXPECT_EQ(strlen(sysroot_path(long_root.c_str(), "/proc").path),
+            kSysrootPathMax - 1);
+}
+
+TEST(Sysroot, ProbesRecordedTwoCoreArmBoard) {
+  RecordedHost host("arm_2core_sbc");
+  const DeviceSnapshot& snapshot = host.snapshot;
+  EXPECT_EQ(snapshot.cpu_model, "ARMv7 Processor rev 4 (v7l)");
+  EXPECT_EQ(snapshot.distribution_name, "Debian GNU/Linux");
+  EXPECT_EQ(snapshot.distribution_version, "12 (bookworm)");
+  EXPECT_EQ(host.results.meminfo.mem_total, 1012520ull * 1024);
+  EXPECT_EQ(host.results.meminfo.mem_available, 801220ull * 1024);
+
+  const CpuTopology& topology = snapshot.cpu_topology;
+  ASSERT_EQ(topology.cpus.size(), 2u);
+  EXPECT_EQ(topology.packages, 1);
+  EXPECT_EQ(topology.cores, 2);
+  EXPECT_EQ(topology.threads_per_core, 1);
+  EXPECT_FALSE(topology.hybrid);
+  EXPECT_EQ(topology.cpus[1].capacity, 1024u);
+  EXPECT_EQ(topology.cpus[1].max_frequency_khz, 960000u);
+  // The board exposes neither cache information nor NUMA nodes.
+  EXPECT_TRUE(topology.caches.empty());
+  EXPECT_TRUE(snapshot.numa_nodes.empty());
+
+  EXPECT_EQ(snapshot.cgroup.memory.version, 2);
+  EXPECT_EQ(snapshot.cgroup.memory.dir,
+            host.sysroot +
+                "/sys/fs/cgroup/user.slice/user-1000.slice/session-3.scope");
+  EXPECT_EQ(host.results.cgroup_limits.cpu_quota_us, 0u);
+  EXPECT_EQ(host.results.cgroup_limits.memory_limit, 0u);
+  EXPECT_EQ(host.results.cgroup_limits.memory_usage, 41103360u);
+}
+
+TEST(Sysroot, ReadsRecordedPressureFiles) {
+  std::string sysroot = sysroot_fixture("epyc_256_thread");
+  PsiStats stats;
+  ASSERT_TRUE(psi_read_path(
+      sysroot_path(sysroot.c_str(), "/proc/pressure/cpu").path, &stats));
+  EXPECT_DOUBLE_EQ(stats.some.avg10, 4.21);
+  EXPECT_EQ(stats.some.total_us, 912281234112ull);
+  ASSERT_TRUE(psi_read_path(
+      sysroot_path(sysroot.c_str(), "/proc/pressure/io").path, &stats));
+  ASSERT_TRUE(stats.has_full);
+  EXPECT_DOUBLE_EQ(stats.full.avg10, 0.20);
+
+  // Containers often hide /proc/pressure; the monitor then samples meminfo.
+  EXPECT_FALSE(psi_read_path(
+      sysroot_path(sysroot_fixture("container_cgroup_v2").c_str(),
+                   "/proc/pressure/memory")
+          .path,
+      &stats));
+}
+
+TEST(Sysroot, ProbesRecordedDualSocketEpycHost) {
+  RecordedHost host("epyc_256_thread");
+  const DeviceSnapshot& snapshot = host.snapshot;
+  EXPECT_EQ(snapshot.cpu_model, "AMD EPYC 7763 64-Core Processor");
+  EXPECT_EQ(snapshot.distribution_name, "Ubuntu");
+  EXPECT_EQ(snapshot.distribution_version, "22.04.4 LTS (Jammy Jellyfish)");
+  EXPECT_EQ(host.results.meminfo.mem_total, 528024412ull * 1024);
+  EXPECT_EQ(host.results.meminfo.swap_out_pages, 431u);
+
+  const CpuTopology& topology = snapshot.cpu_topology;
+  ASSERT_EQ(topology.cpus.size(), 256u);
+  EXPECT_EQ(topology.packages, 2);
+  EXPECT_EQ(topology.cores, 128);
+  EXPECT_EQ(topology.threads_per_core, 2);
+  EXPECT_FALSE(topology.hybrid);
+  EXPECT_EQ(topology.performance_cores, 128);
+  EXPECT_EQ(topology.efficiency_cores, 0);
+
+  // Per-core L1 and L2, and one 32 MiB L3 per 8-core CCX.
+  ASSERT_EQ(topology.caches.size(), 4u);
+  const CpuCache* l1d = host.cache(1, "Data");
+  ASSERT_NE(l1d, nullptr);
+  EXPECT_EQ(l1d->size_bytes, 32u * 1024);
+  EXPECT_EQ(l1d->instances, 128);
+  EXPECT_EQ(l1d->shared_cpus, 2);
+  const CpuCache* l2 = host.cache(2, "Unified");
+  ASSERT_NE(l2, nullptr);
+  EXPECT_EQ(l2->size_bytes, 512u * 1024);
+  EXPECT_EQ(l2->instances, 128);
+  const CpuCache* l3 = host.cache(3, "Unified");
+  ASSERT_NE(l3, nullptr);
+  EXPECT_EQ(l3->size_bytes, 32u * 1024 * 1024);
+  EXPECT_EQ(l3->instances, 16);
+  EXPECT_EQ(l3->shared_cpus, 16);
+  EXPECT_EQ(l3->ways, 16u);
+
+  ASSERT_EQ(snapshot.numa_nodes.size(), 2u);
+  EXPECT_EQ(cpulist_format(snapshot.numa_nodes[1].cpus), "64-127,192-255");
+
+  // Every cpu line is read; the long intr line after them is not.
+  std::vector<CpuTimes> times;
+  ASSERT_TRUE(proc_stat_read(
+      sysroot_path(host.sysroot.c_str(), "/proc/stat").path, &times));
+  EXPECT_EQ(times.size(), 257u);
+  EXPECT_EQ(times.back().cpu, 255);
+}
+
+TEST(Sysroot, ProbesRecordedContainerCgroupLimits) {
+  RecordedHost host("container_cgroup_v2");
+  const DeviceSnapshot& snapshot = host.snapshot;
+  EXPECT_EQ(snapshot.cpu_model,
+            "Intel(R) Xeon(R) Platinum 8375C CPU @ 2.90GHz");
+  EXPECT_EQ(snapshot.distribution_name, "Alpine Linux");
+
+  // Inside the cgroup namespace the container's cgroup is the mount root.
+  EXPECT_EQ(snapshot.cgroup.cpu.version, 2);
+  EXPECT_EQ(snapshot.cgroup.cpu.dir, host.sysroot + "/sys/fs/cgroup");
+  const CgroupLimits& limits = host.results.cgroup_limits;
+  EXPECT_EQ(limits.cpu_quota_us, 150000u);
+  EXPECT_EQ(limits.cpu_period_us, 100000u);
+  EXPECT_EQ(limits.memory_limit, 536870912u);
+  EXPECT_EQ(limits.memory_usage, 212992000u);
+  EXPECT_EQ(limits.memory_events_max, 37u);
+  EXPECT_EQ(limits.memory_events_oom, 2u);
+  EXPECT_EQ(limits.memory_events_oom_kill, 1u);
+  // 1.5 CPUs of quota round up to 2; the processor count itself is live.
+  EXPECT_LE(host.results.effective_processors, 2);
+
+  const CpuTopology& topology = snapshot.cpu_topology;
+  EXPECT_EQ(topology.cpus.size(), 8u);
+  EXPECT_EQ(topology.cores, 4);
+  EXPECT_EQ(topology.threads_per_core, 2);
+}
+
+TEST(Sysroot, ReadsOsReleaseWithUnusualQuoting) {
+  RecordedHost host("os_release_quoting");
+  EXPECT_EQ(host.snapshot.distribution_name, "Acme \"Edge\" Linux");
+  // Single quotes are removed; the backslash before a space is kept.
+  EXPECT_EQ(host.snapshot.distribution_version,
+            "2024.10 (Tangerine \\ Dream)");
+
+  std::string_view key;
+  std::string_view value;
+  std::string unescaped;
+  os_release_parse_line("BUILD_ID=\"\\$Id: 41f3c2 \\`main\\`\\$\"", &key,
+                        &value);
+  os_release_unescape(value, &unescaped);
+  EXPECT_EQ(unescaped, "$Id: 41f3c2 `main`$");
+  os_release_unescape("C:\\\\tmp\\n", &unescaped);
+  EXPECT_EQ(unescaped, "C:\\tmp\\n");
+
+  // The other probes fail without their files rather than reading the
+  // live system.
+  EXPECT_EQ(host.snapshot.cpu_model, "Unknown");
+  EXPECT_TRUE(host.snapshot.cpu_topology.cpus.empty());
+  LatencyStats stats;
+  latency_histogram_stats(&host.histograms[__builtin_ctz(kProbeCpuInfo)],
+                          &stats);
+  EXPECT_EQ(stats.errors, 1u);
+}
+
+}  // namespace test
+}  // namespace platform_version
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+
+#include <set>
+#include <string>
+
+#include "device_info_fields.h"
+#include "os_release.h"
+#include "string_util.h"
+#include "windows_version.h"
+
+// Tests of the portable parts of platform_version_core, which both the Linux
+// and Windows plugins build.
+
+namespace platform_version {
+namespace test {
+
+// Returns what json_write_string() writes for [value].
+static std::string json_string(const char* value) {
+  FILE* file = tmpfile();
+  EXPECT_NE(file, nullptr);
+  json_write_string(file, value);
+  std::string written(static_cast<size_t>(ftell(file)), '\0');
+  rewind(file);
+  EXPECT_EQ(fread(&written[0], 1, written.size(), file), written.size());
+  fclose(file);
+  return written;
+}
+
+TEST(StringUtil, TrimsSpacesAndTabs) {
+  EXPECT_EQ(string_trim(" \tvalue \t"), "value");
+  EXPECT_EQ(string_trim("a b"), "a b");
+  EXPECT_EQ(string_trim(" \t "), "");
+  EXPECT_EQ(string_trim(""), "");
+}
+
+TEST(StringUtil, TruncatesUtf8AtSequenceBoundaries) {
+  // "aé€" is 1 + 2 + 3 bytes.
+  std::string value = "a\xC3\xA9\xE2\x82\xAC";
+  EXPECT_EQ(utf8_truncated_length(value, 10), 6u);
+  EXPECT_EQ(utf8_truncated_length(value, 6), 6u);
+  EXPECT_EQ(utf8_truncated_length(value, 5), 3u);
+  EXPECT_EQ(utf8_truncated_length(value, 4), 3u);
+  EXPECT_EQ(utf8_truncated_length(value, 2), 1u);
+  EXPECT_EQ(utf8_truncated_length(value, 0), 0u);
+}
+
+TEST(StringUtil, ConvertsUtf16ToUtf8) {
+  EXPECT_EQ(utf16_to_utf8(u"DESKTOP-1"), "DESKTOP-1");
+  EXPECT_EQ(utf16_to_utf8(u"\u00E9\u20AC"), "\xC3\xA9\xE2\x82\xAC");
+  // U+1F600 as a surrogate pair.
+  EXPECT_EQ(utf16_to_utf8(u"\U0001F600"), "\xF0\x9F\x98\x80");
+  // Unpaired surrogates become U+FFFD.
+  std::u16string unpaired = {u'a', 0xD83D, u'b', 0xDE00};
+  EXPECT_EQ(utf16_to_utf8(unpaired), "a\xEF\xBF\xBD" "b\xEF\xBF\xBD");
+}
+
+TEST(StringUtil, WritesEscapedJsonStrings) {
+  EXPECT_EQ(json_string("plain"), "\"plain\"");
+  EXPECT_EQ(json_string("a\"b\\c"), "\"a\\\"b\\\\c\"");
+  EXPECT_EQ(json_string("line\n\ttab"), "\"line\\u000a\\u0009tab\"");
+  EXPECT_EQ(json_string("\xC3\xA9"), "\"\xC3\xA9\"");
+}
+
+TEST(OsRelease, ParsesKeysAndUnquotesValues) {
+  std::string_view key;
+  std::string_view value;
+  ASSERT_TRUE(os_release_parse_line("NAME=\"Debian GNU/Linux\"", &key, &value));
+  EXPECT_EQ(key, "NAME");
+  EXPECT_EQ(value, "Debian GNU/Linux");
+  ASSERT_TRUE(os_release_parse_line("VERSION='12 (bookworm)'", &key, &value));
+  EXPECT_EQ(value, "12 (bookworm)");
+  ASSERT_TRUE(os_release_parse_line("ID=debian", &key, &value));
+  EXPECT_EQ(value, "debian");
+  EXPECT_FALSE(os_release_parse_line("# NAME=comment", &key, &value));
+  EXPECT_FALSE(os_release_parse_line("", &key, &value));
+  EXPECT_FALSE(os_release_parse_line("no separator", &key, &value));
+
+  // Only a matching pair of quotes is removed.
+  EXPECT_EQ(os_release_unquote("\"mismatched'"), "\"mismatched'");
+  EXPECT_EQ(os_release_unquote("\""), "\"");
+}
+
+TEST(WindowsVersion, BucketsRtlGetVersionResults) {
+  EXPECT_EQ(std::string(windows_version_bucket(12, 0)), "12+");
+  EXPECT_EQ(std::string(windows_version_bucket(11, 0)), "11");
+  EXPECT_EQ(std::string(windows_version_bucket(10, 0)), "10");
+  EXPECT_EQ(std::string(windows_version_bucket(6, 3)), "8");
+  EXPECT_EQ(std::string(windows_version_bucket(6, 2)), "8");
+  EXPECT_EQ(std::string(windows_version_bucket(6, 1)), "7");
+  EXPECT_EQ(std::string(windows_version_bucket(5, 1)), "Older");
+}
+
+TEST(WindowsVersion, NamesProcessorArchitectures) {
+  EXPECT_EQ(std::string(windows_processor_architecture_name(9)), "x64");
+  EXPECT_EQ(std::string(windows_processor_architecture_name(12)), "ARM64");
+  EXPECT_EQ(std::string(windows_processor_architecture_name(0)), "x86");
+  EXPECT_EQ(std::string(windows_processor_architecture_name(0xFFFF)),
+            "Unknown");
+}
+
+TEST(DeviceInfoFields, DescribeEveryMemberOnceUnderItsOwnKey) {
+  std::set<std::string> keys;
+  for (const DeviceInfoField& field : kDeviceInfoFields) {
+    EXPECT_NE(field.string == nullptr, field.number == nullptr) << field.key;
+    EXPECT_TRUE(keys.insert(field.key).second) << field.key;
+    EXPECT_EQ(device_info_find_field(field.key), &field);
+  }
+  EXPECT_EQ(device_info_find_field("noSuchKey"), nullptr);
+}
+
+TEST(DeviceInfoFields, GetReportsOnlyMembersThatAreSet) {
+  DeviceInfo info;
+  const DeviceInfoField* cpu_model = device_info_find_field("cpuModel");
+  const DeviceInfoField* processors =
+      device_info_find_field("numberOfProcessors");
+  ASSERT_NE(cpu_model, nullptr);
+  ASSERT_NE(processors, nullptr);
+  DeviceInfoValue value;
+  EXPECT_FALSE(device_info_get(info, *cpu_model, &value));
+  EXPECT_FALSE(device_info_get(info, *processors, &value));
+
+  info.cpu_model = "Cortex-X1";
+  info.number_of_processors = 0;
+  ASSERT_TRUE(device_info_get(info, *cpu_model, &value));
+  EXPECT_STREQ(value.string, "Cortex-X1");
+  // Zero is a value, not a missing one.
+  ASSERT_TRUE(device_info_get(info, *processors, &value));
+  EXPECT_EQ(value.string, nullptr);
+  EXPECT_EQ(value.number, 0);
+}
+
+}  // namespace test
+}  // namespace platform_version
@@ -0,0 +1,162 @@
+#include "thread_stats.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "latency_histogram.h"
+#include "proc_parser.h"
+#include "process_stats.h"
+#include "trace_recorder.h"
+
+namespace {
+
+// Numeric stat fields read, from ppid (field 4) through processor (39).
+constexpr size_t kThreadStatFields = 36;
+
+// Opens <tid>/stat under the task directory [task_fd], or returns -1.
+int open_thread_stat(int task_fd, int tid) {
+  char path[32];
+  snprintf(path, sizeof(path), "%d/stat", tid);
+  return openat(task_fd, path, O_RDONLY | O_CLOEXEC);
+}
+
+// Reads [fd] from offset 0 into [buffer]. A thread that has exited reads as
+// an error (ESRCH), not as an empty file.
+bool read_thread_stat(int fd, char* buffer, size_t size, std::string_view* line) {
+  ssize_t length;
+  {
+    TraceScope trace("io", "pread");
+    do {
+      length = pread(fd, buffer, size, 0);
+    } while (length < 0 && errno == EINTR);
+  }
+  if (length <= 0) return false;
+  std::string_view text(buffer, static_cast<size_t>(length));
+  *line = text.substr(0, text.find('\n'));
+  return true;
+}
+
+}  // namespace
+
+bool thread_stat_parse(std::string_view line,
+                       int tid,
+                       long ticks_per_second,
+                       ThreadStats* stats) {
+  std::string_view name;
+  unsigned long long fields[kThreadStatFields];
+  if (!proc_stat_split(line, &name, &stats->state, fields, kThreadStatFields)) {
+    return false;
+  }
+  stats->tid = tid;
+  size_t length = std::min(name.size(), kThreadNameSize - 1);
+  memcpy(stats->name, name.data(), length);
+  stats->name[length] = '\0';
+  // utime and stime are fields 14 and 15, processor field 39.
+  stats->user_time_ms =
+      ticks_per_second > 0 ? fields[10] * 1000 / ticks_per_second : 0;
+  stats->system_time_ms =
+      ticks_per_second > 0 ? fields[11] * 1000 / ticks_per_second : 0;
+  stats->last_cpu = static_cast<int>(fields[35]);
+  return true;
+}
+
+bool thread_stats_sampler_open(ThreadStatsSampler* sampler,
+                               const char* task_dir) {
+  sampler->task_fd = open(task_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  sampler->ticks_per_second = sysconf(_SC_CLK_TCK);
+  return sampler->task_fd >= 0;
+}
+
+void thread_stats_sampler_close(ThreadStatsSampler* sampler) {
+  for (const ThreadStatsSampler::Thread& thread : sampler->threads) {
+    if (thread.stat_fd >= 0) close(thread.stat_fd);
+  }
+  sampler->threads.clear();
+  if (sampler->task_fd >= 0) close(sampler->task_fd);
+  sampler->task_fd = -1;
+  sampler->previous_ns = 0;
+}
+
+bool thread_stats_sampler_sample(ThreadStatsSampler* sampler,
+                                 std::vector<ThreadCpuUsage>* usage,
+                                 double* interval_ms) {
+  usage->clear();
+  if (sampler->task_fd < 0 ||
+      !dir_list_numbered(sampler->task_fd, "", &sampler->tids)) {
+    return false;
+  }
+  uint64_t now_ns = latency_now_ns();
+  *interval_ms = sampler->previous_ns != 0
+                     ? (now_ns - sampler->previous_ns) / 1e6
+                     : 0.0;
+  sampler->previous_ns = now_ns;
+
+  // Both lists are sorted by tid, so one merge pass closes the files of
+  // exited threads, keeps those still running and opens the new ones.
+  std::vector<ThreadStatsSampler::Thread> threads;
+  threads.reserve(sampler->tids.size());
+  auto cached = sampler->threads.begin();
+  for (int tid : sampler->tids) {
+    while (cached != sampler->threads.end() && cached->tid < tid) {
+      if (cached->stat_fd >= 0) close(cached->stat_fd);
+      ++cached;
+    }
+    if (cached != sampler->threads.end() && cached->tid == tid) {
+      threads.push_back(*cached++);
+    } else {
+      threads.push_back({tid, open_thread_stat(sampler->task_fd, tid), {}});
+    }
+  }
+  for (; cached != sampler->threads.end(); ++cached) {
+    if (cached->stat_fd >= 0) close(cached->stat_fd);
+  }
+  sampler->threads.swap(threads);
+
+  char buffer[1024];
+  std::string_view line;
+  for (ThreadStatsSampler::Thread& thread : sampler->threads) {
+    if (thread.stat_fd < 0) continue;
+    bool read = read_thread_stat(thread.stat_fd, buffer, sizeof(buffer), &line);
+    if (!read) {
+      // The thread exited after the listing, or its tid was reused by a new
+      // thread whose file the old descriptor does not see.
+      close(thread.stat_fd);
+      thread.stat_fd = open_thread_stat(sampler->task_fd, thread.tid);
+      thread.previous = {};
+      read = thread.stat_fd >= 0 &&
+             read_thread_stat(thread.stat_fd, buffer, sizeof(buffer), &line);
+    }
+    ThreadStats stats;
+    if (!read || !thread_stat_parse(line, thread.tid,
+                                    sampler->ticks_per_second, &stats)) {
+      continue;
+    }
+
+    // A new thread's previous sample is all zeros, so it reports its times
+    // since it started.
+    ThreadCpuUsage thread_usage;
+    thread_usage.stats = stats;
+    thread_usage.user_time_ms =
+        stats.user_time_ms > thread.previous.user_time_ms
+            ? stats.user_time_ms - thread.previous.user_time_ms
+            : 0;
+    thread_usage.system_time_ms =
+        stats.system_time_ms > thread.previous.system_time_ms
+            ? stats.system_time_ms - thread.previous.system_time_ms
+            : 0;
+    thread_usage.cpu_percent =
+        *interval_ms > 0
+            ? 100.0 *
+                  (thread_usage.user_time_ms + thread_usage.system_time_ms) /
+                  *interval_ms
+            : 0.0;
+    usage->push_back(thread_usage);
+    thread.previous = stats;
+  }
+  return true;
+}
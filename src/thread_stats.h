@@ -0,0 +1,83 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_THREAD_STATS_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_THREAD_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+#include <vector>
+
+// Longest thread name the kernel keeps (TASK_COMM_LEN), with its NUL.
+constexpr size_t kThreadNameSize = 16;
+
+// One thread of the calling process from /proc/self/task/<tid>/stat. CPU
+// times are in milliseconds since the thread started.
+struct ThreadStats {
+  int tid;
+  // As set with pthread_setname_np(), such as "1.raster" or "1.ui" for the
+  // Flutter engine's task runners.
+  char name[kThreadNameSize];
+  // R (running), S (sleeping), D (uninterruptible), T, t, Z, ...
+  char state;
+  // CPU the thread last ran on.
+  int last_cpu;
+  unsigned long long user_time_ms;
+  unsigned long long system_time_ms;
+};
+
+// A thread's CPU time since the previous sample, or since it started if it
+// is new.
+struct ThreadCpuUsage {
+  ThreadStats stats;
+  unsigned long long user_time_ms;
+  unsigned long long system_time_ms;
+  // (user + system) / interval, in percent of one CPU; 0 on the first
+  // sample, which has no interval.
+  double cpu_percent;
+};
+
+// Parses a /proc/<pid>/task/<tid>/stat line into [stats], converting clock
+// ticks with [ticks_per_second]. The thread name comes from the stat line
+// itself, which carries the same comm as the task's comm file. Returns false
+// if the line is cut short.
+bool thread_stat_parse(std::string_view line,
+                       int tid,
+                       long ticks_per_second,
+                       ThreadStats* stats);
+
+// Keeps /proc/self/task and the stat file of every thread seen open, so a
+// sample is one getdents64() pass plus one pread() per thread; files are
+// only opened for threads that appeared since the previous sample. Not
+// thread-safe.
+struct ThreadStatsSampler {
+  struct Thread {
+    int tid;
+    int stat_fd;
+    ThreadStats previous;
+  };
+
+  int task_fd = -1;
+  long ticks_per_second = 0;
+  // latency_now_ns() of the previous sample, or 0 before the first.
+  uint64_t previous_ns = 0;
+  // Sorted by tid.
+  std::vector<Thread> threads;
+  std::vector<int> tids;
+};
+
+// Opens [task_dir], normally "/proc/self/task". Returns false if it cannot
+// be opened.
+bool thread_stats_sampler_open(ThreadStatsSampler* sampler,
+                               const char* task_dir);
+
+void thread_stats_sampler_close(ThreadStatsSampler* sampler);
+
+// Lists the threads and stores each one's usage since the previous call in
+// [usage], in tid order, and the time since the previous call in
+// [interval_ms] (0 on the first call). Threads that exited in between are
+// dropped. Returns false if the task directory cannot be read.
+bool thread_stats_sampler_sample(ThreadStatsSampler* sampler,
+                                 std::vector<ThreadCpuUsage>* usage,
+                                 double* interval_ms);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_THREAD_STATS_H_
@@ -0,0 +1,166 @@
+#include "trace_recorder.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <vector>
+
+#include "string_util.h"
+
+std::atomic<bool> trace_recorder_enabled_flag{false};
+
+struct TraceEvent {
+  const char* category;
+  const char* name;
+  uint64_t timestamp_ns;
+  char phase;
+};
+
+// One thread's events. Only the owning thread writes [events] and [head];
+// the rest is guarded by the registry mutex.
+struct TraceRing {
+  TraceEvent events[kTraceRingCapacity];
+  // Number of events ever recorded; the next one goes to head % capacity.
+  std::atomic<uint64_t> head;
+  // Events before this index have been dumped with clear.
+  uint64_t tail;
+  pid_t tid;
+  char thread_name[16];
+  // Cleared when the owning thread exits. The next thread to need a ring takes
+  // it over and drops the events left in it, dumped or not, so none are
+  // misattributed.
+  bool in_use;
+};
+
+// Every ring ever created. Rings are reused, never freed, so a dump can read
+// them after their thread has gone; there are only ever as many as threads
+// that recorded at the same time, however many worker threads come and go.
+static std::mutex registry_mutex;
+static std::vector<TraceRing*>* registry = nullptr;
+
+// Releases the calling thread's ring when the thread exits.
+struct TraceThread {
+  TraceRing* ring = nullptr;
+
+  ~TraceThread() {
+    if (ring == nullptr) return;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    ring->in_use = false;
+  }
+};
+
+static thread_local TraceThread trace_thread;
+
+static TraceRing* acquire_ring() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  if (registry == nullptr) registry = new std::vector<TraceRing*>();
+
+  TraceRing* ring = nullptr;
+  for (TraceRing* candidate : *registry) {
+    if (!candidate->in_use) {
+      ring = candidate;
+      break;
+    }
+  }
+  if (ring == nullptr) {
+    ring = new TraceRing();
+    registry->push_back(ring);
+  }
+  ring->tail = ring->head.load(std::memory_order_relaxed);
+  ring->in_use = true;
+  ring->tid = static_cast<pid_t>(syscall(SYS_gettid));
+  if (pthread_getname_np(pthread_self(), ring->thread_name,
+                         sizeof(ring->thread_name)) != 0) {
+    ring->thread_name[0] = '\0';
+  }
+  return ring;
+}
+
+void trace_recorder_set_enabled(bool enabled) {
+  trace_recorder_enabled_flag.store(enabled, std::memory_order_relaxed);
+}
+
+void trace_recorder_record(const char* category, const char* name, char phase) {
+  TraceRing* ring = trace_thread.ring;
+  if (ring == nullptr) ring = trace_thread.ring = acquire_ring();
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  TraceEvent* event = &ring->events[head % kTraceRingCapacity];
+  event->category = category;
+  event->name = name;
+  event->timestamp_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000ull +
+                        static_cast<uint64_t>(now.tv_nsec);
+  event->phase = phase;
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+long trace_recorder_dump(const char* path, bool clear) {
+  FILE* file = fopen(path, "we");
+  if (file == nullptr) return -1;
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  const int pid = getpid();
+  long written = 0;
+  std::vector<TraceEvent> events;
+  fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+  if (registry == nullptr) registry = new std::vector<TraceRing*>();
+  for (TraceRing* ring : *registry) {
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t start = head > kTraceRingCapacity ? head - kTraceRingCapacity : 0;
+    if (start < ring->tail) start = ring->tail;
+    events.clear();
+    for (uint64_t i = start; i < head; i++) {
+      events.push_back(ring->events[i % kTraceRingCapacity]);
+    }
+    // The owner may have lapped the ring while we copied; drop what it
+    // overwrote.
+    uint64_t after = ring->head.load(std::memory_order_acquire);
+    size_t skip = 0;
+    if (after > kTraceRingCapacity && after - kTraceRingCapacity > start) {
+      skip = after - kTraceRingCapacity - start;
+    }
+    if (clear) ring->tail = head;
+    if (skip >= events.size()) continue;
+
+    // Names the thread in the viewer.
+    fprintf(file,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+            "\"args\":{\"name\":",
+            written > 0 ? "," : "", pid, static_cast<int>(ring->tid));
+    json_write_string(file, ring->thread_name[0] != '\0' ? ring->thread_name
+                                                         : "platform_version");
+    fputs("}}", file);
+    for (size_t i = skip; i < events.size(); i++) {
+      const TraceEvent& event = events[i];
+      fputs(",{\"name\":", file);
+      json_write_string(file, event.name);
+      fputs(",\"cat\":", file);
+      json_write_string(file, event.category);
+      fprintf(file, ",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":%d,\"tid\":%d}",
+              event.phase,
+              static_cast<unsigned long long>(event.timestamp_ns / 1000),
+              static_cast<unsigned>(event.timestamp_ns % 1000), pid,
+              static_cast<int>(ring->tid));
+      written++;
+    }
+  }
+  fputs("]}\n", file);
+
+  if (ferror(file) != 0) {
+    int saved_errno = errno;
+    fclose(file);
+    errno = saved_errno;
+    return -1;
+  }
+  if (fclose(file) != 0) return -1;
+  return written;
+}
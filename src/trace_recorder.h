@@ -0,0 +1,62 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_TRACE_RECORDER_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_TRACE_RECORDER_H_
+
+#include <atomic>
+
+// Opt-in recording of begin/end events for method calls, probes and file
+// reads, exported as Chrome Trace Event JSON for Perfetto or chrome://tracing.
+//
+// Each thread records into a ring buffer of its own, so recording takes no
+// lock; when a ring is full the oldest events are overwritten. Once a thread
+// exits, its ring goes to the next thread that starts recording, and the
+// events left in it are dropped then. Timestamps are CLOCK_MONOTONIC, the
+// clock Flutter's timeline uses on Linux, so a dump lines up with the
+// engine's own trace. While tracing is off, an event costs
+// one load and one predicted-not-taken branch.
+
+// Events each thread keeps before overwriting the oldest.
+constexpr unsigned kTraceRingCapacity = 4096;
+
+// Whether events are being recorded. Use trace_recorder_enabled().
+extern std::atomic<bool> trace_recorder_enabled_flag;
+
+inline bool trace_recorder_enabled() {
+  return __builtin_expect(
+      trace_recorder_enabled_flag.load(std::memory_order_relaxed), 0);
+}
+
+// Starts or stops recording. Events already recorded are kept.
+void trace_recorder_set_enabled(bool enabled);
+
+// Records one event on the calling thread. [category] and [name] must be
+// string literals or otherwise live for the rest of the process. [phase] is
+// 'B' or 'E'. Callers check trace_recorder_enabled() first.
+void trace_recorder_record(const char* category, const char* name, char phase);
+
+// Writes every recorded event still in the rings to [path] as Chrome Trace
+// Event JSON, and with [clear] drops them from the rings. Recording may
+// continue meanwhile; events overwritten during the dump are left out.
+// Returns the number of events written, or -1 with errno set if [path] could
+// not be written.
+long trace_recorder_dump(const char* path, bool clear);
+
+// Records a begin event now and the matching end event when the scope exits,
+// if tracing was on at the start.
+struct TraceScope {
+  TraceScope(const char* category, const char* name)
+      : category(category), name(name), active(trace_recorder_enabled()) {
+    if (active) trace_recorder_record(category, name, 'B');
+  }
+  ~TraceScope() {
+    if (active) trace_recorder_record(category, name, 'E');
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+  const char* category;
+  const char* name;
+  bool active;
+};
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_TRACE_RECORDER_H_
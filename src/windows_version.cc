@@ -0,0 +1,29 @@
+#include "windows_version.h"
+
+const char* windows_version_bucket(unsigned major, unsigned minor) {
+  if (major >= 12) return "12+";
+  if (major >= 11) return "11";
+  if (major >= 10) return "10";
+  // 6.2 is Windows 8; 6.0 and 6.1 are Vista and 7.
+  if (major == 6 && minor >= 2) return "8";
+  if (major >= 6) return "7";
+  return "Older";
+}
+
+const char* windows_processor_architecture_name(unsigned architecture) {
+  // The PROCESSOR_ARCHITECTURE_* values from winnt.h.
+  switch (architecture) {
+    case 9:
+      return "x64";
+    case 5:
+      return "ARM";
+    case 12:
+      return "ARM64";
+    case 6:
+      return "IA64";
+    case 0:
+      return "x86";
+    default:
+      return "Unknown";
+  }
+}
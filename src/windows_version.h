@@ -0,0 +1,15 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_WINDOWS_VERSION_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_WINDOWS_VERSION_H_
+
+// Windows version and processor naming, kept free of Windows headers so it
+// can be tested on any host.
+
+// Returns the getPlatformVersion bucket, "12+", "11", "10", "8", "7" or
+// "Older", for a version as reported by RtlGetVersion().
+const char* windows_version_bucket(unsigned major, unsigned minor);
+
+// Returns the name of a PROCESSOR_ARCHITECTURE_* value from GetSystemInfo(),
+// such as "x64" or "ARM64", or "Unknown".
+const char* windows_processor_architecture_name(unsigned architecture);
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_WINDOWS_VERSION_H_
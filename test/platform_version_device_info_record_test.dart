@@ -0,0 +1,82 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:platform_version/platform_version_device_info_record.dart';
+
+// Builds a record the same way the Linux plugin does.
+Uint8List encodeRecord(List<int> ints, List<String> strings) {
+  final encoded = strings.map(utf8.encode).toList();
+  final tableOffset = 8 + ints.length * 8;
+  var offset = tableOffset + strings.length * 8;
+  final length = offset + encoded.fold<int>(0, (sum, s) => sum + s.length);
+
+  final bytes = Uint8List(length);
+  final data = ByteData.sublistView(bytes);
+  data.setUint8(0, 1);
+  data.setUint8(1, ints.length);
+  data.setUint8(2, strings.length);
+  data.setUint32(4, length, Endian.little);
+  for (var i = 0; i < ints.length; i++) {
+    data.setInt64(8 + i * 8, ints[i], Endian.little);
+  }
+  for (var i = 0; i < encoded.length; i++) {
+    data.setUint32(tableOffset + i * 8, offset, Endian.little);
+    data.setUint32(tableOffset + i * 8 + 4, encoded[i].length, Endian.little);
+    bytes.setAll(offset, encoded[i]);
+    offset += encoded[i].length;
+  }
+  return bytes;
+}
+
+void main() {
+  test('decodes ints and strings', () {
+    final record = DeviceInfoRecord.decode(
+      encodeRecord(
+        [16000, 8000, 10, 20, 4000, 3000, 321, 3600, 8],
+        [
+          'id',
+          'Linux',
+          'box',
+          '6.1.0',
+          '#1 SMP',
+          'x86_64',
+          'box',
+          'Ryzen',
+          'Debian',
+          '12',
+        ],
+      ),
+    );
+
+    expect(record.totalRam, 16000);
+    expect(record.numberOfProcessors, 8);
+    expect(record.stableDeviceId, 'id');
+    expect(record.distributionVersion, '12');
+    expect(record.toMap()['cpuModel'], 'Ryzen');
+    expect(record.toMap()['uptime'], 3600);
+  });
+
+  test('fields missing from an older record decode as null', () {
+    final record = DeviceInfoRecord.decode(encodeRecord([16000], ['id']));
+
+    expect(record.totalRam, 16000);
+    expect(record.freeRam, isNull);
+    expect(record.cpuModel, isNull);
+  });
+
+  test('rejects truncated records', () {
+    expect(
+      () => DeviceInfoRecord.decode(Uint8List(4)),
+      throwsFormatException,
+    );
+  });
+
+  test('rejects strings that point past the end of the record', () {
+    final bytes = encodeRecord([16000], ['id', 'Linux']);
+    final data = ByteData.sublistView(bytes);
+    // Stretch the second string's length past the record.
+    data.setUint32(8 + 8 + 8 + 4, 1000, Endian.little);
+    expect(() => DeviceInfoRecord.decode(bytes), throwsFormatException);
+  });
+}
@@ -23,4 +23,19 @@ void main() {
   test('getPlatformVersion', () async {
     expect(await platform.getPlatformVersion(), '42');
   });
+
+  test('getDeviceInfo sends and filters requested keys', () async {
+    Object? sentArguments;
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(channel, (MethodCall methodCall) async {
+          sentArguments = methodCall.arguments;
+          return {'freeRam': 1, 'cpuModel': 'x'};
+        });
+
+    final info = await platform.getDeviceInfo(keys: ['freeRam']);
+    expect(sentArguments, {
+      'keys': ['freeRam'],
+    });
+    expect(info, {'freeRam': 1});
+  });
 }
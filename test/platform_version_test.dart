@@ -11,9 +11,129 @@ class MockPlatformVersionPlatform
   Future<String?> getPlatformVersion() => Future.value('42');
 
   @override
-  Future<Map<String, dynamic>?> getDeviceInfo() {
+  Future<Map<String, dynamic>?> getDeviceInfo({List<String>? keys}) {
     throw UnimplementedError();
   }
+
+  @override
+  Future<DeviceInfoRecord?> getDeviceInfoRecord() {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<String?> getStableDeviceId() => Future.value('stable-id');
+
+  @override
+  Future<void> configureSampler({
+    bool enabled = true,
+    Duration interval = const Duration(seconds: 1),
+    List<String>? metrics,
+  }) {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getSampledMetrics() {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getPluginMetrics({bool reset = false}) {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<void> configureTracing({required bool enabled}) {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<int?> dumpTrace(String path, {bool clear = true}) {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<List<Object?>> batch(List<PlatformVersionCall> calls) {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getMemoryInfo() {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getCpuUsage() {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getProcessInfo({bool pss = false}) {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getThreadCpuUsage() {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getCgroupLimits() {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getCpuAffinity() {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getCpuFeatures() {
+    throw UnimplementedError();
+  }
+
+  @override
+  Future<Map<String, dynamic>?> getCpuTopology() {
+    throw UnimplementedError();
+  }
+
+  @override
+  Stream<Map<String, dynamic>> cpuAffinityStream({
+    Duration interval = const Duration(seconds: 1),
+    bool refreshOnChange = true,
+  }) => const Stream.empty();
+
+  @override
+  Stream<Map<String, dynamic>> cpuUsageStream({
+    Duration interval = const Duration(seconds: 1),
+  }) => const Stream.empty();
+
+  @override
+  Stream<Map<String, dynamic>> processInfoStream({
+    Duration interval = const Duration(seconds: 1),
+    bool pss = false,
+  }) => const Stream.empty();
+
+  @override
+  Stream<Map<String, dynamic>> pressureStream({
+    List<String> resources = const ['memory'],
+    Duration stall = const Duration(milliseconds: 150),
+    Duration window = const Duration(seconds: 1),
+    bool full = false,
+    Duration fallbackInterval = const Duration(seconds: 2),
+  }) => const Stream.empty();
+
+  @override
+  Stream<Map<String, dynamic>> telemetryStream({
+    Duration interval = const Duration(seconds: 1),
+  }) => Stream.value({'freeRam': 1024});
+
+  @override
+  Future<void> configureDispatch({
+    bool? async,
+    int? maxThreads,
+    int? maxQueuedCalls,
+  }) => Future.value();
 }
 
 void main() {
@@ -31,4 +151,21 @@ void main() {
 
     expect(await platformVersionPlugin.getPlatformVersion(), '42');
   });
+
+  test('getStableDeviceId', () async {
+    PlatformVersion platformVersionPlugin = PlatformVersion();
+    MockPlatformVersionPlatform fakePlatform = MockPlatformVersionPlatform();
+    PlatformVersionPlatform.instance = fakePlatform;
+
+    expect(await platformVersionPlugin.getStableDeviceId(), 'stable-id');
+  });
+
+  test('sync accessors return null without the plugin library', () {
+    // Unit tests run without the Linux plugin library bundled next to them.
+    PlatformVersion platformVersionPlugin = PlatformVersion();
+
+    expect(platformVersionPlugin.hasSyncAccess, isFalse);
+    expect(platformVersionPlugin.getDeviceInfoSync(), isNull);
+    expect(platformVersionPlugin.getAvailableRamSync(), isNull);
+  });
 }
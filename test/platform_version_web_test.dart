@@ -0,0 +1,23 @@
+@TestOn('browser')
+library;
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:platform_version/platform_version_web.dart';
+
+void main() {
+  final PlatformVersionWeb platform = PlatformVersionWeb();
+
+  test('configureSampler is a no-op', () async {
+    await platform.configureSampler(
+      interval: const Duration(milliseconds: 100),
+      metrics: ['meminfo'],
+    );
+    await platform.configureSampler(enabled: false);
+    expect(await platform.getSampledMetrics(), isNull);
+  });
+
+  test('configureTracing is a no-op', () async {
+    await platform.configureTracing(enabled: true);
+    await platform.configureTracing(enabled: false);
+  });
+}
@@ -0,0 +1,31 @@
+#include "device_info_encodable.h"
+
+#include <limits>
+#include <string>
+
+namespace platform_version {
+
+flutter::EncodableValue DeviceInfoValueToEncodable(DeviceInfoValue value) {
+  if (value.string != nullptr) {
+    return flutter::EncodableValue(std::string(value.string));
+  }
+  if (value.number >= std::numeric_limits<int32_t>::min() &&
+      value.number <= std::numeric_limits<int32_t>::max()) {
+    return flutter::EncodableValue(static_cast<int32_t>(value.number));
+  }
+  return flutter::EncodableValue(value.number);
+}
+
+flutter::EncodableMap DeviceInfoToEncodableMap(const DeviceInfo& info) {
+  flutter::EncodableMap map;
+  DeviceInfoValue value;
+  for (const DeviceInfoField& field : kDeviceInfoFields) {
+    if (device_info_get(info, field, &value)) {
+      map[flutter::EncodableValue(std::string(field.key))] =
+          DeviceInfoValueToEncodable(value);
+    }
+  }
+  return map;
+}
+
+}  // namespace platform_version
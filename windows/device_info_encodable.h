@@ -0,0 +1,21 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_ENCODABLE_H_
+#define FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_ENCODABLE_H_
+
+#include <flutter/encodable_value.h>
+
+#include "device_info_fields.h"
+
+namespace platform_version {
+
+// Converts a single value to an EncodableValue. Numbers that fit in 32 bits
+// are encoded as int32_t, as the plugin always has, and larger ones as
+// int64_t.
+flutter::EncodableValue DeviceInfoValueToEncodable(DeviceInfoValue value);
+
+// Returns the members of [info] that are set as the getDeviceInfo response
+// map. The strings are copied, so [info] may be discarded afterwards.
+flutter::EncodableMap DeviceInfoToEncodableMap(const DeviceInfo& info);
+
+}  // namespace platform_version
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_VERSION_DEVICE_INFO_ENCODABLE_H_